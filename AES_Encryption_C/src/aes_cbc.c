@@ -0,0 +1,417 @@
+/*
+ ============================================================================
+ Name        : aes_cbc.c
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : AES cipher block chaining (CBC) mode with PKCS#7 padding or
+               ciphertext stealing (CS3).
+ Note 1      : Decryption does not chain: P[i] = D(C[i]) ^ C[i-1], and every
+               C[i] is already known. Blocks are decrypted in batches through
+               the engine's multi-block path and large buffers are split
+               across worker threads.
+ Note 2      : To allow in-place decryption, each batch is XORed from its last
+               block back to its first, so C[i-1] is read before out[i-1]
+               overwrites it. The ciphertext block before each thread's chunk
+               is copied out before any thread starts.
+ Note 3      : Ciphertext stealing only changes the last two blocks, so both
+               CS3 directions run plain CBC on everything before them and
+               handle those two blocks separately.
+ ============================================================================
+ */
+
+#include "aes_cbc.h"
+#include "aes_workers.h"
+
+// Upper bound on the number of chunks a parallel decryption is split into
+#define  CBC_MAX_TASKS  256
+
+typedef struct{
+	const aes_ctx* ctx;
+	const uint8_t* in;
+	uint8_t* out;
+	size_t num_blocks;
+	size_t chunk_blocks;
+	uint8_t (*chain_blocks)[BYTES_IN_STATE];  // Ciphertext block before each chunk (or the IV)
+} cbc_job;
+
+
+aes_out aes_cbc_encrypt(const aes_ctx* ctx, uint8_t* iv, const uint8_t* in, uint8_t* out, size_t num_blocks){
+
+	aes_out output_code = {
+		.termination_code = 0,
+		.msg = "Encrypt/decrypt successful"
+	};
+
+	if(ctx == NULL){
+		output_code.termination_code = 3;
+		strcpy(output_code.msg, "Pointer to AES context is NULL.");
+		return output_code;
+	}
+
+	if(iv == NULL){
+		output_code.termination_code = 5;
+		strcpy(output_code.msg, "Pointer to IV/counter block is NULL.");
+		return output_code;
+	}
+
+	if(num_blocks > 0 && (in == NULL || out == NULL)){
+		output_code.termination_code = 1;
+		strcpy(output_code.msg, "Pointer to input data is NULL.");
+		return output_code;
+	}
+
+	uint8_t block[BYTES_IN_STATE];
+	memcpy(block, iv, BYTES_IN_STATE);
+
+	for(size_t i = 0; i < num_blocks; i++){
+		xor_bytes(block, block, &in[i * BYTES_IN_STATE], BYTES_IN_STATE);
+		ctx->engine->encrypt_blocks(ctx, block, block, 1);
+		memcpy(&out[i * BYTES_IN_STATE], block, BYTES_IN_STATE);
+	}
+
+	memcpy(iv, block, BYTES_IN_STATE);
+
+	return output_code;
+}
+
+
+// Decrypts num_blocks starting after the given chain block. Runs on one thread.
+static void cbc_decrypt_run(const aes_ctx* ctx, const uint8_t* chain_block, const uint8_t* in, uint8_t* out,
+		size_t num_blocks){
+
+	uint8_t decrypted[CBC_BATCH_BLOCKS * BYTES_IN_STATE] AES_ALIGNED(16);
+	uint8_t chain[BYTES_IN_STATE];
+	uint8_t next_chain[BYTES_IN_STATE];
+
+	memcpy(chain, chain_block, BYTES_IN_STATE);
+
+	while(num_blocks > 0){
+
+		size_t batch = (num_blocks > CBC_BATCH_BLOCKS) ? CBC_BATCH_BLOCKS : num_blocks;
+
+		ctx->engine->decrypt_blocks(ctx, in, decrypted, batch);
+		memcpy(next_chain, &in[(batch - 1) * BYTES_IN_STATE], BYTES_IN_STATE);
+
+		for(size_t i = batch - 1; i > 0; i--){
+			xor_bytes(&out[i * BYTES_IN_STATE], &decrypted[i * BYTES_IN_STATE],
+					&in[(i - 1) * BYTES_IN_STATE], BYTES_IN_STATE);
+		}
+		xor_bytes(out, decrypted, chain, BYTES_IN_STATE);
+
+		memcpy(chain, next_chain, BYTES_IN_STATE);
+
+		in += batch * BYTES_IN_STATE;
+		out += batch * BYTES_IN_STATE;
+		num_blocks -= batch;
+	}
+
+	aes_secure_wipe(decrypted, sizeof(decrypted));
+}
+
+
+static void cbc_decrypt_task(void* arg, size_t index){
+
+	const cbc_job* job = (const cbc_job*) arg;
+
+	size_t first_block = index * job->chunk_blocks;
+	size_t num_blocks = job->num_blocks - first_block;
+	if(num_blocks > job->chunk_blocks){
+		num_blocks = job->chunk_blocks;
+	}
+
+	cbc_decrypt_run(job->ctx, job->chain_blocks[index], &job->in[first_block * BYTES_IN_STATE],
+			&job->out[first_block * BYTES_IN_STATE], num_blocks);
+}
+
+
+aes_out aes_cbc_decrypt(aes_ctx* ctx, uint8_t* iv, const uint8_t* in, uint8_t* out, size_t num_blocks){
+
+	aes_out output_code = {
+		.termination_code = 0,
+		.msg = "Encrypt/decrypt successful"
+	};
+
+	if(ctx == NULL){
+		output_code.termination_code = 3;
+		strcpy(output_code.msg, "Pointer to AES context is NULL.");
+		return output_code;
+	}
+
+	if(iv == NULL){
+		output_code.termination_code = 5;
+		strcpy(output_code.msg, "Pointer to IV/counter block is NULL.");
+		return output_code;
+	}
+
+	if(num_blocks == 0){
+		return output_code;
+	}
+
+	if(in == NULL || out == NULL){
+		output_code.termination_code = 1;
+		strcpy(output_code.msg, "Pointer to input data is NULL.");
+		return output_code;
+	}
+
+	// Built here rather than lazily so the worker threads only ever read the context
+	if(!ctx->dec_keys_ready){
+		aes_ctx_prepare_decrypt(ctx);
+	}
+
+	uint8_t last_block[BYTES_IN_STATE];
+	memcpy(last_block, &in[(num_blocks - 1) * BYTES_IN_STATE], BYTES_IN_STATE);
+
+	unsigned num_threads = aes_get_max_threads();
+	size_t num_bytes = num_blocks * BYTES_IN_STATE;
+
+	if(num_threads > 1 && num_bytes >= 2 * AES_MIN_BYTES_PER_THREAD){
+
+		size_t chunk_blocks = num_blocks / (4 * (size_t) num_threads);
+		if(chunk_blocks < AES_MIN_BYTES_PER_THREAD / BYTES_IN_STATE){
+			chunk_blocks = AES_MIN_BYTES_PER_THREAD / BYTES_IN_STATE;
+		}
+		if(chunk_blocks < (num_blocks + CBC_MAX_TASKS - 1) / CBC_MAX_TASKS){
+			chunk_blocks = (num_blocks + CBC_MAX_TASKS - 1) / CBC_MAX_TASKS;
+		}
+
+		size_t num_tasks = (num_blocks + chunk_blocks - 1) / chunk_blocks;
+		uint8_t chain_blocks[CBC_MAX_TASKS][BYTES_IN_STATE];
+
+		memcpy(chain_blocks[0], iv, BYTES_IN_STATE);
+		for(size_t task = 1; task < num_tasks; task++){
+			memcpy(chain_blocks[task], &in[(task * chunk_blocks - 1) * BYTES_IN_STATE], BYTES_IN_STATE);
+		}
+
+		cbc_job job = {
+			.ctx = ctx,
+			.in = in,
+			.out = out,
+			.num_blocks = num_blocks,
+			.chunk_blocks = chunk_blocks,
+			.chain_blocks = chain_blocks
+		};
+
+		aes_run_parallel(cbc_decrypt_task, &job, num_tasks);
+	}
+	else{
+		cbc_decrypt_run(ctx, iv, in, out, num_blocks);
+	}
+
+	memcpy(iv, last_block, BYTES_IN_STATE);
+
+	return output_code;
+}
+
+
+aes_out aes_cbc_encrypt_pkcs7(const aes_ctx* ctx, uint8_t* iv, const uint8_t* in, size_t in_len,
+		uint8_t* out, size_t* out_len){
+
+	aes_out output_code = {
+		.termination_code = 0,
+		.msg = "Encrypt/decrypt successful"
+	};
+
+	if(out == NULL || out_len == NULL || (in == NULL && in_len > 0)){
+		output_code.termination_code = 1;
+		strcpy(output_code.msg, "Pointer to input data is NULL.");
+		return output_code;
+	}
+
+	size_t full_blocks = in_len / BYTES_IN_STATE;
+	size_t tail_len = in_len % BYTES_IN_STATE;
+
+	output_code = aes_cbc_encrypt(ctx, iv, in, out, full_blocks);
+	if(output_code.termination_code != 0){
+		return output_code;
+	}
+
+	// Last block: remaining message bytes, then (16 - tail_len) bytes of value (16 - tail_len)
+	uint8_t last_block[BYTES_IN_STATE];
+	uint8_t pad = (uint8_t) (BYTES_IN_STATE - tail_len);
+
+	if(tail_len > 0){
+		memcpy(last_block, &in[full_blocks * BYTES_IN_STATE], tail_len);
+	}
+	memset(&last_block[tail_len], pad, pad);
+
+	output_code = aes_cbc_encrypt(ctx, iv, last_block, &out[full_blocks * BYTES_IN_STATE], 1);
+	aes_secure_wipe(last_block, sizeof(last_block));
+
+	*out_len = (full_blocks + 1) * BYTES_IN_STATE;
+
+	return output_code;
+}
+
+
+aes_out aes_cbc_decrypt_pkcs7(aes_ctx* ctx, uint8_t* iv, const uint8_t* in, size_t in_len,
+		uint8_t* out, size_t* out_len){
+
+	aes_out output_code = {
+		.termination_code = 0,
+		.msg = "Encrypt/decrypt successful"
+	};
+
+	if(out_len == NULL){
+		output_code.termination_code = 1;
+		strcpy(output_code.msg, "Pointer to input data is NULL.");
+		return output_code;
+	}
+
+	*out_len = 0;
+
+	if(in_len == 0 || in_len % BYTES_IN_STATE != 0){
+		output_code.termination_code = 6;
+		strcpy(output_code.msg, "Input length is not a multiple of 16 bytes.");
+		return output_code;
+	}
+
+	output_code = aes_cbc_decrypt(ctx, iv, in, out, in_len / BYTES_IN_STATE);
+	if(output_code.termination_code != 0){
+		return output_code;
+	}
+
+	// Check every byte of the last block so the time taken does not depend on the padding value
+	const uint8_t* last_block = &out[in_len - BYTES_IN_STATE];
+	uint8_t pad = last_block[BYTES_IN_STATE - 1];
+	uint8_t bad = (uint8_t) ((pad == 0) | (pad > BYTES_IN_STATE));
+
+	for(uint8_t i = 0; i < BYTES_IN_STATE; i++){
+		// in_pad is 0xff for the last pad bytes of the block, 0x00 otherwise
+		uint8_t in_pad = (uint8_t) (0 - (uint8_t) ((BYTES_IN_STATE - 1 - i) < pad));
+		bad |= (uint8_t) (in_pad & (last_block[i] ^ pad));
+	}
+
+	if(bad != 0){
+		aes_secure_wipe(out, in_len);
+		output_code.termination_code = 7;
+		strcpy(output_code.msg, "Invalid padding.");
+		return output_code;
+	}
+
+	*out_len = in_len - pad;
+
+	return output_code;
+}
+
+
+static aes_out check_cs3_input(const uint8_t* iv, const uint8_t* in, const uint8_t* out, size_t num_bytes){
+
+	aes_out output_code = {
+		.termination_code = 0,
+		.msg = "Encrypt/decrypt successful"
+	};
+
+	if(iv == NULL){
+		output_code.termination_code = 5;
+		strcpy(output_code.msg, "Pointer to IV/counter block is NULL.");
+		return output_code;
+	}
+
+	if(in == NULL || out == NULL){
+		output_code.termination_code = 1;
+		strcpy(output_code.msg, "Pointer to input data is NULL.");
+		return output_code;
+	}
+
+	if(num_bytes < BYTES_IN_STATE){
+		output_code.termination_code = 6;
+		strcpy(output_code.msg, "CTS input is shorter than 16 bytes.");
+		return output_code;
+	}
+
+	return output_code;
+}
+
+
+aes_out aes_cbc_cs3_encrypt(const aes_ctx* ctx, uint8_t* iv, const uint8_t* in, uint8_t* out, size_t num_bytes){
+
+	aes_out output_code = check_cs3_input(iv, in, out, num_bytes);
+	if(output_code.termination_code != 0){
+		return output_code;
+	}
+
+	size_t num_blocks = (num_bytes + BYTES_IN_STATE - 1) / BYTES_IN_STATE;
+	size_t tail_len = num_bytes - (num_blocks - 1) * BYTES_IN_STATE;  // 1 to 16
+
+	if(num_blocks == 1){
+		return aes_cbc_encrypt(ctx, iv, in, out, 1);
+	}
+
+	// P[n] zero padded, read before anything is written over it
+	uint8_t last_block[BYTES_IN_STATE] = {0};
+	memcpy(last_block, &in[(num_blocks - 1) * BYTES_IN_STATE], tail_len);
+
+	output_code = aes_cbc_encrypt(ctx, iv, in, out, num_blocks - 1);
+	if(output_code.termination_code != 0){
+		return output_code;
+	}
+
+	// iv now holds C[n-1]; C[n] = E(C[n-1] ^ P[n])
+	uint8_t stolen[BYTES_IN_STATE];
+	memcpy(stolen, iv, BYTES_IN_STATE);
+	aes_cbc_encrypt(ctx, iv, last_block, last_block, 1);
+
+	// Output ends with C[n] and then the first tail_len bytes of C[n-1]
+	memcpy(&out[(num_blocks - 2) * BYTES_IN_STATE], last_block, BYTES_IN_STATE);
+	memcpy(&out[(num_blocks - 1) * BYTES_IN_STATE], stolen, tail_len);
+
+	aes_secure_wipe(last_block, sizeof(last_block));
+
+	return output_code;
+}
+
+
+aes_out aes_cbc_cs3_decrypt(aes_ctx* ctx, uint8_t* iv, const uint8_t* in, uint8_t* out, size_t num_bytes){
+
+	aes_out output_code = check_cs3_input(iv, in, out, num_bytes);
+	if(output_code.termination_code != 0){
+		return output_code;
+	}
+
+	if(ctx == NULL){
+		output_code.termination_code = 3;
+		strcpy(output_code.msg, "Pointer to AES context is NULL.");
+		return output_code;
+	}
+
+	size_t num_blocks = (num_bytes + BYTES_IN_STATE - 1) / BYTES_IN_STATE;
+	size_t tail_len = num_bytes - (num_blocks - 1) * BYTES_IN_STATE;
+
+	if(num_blocks == 1){
+		return aes_cbc_decrypt(ctx, iv, in, out, 1);
+	}
+
+	// The swapped pair, copied before in-place output can overwrite it
+	uint8_t last_full[BYTES_IN_STATE];   // C[n]
+	uint8_t prev_block[BYTES_IN_STATE];  // C[n-1], rebuilt below
+	memcpy(last_full, &in[(num_blocks - 2) * BYTES_IN_STATE], BYTES_IN_STATE);
+	memcpy(prev_block, &in[(num_blocks - 1) * BYTES_IN_STATE], tail_len);
+
+	// Leaves C[n-2] (or the original IV) in iv
+	output_code = aes_cbc_decrypt(ctx, iv, in, out, num_blocks - 2);
+	if(output_code.termination_code != 0){
+		return output_code;
+	}
+
+	if(!ctx->dec_keys_ready){
+		aes_ctx_prepare_decrypt(ctx);
+	}
+
+	// D(C[n]) = C[n-1] ^ P[n] (zero padded): its tail is the stolen part of C[n-1]
+	uint8_t decrypted[BYTES_IN_STATE];
+	ctx->engine->decrypt_blocks(ctx, last_full, decrypted, 1);
+	memcpy(&prev_block[tail_len], &decrypted[tail_len], BYTES_IN_STATE - tail_len);
+
+	uint8_t last_plain[BYTES_IN_STATE];
+	xor_bytes(last_plain, decrypted, prev_block, tail_len);
+
+	aes_cbc_decrypt(ctx, iv, prev_block, &out[(num_blocks - 2) * BYTES_IN_STATE], 1);
+	memcpy(&out[(num_blocks - 1) * BYTES_IN_STATE], last_plain, tail_len);
+
+	aes_secure_wipe(decrypted, sizeof(decrypted));
+	aes_secure_wipe(last_plain, sizeof(last_plain));
+
+	return output_code;
+}
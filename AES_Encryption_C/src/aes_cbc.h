@@ -0,0 +1,102 @@
+/*
+ ============================================================================
+ Name        : aes_cbc.h
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : AES cipher block chaining (CBC) mode, NIST SP 800-38A, with
+               optional PKCS#7 padding (RFC 5652 section 6.3).
+ ============================================================================
+ */
+
+#ifndef AES_CBC_H_
+#define AES_CBC_H_
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+#include "aes_encryption.h"
+
+// Ciphertext blocks decrypted per engine call
+#define  CBC_BATCH_BLOCKS  16
+
+
+/*
+ * Purpose : CBC-encrypts whole blocks. Each block depends on the one before
+ *           it, so this runs one block at a time on the calling thread.
+ * Inputs  : Initialized context, 16-byte IV, input blocks, output location,
+ *           number of blocks
+ * Outputs : termination_code 0 on success. out may equal in. iv is replaced
+ *           by the last ciphertext block so a later call continues the chain.
+ */
+aes_out aes_cbc_encrypt(const aes_ctx* ctx, uint8_t* iv, const uint8_t* in, uint8_t* out, size_t num_blocks);
+
+
+/*
+ * Purpose : CBC-decrypts whole blocks. Blocks are decrypted CBC_BATCH_BLOCKS
+ *           at a time, and large buffers are split across worker threads.
+ * Inputs  : Initialized context, 16-byte IV, input blocks, output location,
+ *           number of blocks
+ * Outputs : termination_code 0 on success. out may equal in. iv is replaced
+ *           by the last ciphertext block.
+ */
+aes_out aes_cbc_decrypt(aes_ctx* ctx, uint8_t* iv, const uint8_t* in, uint8_t* out, size_t num_blocks);
+
+
+/*
+ * Purpose : Pads the message with PKCS#7 and CBC-encrypts it
+ * Inputs  : Context, 16-byte IV, message, message length, output location
+ *           (at least aes_cbc_padded_len(in_len) bytes), output length pointer
+ * Outputs : termination_code 0 on success, *out_len set to the ciphertext length
+ */
+aes_out aes_cbc_encrypt_pkcs7(const aes_ctx* ctx, uint8_t* iv, const uint8_t* in, size_t in_len,
+		uint8_t* out, size_t* out_len);
+
+
+/*
+ * Purpose : CBC-decrypts and removes PKCS#7 padding
+ * Inputs  : Context, 16-byte IV, ciphertext, ciphertext length (a non-zero
+ *           multiple of 16), output location (at least in_len bytes), output
+ *           length pointer
+ * Outputs : termination_code 0 on success, *out_len set to the message length.
+ *           Bad padding returns termination_code 7 and *out_len = 0.
+ * Notes   : The padding check takes the same time for every padding value.
+ *           CBC has no integrity protection, so ciphertext that may have been
+ *           tampered with should be authenticated before it is decrypted.
+ */
+aes_out aes_cbc_decrypt_pkcs7(aes_ctx* ctx, uint8_t* iv, const uint8_t* in, size_t in_len,
+		uint8_t* out, size_t* out_len);
+
+
+/*
+ * Purpose : CBC encryption with ciphertext stealing, variant CS3 (NIST SP
+ *           800-38A addendum). The ciphertext is exactly as long as the
+ *           message: the last partial block is zero padded for encryption
+ *           and the matching bytes of the block before it are left out.
+ * Inputs  : Initialized context, 16-byte IV, message, output location,
+ *           message length (at least 16 bytes, any length from there)
+ * Outputs : termination_code 0 on success. out may equal in. CS3 always
+ *           swaps the last two ciphertext blocks, even when the length is a
+ *           multiple of 16. iv is overwritten.
+ */
+aes_out aes_cbc_cs3_encrypt(const aes_ctx* ctx, uint8_t* iv, const uint8_t* in, uint8_t* out, size_t num_bytes);
+
+
+// Reverses aes_cbc_cs3_encrypt(). Everything but the last two blocks uses the parallel CBC decryption.
+aes_out aes_cbc_cs3_decrypt(aes_ctx* ctx, uint8_t* iv, const uint8_t* in, uint8_t* out, size_t num_bytes);
+
+
+// Ciphertext length for a message of in_len bytes (always adds 1 to 16 bytes)
+static inline size_t aes_cbc_padded_len(size_t in_len){
+	return in_len - (in_len % BYTES_IN_STATE) + BYTES_IN_STATE;
+}
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AES_CBC_H_ */
@@ -0,0 +1,250 @@
+/*
+ ============================================================================
+ Name        : aes_ccm.c
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : AES-CCM. The tag is a CBC-MAC over B_0, the encoded AAD and the
+               plaintext, masked with the first counter block; the data is
+               encrypted in CTR mode with counters 1, 2, ...
+ Note 1      : Both passes use the same context and run together. Each engine
+               call takes the next CBC-MAC block and the next counter block,
+               so every data block is read once, and engines that interleave
+               blocks work on the two independent chains side by side.
+ Note 2      : The CBC-MAC is always over the plaintext, which is the input
+               when encrypting and the output when decrypting. Keystream for
+               block i is made one call ahead, so decryption can finish block
+               i before its MAC step and both directions share one loop.
+ ============================================================================
+ */
+
+#include "aes_ccm.h"
+#include "aes_ctr.h"
+
+
+// XORs data into the CBC-MAC state, encrypting the state each time a block fills up
+static void ccm_absorb(const aes_ctx* ctx, uint8_t* mac, uint8_t* mac_pos, const uint8_t* data, size_t num_bytes){
+
+	while(num_bytes > 0){
+
+		size_t chunk = BYTES_IN_STATE - *mac_pos;
+		if(chunk > num_bytes){
+			chunk = num_bytes;
+		}
+
+		xor_bytes(&mac[*mac_pos], &mac[*mac_pos], data, chunk);
+		*mac_pos = (uint8_t) (*mac_pos + chunk);
+		data += chunk;
+		num_bytes -= chunk;
+
+		if(*mac_pos == BYTES_IN_STATE){
+			ctx->engine->encrypt_blocks(ctx, mac, mac, 1);
+			*mac_pos = 0;
+		}
+	}
+}
+
+
+// Adds the AAD length prefix (SP 800-38C A.2.2) and the AAD to the CBC-MAC, zero padded to a block
+static void ccm_absorb_aad(const aes_ctx* ctx, uint8_t* mac, const uint8_t* aad, size_t aad_len){
+
+	uint8_t prefix[10];
+	uint8_t header_len;
+	uint8_t prefix_len;
+	uint64_t len = (uint64_t) aad_len;
+
+	if(len < 0xff00){
+		header_len = 0;
+		prefix_len = 2;
+	}
+	else if(len <= 0xffffffffU){
+		prefix[0] = 0xff;
+		prefix[1] = 0xfe;
+		header_len = 2;
+		prefix_len = 6;
+	}
+	else{
+		prefix[0] = 0xff;
+		prefix[1] = 0xff;
+		header_len = 2;
+		prefix_len = 10;
+	}
+
+	// Length is big-endian after the header
+	for(uint8_t i = prefix_len; i > header_len; i--){
+		prefix[i - 1] = (uint8_t) len;
+		len >>= 8;
+	}
+
+	uint8_t mac_pos = 0;
+	ccm_absorb(ctx, mac, &mac_pos, prefix, prefix_len);
+	ccm_absorb(ctx, mac, &mac_pos, aad, aad_len);
+
+	if(mac_pos != 0){
+		ctx->engine->encrypt_blocks(ctx, mac, mac, 1);
+	}
+}
+
+
+static aes_out ccm_check_args(const aes_ctx* ctx, const uint8_t* nonce, size_t nonce_len, const uint8_t* aad, size_t aad_len,
+                              const uint8_t* in, const uint8_t* out, size_t data_len, const uint8_t* tag, size_t tag_len){
+
+	aes_out output_code = {
+		.termination_code = 0,
+		.msg = "Encrypt/decrypt successful"
+	};
+
+	if(ctx == NULL){
+		output_code.termination_code = 3;
+		strcpy(output_code.msg, "Pointer to AES context is NULL.");
+		return output_code;
+	}
+
+	if(nonce == NULL || nonce_len < CCM_MIN_NONCE_BYTES || nonce_len > CCM_MAX_NONCE_BYTES){
+		output_code.termination_code = 5;
+		strcpy(output_code.msg, "CCM nonce is NULL or not 7-13 bytes.");
+		return output_code;
+	}
+
+	if((data_len > 0 && (in == NULL || out == NULL)) || (aad_len > 0 && aad == NULL) || tag == NULL){
+		output_code.termination_code = 1;
+		strcpy(output_code.msg, "Pointer to input data is NULL.");
+		return output_code;
+	}
+
+	// Length field is 15 - nonce_len bytes wide
+	size_t len_field_bytes = BYTES_IN_STATE - 1 - nonce_len;
+	int len_too_big = (len_field_bytes < sizeof(size_t)) && ((uint64_t) data_len >> (8 * len_field_bytes)) != 0;
+
+	if(tag_len < 4 || tag_len > CCM_MAX_TAG_BYTES || (tag_len % 2) != 0 || len_too_big){
+		output_code.termination_code = 6;
+		strcpy(output_code.msg, "CCM tag or data length is invalid.");
+		return output_code;
+	}
+
+	return output_code;
+}
+
+
+// Runs both passes and leaves the masked tag (all 16 bytes) in tag_out
+static void ccm_crypt(const aes_ctx* ctx, const uint8_t* nonce, size_t nonce_len, const uint8_t* aad, size_t aad_len,
+                      const uint8_t* in, uint8_t* out, size_t data_len, size_t tag_len, aes_op_flag direction, uint8_t* tag_out){
+
+	// blocks: CBC-MAC state, counter block, and (first call only) counter block 1
+	uint8_t blocks[3 * BYTES_IN_STATE] AES_ALIGNED(16);
+	uint8_t counter[BYTES_IN_STATE];
+	uint8_t tag_mask[BYTES_IN_STATE];
+	uint8_t keystream[BYTES_IN_STATE];
+	uint8_t block[BYTES_IN_STATE];
+
+	uint8_t len_field_bytes = (uint8_t) (BYTES_IN_STATE - 1 - nonce_len);
+
+	// B_0 = flags | nonce | message length
+	uint8_t* b0 = &blocks[0];
+	memset(b0, 0, BYTES_IN_STATE);
+	b0[0] = (uint8_t) (((aad_len > 0) << 6) | (((tag_len - 2) / 2) << 3) | (len_field_bytes - 1));
+	memcpy(&b0[1], nonce, nonce_len);
+	uint64_t len = (uint64_t) data_len;
+	for(uint8_t i = 0; i < len_field_bytes && i < 8; i++){
+		b0[BYTES_IN_STATE - 1 - i] = (uint8_t) len;
+		len >>= 8;
+	}
+
+	// A_0 = flags | nonce | 0
+	memset(counter, 0, BYTES_IN_STATE);
+	counter[0] = (uint8_t) (len_field_bytes - 1);
+	memcpy(&counter[1], nonce, nonce_len);
+	memcpy(&blocks[BYTES_IN_STATE], counter, BYTES_IN_STATE);
+	aes_ctr_add(counter, 1);
+	memcpy(&blocks[2 * BYTES_IN_STATE], counter, BYTES_IN_STATE);
+
+	ctx->engine->encrypt_blocks(ctx, blocks, blocks, (data_len > 0) ? 3 : 2);
+
+	uint8_t* mac = &blocks[0];
+	memcpy(tag_mask, &blocks[BYTES_IN_STATE], BYTES_IN_STATE);
+	memcpy(keystream, &blocks[2 * BYTES_IN_STATE], BYTES_IN_STATE);
+
+	if(aad_len > 0){
+		ccm_absorb_aad(ctx, mac, aad, aad_len);
+	}
+
+	while(data_len > 0){
+
+		size_t chunk = (data_len < BYTES_IN_STATE) ? data_len : BYTES_IN_STATE;
+
+		xor_bytes(block, in, keystream, chunk);
+
+		// Short last block is zero padded for the MAC, so only its bytes are XORed in
+		xor_bytes(mac, mac, (direction == encrypt) ? in : block, chunk);
+		memcpy(out, block, chunk);
+
+		in += chunk;
+		out += chunk;
+		data_len -= chunk;
+
+		if(data_len > 0){
+			aes_ctr_add(counter, 1);
+			memcpy(&blocks[BYTES_IN_STATE], counter, BYTES_IN_STATE);
+			ctx->engine->encrypt_blocks(ctx, blocks, blocks, 2);
+			memcpy(keystream, &blocks[BYTES_IN_STATE], BYTES_IN_STATE);
+		}
+		else{
+			ctx->engine->encrypt_blocks(ctx, mac, mac, 1);
+		}
+	}
+
+	xor_bytes(tag_out, mac, tag_mask, BYTES_IN_STATE);
+
+	aes_secure_wipe(blocks, sizeof(blocks));
+	aes_secure_wipe(tag_mask, sizeof(tag_mask));
+	aes_secure_wipe(keystream, sizeof(keystream));
+	aes_secure_wipe(block, sizeof(block));
+}
+
+
+aes_out aes_ccm_encrypt(const aes_ctx* ctx, const uint8_t* nonce, size_t nonce_len, const uint8_t* aad, size_t aad_len,
+                        const uint8_t* in, uint8_t* out, size_t data_len, uint8_t* tag, size_t tag_len){
+
+	aes_out output_code = ccm_check_args(ctx, nonce, nonce_len, aad, aad_len, in, out, data_len, tag, tag_len);
+	if(output_code.termination_code != 0){
+		return output_code;
+	}
+
+	uint8_t full_tag[BYTES_IN_STATE];
+	ccm_crypt(ctx, nonce, nonce_len, aad, aad_len, in, out, data_len, tag_len, encrypt, full_tag);
+	memcpy(tag, full_tag, tag_len);
+	aes_secure_wipe(full_tag, sizeof(full_tag));
+
+	return output_code;
+}
+
+
+aes_out aes_ccm_decrypt(const aes_ctx* ctx, const uint8_t* nonce, size_t nonce_len, const uint8_t* aad, size_t aad_len,
+                        const uint8_t* in, uint8_t* out, size_t data_len, const uint8_t* tag, size_t tag_len){
+
+	aes_out output_code = ccm_check_args(ctx, nonce, nonce_len, aad, aad_len, in, out, data_len, tag, tag_len);
+	if(output_code.termination_code != 0){
+		return output_code;
+	}
+
+	uint8_t full_tag[BYTES_IN_STATE];
+	ccm_crypt(ctx, nonce, nonce_len, aad, aad_len, in, out, data_len, tag_len, decrypt, full_tag);
+
+	// Constant time compare
+	uint8_t diff = 0;
+	for(uint8_t i = 0; i < tag_len; i++){
+		diff |= full_tag[i] ^ tag[i];
+	}
+	aes_secure_wipe(full_tag, sizeof(full_tag));
+
+	if(diff != 0){
+		if(data_len > 0){
+			aes_secure_wipe(out, data_len);
+		}
+		output_code.termination_code = 8;
+		strcpy(output_code.msg, "Authentication failed.");
+	}
+
+	return output_code;
+}
@@ -0,0 +1,57 @@
+/*
+ ============================================================================
+ Name        : aes_ccm.h
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : AES-CCM authenticated encryption (NIST SP 800-38C, RFC 3610).
+               Only the forward cipher is used, so a context never needs its
+               decryption round keys.
+ ============================================================================
+ */
+
+#ifndef AES_CCM_H_
+#define AES_CCM_H_
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+#include "aes_encryption.h"
+
+#define  CCM_MIN_NONCE_BYTES  7
+#define  CCM_MAX_NONCE_BYTES  13
+#define  CCM_MAX_TAG_BYTES    16
+
+
+/*
+ * Purpose : Encrypts and authenticates a whole message in one call.
+ * Inputs  : Initialized context, nonce (7 to 13 bytes), additional data that
+ *           is authenticated but not encrypted (may be NULL when aad_len is
+ *           0), input data, output location, data length in bytes, tag output
+ *           location, tag length (4, 6, 8, 10, 12, 14 or 16)
+ * Outputs : termination_code 0 on success. out may equal in. The data length
+ *           must fit in 15 - nonce_len bytes.
+ * Notes   : Never reuse a nonce with the same key.
+ */
+aes_out aes_ccm_encrypt(const aes_ctx* ctx, const uint8_t* nonce, size_t nonce_len, const uint8_t* aad, size_t aad_len,
+                        const uint8_t* in, uint8_t* out, size_t data_len, uint8_t* tag, size_t tag_len);
+
+/*
+ * Purpose : Decrypts a message and checks its tag in the same pass.
+ * Inputs  : Same as aes_ccm_encrypt(), with the received tag as input
+ * Outputs : termination_code 0 on success, 8 when the tag does not match. On
+ *           a mismatch the data_len bytes at out are zeroed, so the caller
+ *           never sees unauthenticated plaintext.
+ */
+aes_out aes_ccm_decrypt(const aes_ctx* ctx, const uint8_t* nonce, size_t nonce_len, const uint8_t* aad, size_t aad_len,
+                        const uint8_t* in, uint8_t* out, size_t data_len, const uint8_t* tag, size_t tag_len);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AES_CCM_H_ */
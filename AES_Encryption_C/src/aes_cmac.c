@@ -0,0 +1,486 @@
+/*
+ ============================================================================
+ Name        : aes_cmac.c
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : AES-CMAC. A CBC-MAC over the message where the last block is
+               XORed with K1 (full block) or padded with 10..0 and XORed with
+               K2 (short or empty block) before its encryption.
+ Note 1      : Whole blocks go through cmac_blocks(). With the AES-NI engine
+               that is one call for the whole run with the chaining value kept
+               in a register; other engines get one call per block because
+               each block needs the previous result.
+ Note 2      : aes_cmac_many() hides the serial chain by running CMAC_LANES
+               messages at once. Each lane is the message body followed by
+               its prepared last block. The lanes step together for as many
+               blocks as the shortest one has left, so with AES-NI and all
+               lanes busy that whole stretch is one aes_ni_cbc_mac_8() call;
+               otherwise each step is one engine call over all busy lanes.
+ ============================================================================
+ */
+
+#include "aes_cmac.h"
+#include "aes_ni.h"
+#include "aes_workers.h"
+
+typedef struct{
+	const uint8_t* data;          // Next block of this lane
+	size_t blocks_left;           // Blocks left before data switches to last_block or the lane ends
+	size_t msg;                   // Index of the message in the lane
+	uint8_t in_last_block;        // data points at last_block
+	uint8_t last_block[BYTES_IN_STATE];
+} cmac_lane;
+
+typedef struct{
+	const aes_cmac_key* key;
+	const uint8_t* const* msgs;
+	const size_t* msg_lens;
+	size_t num_msgs;
+	uint8_t* tags;
+	size_t msgs_per_task;
+} cmac_job;
+
+
+// Multiplication by x in GF(2^128), big-endian bit order (SP 800-38B section 6.1)
+static void cmac_double(uint8_t* out, const uint8_t* in){
+
+	uint8_t carry = in[0] >> 7;
+
+	for(uint8_t i = 0; i < BYTES_IN_STATE - 1; i++){
+		out[i] = (uint8_t) ((in[i] << 1) | (in[i + 1] >> 7));
+	}
+	out[BYTES_IN_STATE - 1] = (uint8_t) ((in[BYTES_IN_STATE - 1] << 1) ^ (carry * 0x87));
+}
+
+
+#ifdef AES_X86_ACCEL
+static int uses_aes_ni(const aes_ctx* ctx){
+	return ctx->engine == &aes_engines[engine_aes_ni];
+}
+#endif
+
+
+// CBC-MAC of whole blocks into mac
+static void cmac_blocks(const aes_ctx* ctx, uint8_t* mac, const uint8_t* blocks, size_t num_blocks){
+
+#ifdef AES_X86_ACCEL
+	if(uses_aes_ni(ctx)){
+		aes_ni_cbc_mac(ctx, mac, blocks, num_blocks);
+		return;
+	}
+#endif
+
+	while(num_blocks > 0){
+		xor_bytes(mac, mac, blocks, BYTES_IN_STATE);
+		ctx->engine->encrypt_blocks(ctx, mac, mac, 1);
+		blocks += BYTES_IN_STATE;
+		num_blocks--;
+	}
+}
+
+
+// Makes the last block (0 to 16 bytes of message) ready to go through the chain
+static void cmac_last_block(const aes_cmac_key* key, const uint8_t* data, size_t len, uint8_t* last_block){
+
+	if(len == BYTES_IN_STATE){
+		xor_bytes(last_block, data, key->k1, BYTES_IN_STATE);
+		return;
+	}
+
+	memset(last_block, 0, BYTES_IN_STATE);
+	if(len > 0){
+		memcpy(last_block, data, len);
+	}
+	last_block[len] = 0x80;
+	xor_bytes(last_block, last_block, key->k2, BYTES_IN_STATE);
+}
+
+
+aes_out aes_cmac_init_key(aes_cmac_key* key, cipher_len cipher_key_len, const uint8_t* cipher_key){
+
+	if(key == NULL){
+		aes_out output_code = {.termination_code = 3, .msg = "Pointer to AES context is NULL."};
+		return output_code;
+	}
+
+	aes_out output_code = aes_ctx_init(&key->aes, cipher_key_len, cipher_key);
+
+	if(output_code.termination_code != 0){
+		return output_code;
+	}
+
+	uint8_t l[BYTES_IN_STATE] = {0};
+	key->aes.engine->encrypt_blocks(&key->aes, l, l, 1);
+
+	cmac_double(key->k1, l);
+	cmac_double(key->k2, key->k1);
+
+	aes_secure_wipe(l, sizeof(l));
+
+	return output_code;
+}
+
+
+aes_out aes_cmac_init(aes_cmac_ctx* cmac, const aes_cmac_key* key){
+
+	aes_out output_code = {
+		.termination_code = 0,
+		.msg = "MAC successful"
+	};
+
+	if(cmac == NULL || key == NULL){
+		output_code.termination_code = 3;
+		strcpy(output_code.msg, "Pointer to AES context is NULL.");
+		return output_code;
+	}
+
+	cmac->key = key;
+	memset(cmac->mac, 0, BYTES_IN_STATE);
+	memset(cmac->partial, 0, BYTES_IN_STATE);
+	cmac->partial_len = 0;
+
+	return output_code;
+}
+
+
+aes_out aes_cmac_update(aes_cmac_ctx* cmac, const uint8_t* data, size_t data_len){
+
+	aes_out output_code = {
+		.termination_code = 0,
+		.msg = "MAC successful"
+	};
+
+	if(cmac == NULL || cmac->key == NULL){
+		output_code.termination_code = 3;
+		strcpy(output_code.msg, "Pointer to AES context is NULL.");
+		return output_code;
+	}
+
+	if(data_len == 0){
+		return output_code;
+	}
+
+	if(data == NULL){
+		output_code.termination_code = 1;
+		strcpy(output_code.msg, "Pointer to input data is NULL.");
+		return output_code;
+	}
+
+	const aes_ctx* ctx = &cmac->key->aes;
+
+	// Top up the held-back block. It is only chained once more data shows it is not the last.
+	if(cmac->partial_len > 0){
+
+		size_t take = BYTES_IN_STATE - cmac->partial_len;
+		if(take > data_len){
+			take = data_len;
+		}
+
+		memcpy(&cmac->partial[cmac->partial_len], data, take);
+		cmac->partial_len = (uint8_t) (cmac->partial_len + take);
+		data += take;
+		data_len -= take;
+
+		if(data_len == 0){
+			return output_code;
+		}
+
+		cmac_blocks(ctx, cmac->mac, cmac->partial, 1);
+		cmac->partial_len = 0;
+	}
+
+	// Every whole block except the last goes through the bulk path
+	size_t full_blocks = (data_len - 1) / BYTES_IN_STATE;
+	cmac_blocks(ctx, cmac->mac, data, full_blocks);
+	data += full_blocks * BYTES_IN_STATE;
+	data_len -= full_blocks * BYTES_IN_STATE;
+
+	memcpy(cmac->partial, data, data_len);
+	cmac->partial_len = (uint8_t) data_len;
+
+	return output_code;
+}
+
+
+aes_out aes_cmac_final(aes_cmac_ctx* cmac, uint8_t* tag){
+
+	aes_out output_code = {
+		.termination_code = 0,
+		.msg = "MAC successful"
+	};
+
+	if(cmac == NULL || cmac->key == NULL){
+		output_code.termination_code = 3;
+		strcpy(output_code.msg, "Pointer to AES context is NULL.");
+		return output_code;
+	}
+
+	if(tag == NULL){
+		output_code.termination_code = 1;
+		strcpy(output_code.msg, "Pointer to tag is NULL.");
+		return output_code;
+	}
+
+	uint8_t last_block[BYTES_IN_STATE];
+	cmac_last_block(cmac->key, cmac->partial, cmac->partial_len, last_block);
+	cmac_blocks(&cmac->key->aes, cmac->mac, last_block, 1);
+	memcpy(tag, cmac->mac, CMAC_TAG_BYTES);
+
+	aes_secure_wipe(last_block, sizeof(last_block));
+	aes_secure_wipe(cmac, sizeof(aes_cmac_ctx));
+
+	return output_code;
+}
+
+
+aes_out aes_cmac(const aes_cmac_key* key, const uint8_t* data, size_t data_len, uint8_t* tag){
+
+	aes_cmac_ctx cmac;
+
+	aes_out output_code = aes_cmac_init(&cmac, key);
+
+	if(output_code.termination_code == 0){
+		output_code = aes_cmac_update(&cmac, data, data_len);
+	}
+	if(output_code.termination_code == 0){
+		output_code = aes_cmac_final(&cmac, tag);
+	}
+
+	return output_code;
+}
+
+
+aes_out aes_cmac_verify(const aes_cmac_key* key, const uint8_t* data, size_t data_len, const uint8_t* tag, size_t tag_len){
+
+	if(tag == NULL || tag_len < 4 || tag_len > CMAC_TAG_BYTES){
+		aes_out output_code = {.termination_code = 6, .msg = "CMAC tag is NULL or not 4-16 bytes."};
+		return output_code;
+	}
+
+	uint8_t expected[CMAC_TAG_BYTES];
+	aes_out output_code = aes_cmac(key, data, data_len, expected);
+
+	if(output_code.termination_code != 0){
+		return output_code;
+	}
+
+	// Constant time compare
+	uint8_t diff = 0;
+	for(uint8_t i = 0; i < tag_len; i++){
+		diff |= expected[i] ^ tag[i];
+	}
+	aes_secure_wipe(expected, sizeof(expected));
+
+	if(diff != 0){
+		output_code.termination_code = 8;
+		strcpy(output_code.msg, "Authentication failed.");
+	}
+
+	return output_code;
+}
+
+
+/*---------------- MANY MESSAGES -------------------*/
+
+// Puts message msg into a lane: body blocks first, then the prepared last block
+static void lane_load(const aes_cmac_key* key, cmac_lane* lane, uint8_t* mac, const uint8_t* msg_data, size_t msg_len, size_t msg){
+
+	size_t body_blocks = (msg_len == 0) ? 0 : (msg_len - 1) / BYTES_IN_STATE;
+	size_t body_bytes = body_blocks * BYTES_IN_STATE;
+
+	cmac_last_block(key, &msg_data[body_bytes], msg_len - body_bytes, lane->last_block);
+	memset(mac, 0, BYTES_IN_STATE);
+
+	lane->msg = msg;
+
+	if(body_blocks > 0){
+		lane->data = msg_data;
+		lane->blocks_left = body_blocks;
+		lane->in_last_block = 0;
+	}
+	else{
+		lane->data = lane->last_block;
+		lane->blocks_left = 1;
+		lane->in_last_block = 1;
+	}
+}
+
+
+// Runs messages [first, first + count) through the lanes. Runs on one thread.
+static void cmac_many_run(const aes_cmac_key* key, const uint8_t* const* msgs, const size_t* msg_lens, size_t first, size_t count, uint8_t* tags){
+
+	const aes_ctx* ctx = &key->aes;
+
+	cmac_lane lanes[CMAC_LANES];
+	uint8_t macs[CMAC_LANES * BYTES_IN_STATE] AES_ALIGNED(16);
+
+	size_t next_msg = first;
+	size_t end_msg = first + count;
+	unsigned active = 0;
+
+	while(active < CMAC_LANES && next_msg < end_msg){
+		lane_load(key, &lanes[active], &macs[active * BYTES_IN_STATE], msgs[next_msg], msg_lens[next_msg], next_msg);
+		active++;
+		next_msg++;
+	}
+
+	while(active > 0){
+
+		size_t steps = lanes[0].blocks_left;
+		for(unsigned l = 1; l < active; l++){
+			if(lanes[l].blocks_left < steps){
+				steps = lanes[l].blocks_left;
+			}
+		}
+
+#ifdef AES_X86_ACCEL
+		if(active == CMAC_LANES && uses_aes_ni(ctx)){
+			const uint8_t* lane_data[CMAC_LANES];
+			for(unsigned l = 0; l < CMAC_LANES; l++){
+				lane_data[l] = lanes[l].data;
+			}
+			aes_ni_cbc_mac_8(ctx, macs, lane_data, steps);
+		}
+		else
+#endif
+		{
+			for(size_t step = 0; step < steps; step++){
+				for(unsigned l = 0; l < active; l++){
+					xor_bytes(&macs[l * BYTES_IN_STATE], &macs[l * BYTES_IN_STATE], &lanes[l].data[step * BYTES_IN_STATE], BYTES_IN_STATE);
+				}
+				ctx->engine->encrypt_blocks(ctx, macs, macs, active);
+			}
+		}
+
+		// Move lanes on: body -> last block -> tag out and next message in
+		unsigned l = 0;
+		while(l < active){
+
+			cmac_lane* lane = &lanes[l];
+			lane->blocks_left -= steps;
+
+			if(lane->blocks_left > 0){
+				lane->data += steps * BYTES_IN_STATE;
+				l++;
+			}
+			else if(!lane->in_last_block){
+				lane->data = lane->last_block;
+				lane->blocks_left = 1;
+				lane->in_last_block = 1;
+				l++;
+			}
+			else{
+				memcpy(&tags[(lane->msg - first) * CMAC_TAG_BYTES], &macs[l * BYTES_IN_STATE], CMAC_TAG_BYTES);
+
+				if(next_msg < end_msg){
+					lane_load(key, lane, &macs[l * BYTES_IN_STATE], msgs[next_msg], msg_lens[next_msg], next_msg);
+					next_msg++;
+					l++;
+				}
+				else{
+					// Keep busy lanes packed at the front. The lane moved into slot l
+					// has not been advanced yet, so l stays put.
+					active--;
+					if(l != active){
+						*lane = lanes[active];
+						memcpy(&macs[l * BYTES_IN_STATE], &macs[active * BYTES_IN_STATE], BYTES_IN_STATE);
+						if(lane->in_last_block){
+							lane->data = lane->last_block;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	aes_secure_wipe(macs, sizeof(macs));
+	aes_secure_wipe(lanes, sizeof(lanes));
+}
+
+
+static void cmac_many_task(void* arg, size_t index){
+
+	const cmac_job* job = (const cmac_job*) arg;
+
+	size_t first = index * job->msgs_per_task;
+	size_t count = job->num_msgs - first;
+	if(count > job->msgs_per_task){
+		count = job->msgs_per_task;
+	}
+
+	cmac_many_run(job->key, job->msgs, job->msg_lens, first, count, &job->tags[first * CMAC_TAG_BYTES]);
+}
+
+
+aes_out aes_cmac_many(const aes_cmac_key* key, const uint8_t* const* msgs, const size_t* msg_lens, size_t num_msgs, uint8_t* tags){
+
+	aes_out output_code = {
+		.termination_code = 0,
+		.msg = "MAC successful"
+	};
+
+	if(key == NULL){
+		output_code.termination_code = 3;
+		strcpy(output_code.msg, "Pointer to AES context is NULL.");
+		return output_code;
+	}
+
+	if(num_msgs == 0){
+		return output_code;
+	}
+
+	if(msgs == NULL || msg_lens == NULL || tags == NULL){
+		output_code.termination_code = 1;
+		strcpy(output_code.msg, "Pointer to input data is NULL.");
+		return output_code;
+	}
+
+	size_t total_bytes = 0;
+	for(size_t msg = 0; msg < num_msgs; msg++){
+		if(msgs[msg] == NULL && msg_lens[msg] > 0){
+			output_code.termination_code = 1;
+			strcpy(output_code.msg, "Pointer to input data is NULL.");
+			return output_code;
+		}
+		total_bytes += msg_lens[msg] + BYTES_IN_STATE;
+	}
+
+	unsigned num_threads = aes_get_max_threads();
+
+	if(num_threads > 1 && total_bytes >= 2 * AES_MIN_BYTES_PER_THREAD && num_msgs >= 2 * CMAC_LANES){
+
+		// A few chunks per thread, each at least one full set of lanes
+		size_t msgs_per_task = num_msgs / (4 * (size_t) num_threads);
+		if(msgs_per_task < CMAC_LANES){
+			msgs_per_task = CMAC_LANES;
+		}
+
+		cmac_job job = {
+			.key = key,
+			.msgs = msgs,
+			.msg_lens = msg_lens,
+			.num_msgs = num_msgs,
+			.tags = tags,
+			.msgs_per_task = msgs_per_task
+		};
+
+		aes_run_parallel(cmac_many_task, &job, (num_msgs + msgs_per_task - 1) / msgs_per_task);
+	}
+	else{
+		cmac_many_run(key, msgs, msg_lens, 0, num_msgs, tags);
+	}
+
+	return output_code;
+}
+
+
+void aes_cmac_destroy_key(aes_cmac_key* key){
+
+	if(key == NULL){
+		return;
+	}
+
+	aes_secure_wipe(key, sizeof(aes_cmac_key));
+}
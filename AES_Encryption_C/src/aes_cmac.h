@@ -0,0 +1,90 @@
+/*
+ ============================================================================
+ Name        : aes_cmac.h
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : AES-CMAC message authentication code (NIST SP 800-38B,
+               RFC 4493). Streaming, one-shot and many-message interfaces.
+ ============================================================================
+ */
+
+#ifndef AES_CMAC_H_
+#define AES_CMAC_H_
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+#include "aes_encryption.h"
+
+#define  CMAC_TAG_BYTES  16
+
+// Independent messages run side by side by aes_cmac_many()
+#define  CMAC_LANES      8
+
+
+// Cipher key plus the two CMAC subkeys, derived once by aes_cmac_init_key()
+typedef struct aes_cmac_key_struct{
+	aes_ctx aes;
+	uint8_t k1[BYTES_IN_STATE];
+	uint8_t k2[BYTES_IN_STATE];
+} aes_cmac_key;
+
+// Streaming state. The last block (even when full) is held back in partial
+// until aes_cmac_final(), since it is the one that gets a subkey.
+typedef struct aes_cmac_ctx_struct{
+	const aes_cmac_key* key;
+	uint8_t mac[BYTES_IN_STATE];
+	uint8_t partial[BYTES_IN_STATE];
+	uint8_t partial_len;
+} aes_cmac_ctx;
+
+
+// Expands the cipher key and derives K1 and K2
+aes_out aes_cmac_init_key(aes_cmac_key* key, cipher_len cipher_key_len, const uint8_t* cipher_key);
+
+// Starts a new message. The key must stay valid until aes_cmac_final().
+aes_out aes_cmac_init(aes_cmac_ctx* cmac, const aes_cmac_key* key);
+
+// Adds data (any length, any number of calls). Whole blocks go through the bulk path.
+aes_out aes_cmac_update(aes_cmac_ctx* cmac, const uint8_t* data, size_t data_len);
+
+// Writes the 16-byte tag and wipes the streaming state
+aes_out aes_cmac_final(aes_cmac_ctx* cmac, uint8_t* tag);
+
+// One-shot CMAC of a whole message
+aes_out aes_cmac(const aes_cmac_key* key, const uint8_t* data, size_t data_len, uint8_t* tag);
+
+/*
+ * Purpose : Checks a (possibly truncated) tag for a whole message.
+ * Inputs  : Key, message, message length, received tag, tag length (4 to 16)
+ * Outputs : termination_code 0 when the tag matches, 8 when it does not.
+ *           The comparison takes the same time either way.
+ */
+aes_out aes_cmac_verify(const aes_cmac_key* key, const uint8_t* data, size_t data_len, const uint8_t* tag, size_t tag_len);
+
+/*
+ * Purpose : Computes the CMAC of many independent messages. One CMAC chain
+ *           is serial, so up to CMAC_LANES messages are kept in flight and
+ *           advanced together, one block of each per engine step. A lane
+ *           that finishes is refilled with the next message straight away.
+ *           Large batches are also split across worker threads.
+ * Inputs  : Key, array of message pointers, array of message lengths (may
+ *           differ, 0 allowed), number of messages, tag output location
+ *           (CMAC_TAG_BYTES per message, in message order)
+ * Outputs : termination_code 0 on success
+ */
+aes_out aes_cmac_many(const aes_cmac_key* key, const uint8_t* const* msgs, const size_t* msg_lens, size_t num_msgs, uint8_t* tags);
+
+// Wipes the key and subkeys
+void aes_cmac_destroy_key(aes_cmac_key* key);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AES_CMAC_H_ */
@@ -0,0 +1,157 @@
+/*
+ ============================================================================
+ Name        : aes_ctr.c
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : AES counter (CTR) mode. Every keystream block depends only on
+               its counter value, so the buffer is cut into chunks and each
+               worker thread starts its chunk at base counter + chunk offset.
+ Note 1      : Keystream is made CTR_BATCH_BLOCKS blocks at a time with one
+               engine call and XORed into the data 8 bytes at a time. The last
+               partial block only touches the bytes that are actually there.
+ ============================================================================
+ */
+
+#include "aes_ctr.h"
+#include "aes_workers.h"
+
+typedef struct{
+	const aes_ctx* ctx;
+	const uint8_t* counter_block;
+	const uint8_t* in;
+	uint8_t* out;
+	size_t num_bytes;
+	size_t chunk_bytes;
+} ctr_job;
+
+
+void aes_ctr_add(uint8_t* counter_block, uint64_t num_blocks){
+
+	uint64_t carry = num_blocks;
+
+	for(int i = BYTES_IN_STATE - 1; i >= 0 && carry != 0; i--){
+		carry += counter_block[i];
+		counter_block[i] = (uint8_t) carry;
+		carry >>= 8;
+	}
+}
+
+
+// Processes num_bytes starting at the given counter value. Runs on one thread.
+static void ctr_run(const aes_ctx* ctx, const uint8_t* counter_block, const uint8_t* in, uint8_t* out, size_t num_bytes){
+
+	uint8_t counters[CTR_BATCH_BLOCKS * BYTES_IN_STATE] AES_ALIGNED(16);
+	uint8_t keystream[CTR_BATCH_BLOCKS * BYTES_IN_STATE] AES_ALIGNED(16);
+	uint8_t counter[BYTES_IN_STATE];
+
+	memcpy(counter, counter_block, BYTES_IN_STATE);
+
+	while(num_bytes > 0){
+
+		size_t num_blocks = (num_bytes + BYTES_IN_STATE - 1) / BYTES_IN_STATE;
+		if(num_blocks > CTR_BATCH_BLOCKS){
+			num_blocks = CTR_BATCH_BLOCKS;
+		}
+
+		for(size_t block = 0; block < num_blocks; block++){
+			memcpy(&counters[block * BYTES_IN_STATE], counter, BYTES_IN_STATE);
+			aes_ctr_add(counter, 1);
+		}
+
+		ctx->engine->encrypt_blocks(ctx, counters, keystream, num_blocks);
+
+		size_t chunk = num_blocks * BYTES_IN_STATE;
+		if(chunk > num_bytes){
+			chunk = num_bytes;
+		}
+
+		xor_bytes(out, in, keystream, chunk);
+
+		in += chunk;
+		out += chunk;
+		num_bytes -= chunk;
+	}
+
+	aes_secure_wipe(keystream, sizeof(keystream));
+}
+
+
+static void ctr_task(void* arg, size_t index){
+
+	const ctr_job* job = (const ctr_job*) arg;
+
+	size_t offset = index * job->chunk_bytes;
+	size_t num_bytes = job->num_bytes - offset;
+	if(num_bytes > job->chunk_bytes){
+		num_bytes = job->chunk_bytes;
+	}
+
+	uint8_t counter[BYTES_IN_STATE];
+	memcpy(counter, job->counter_block, BYTES_IN_STATE);
+	aes_ctr_add(counter, offset / BYTES_IN_STATE);
+
+	ctr_run(job->ctx, counter, &job->in[offset], &job->out[offset], num_bytes);
+}
+
+
+aes_out aes_ctr_crypt(const aes_ctx* ctx, uint8_t* counter_block, const uint8_t* in, uint8_t* out, size_t num_bytes){
+
+	aes_out output_code = {
+		.termination_code = 0,
+		.msg = "Encrypt/decrypt successful"
+	};
+
+	if(ctx == NULL){
+		output_code.termination_code = 3;
+		strcpy(output_code.msg, "Pointer to AES context is NULL.");
+		return output_code;
+	}
+
+	if(counter_block == NULL){
+		output_code.termination_code = 5;
+		strcpy(output_code.msg, "Pointer to IV/counter block is NULL.");
+		return output_code;
+	}
+
+	if(num_bytes == 0){
+		return output_code;
+	}
+
+	if(in == NULL || out == NULL){
+		output_code.termination_code = 1;
+		strcpy(output_code.msg, "Pointer to input data is NULL.");
+		return output_code;
+	}
+
+	unsigned num_threads = aes_get_max_threads();
+
+	if(num_threads > 1 && num_bytes >= 2 * AES_MIN_BYTES_PER_THREAD){
+
+		// A few chunks per thread evens out threads that get descheduled
+		size_t chunk_bytes = num_bytes / (4 * (size_t) num_threads);
+		if(chunk_bytes < AES_MIN_BYTES_PER_THREAD){
+			chunk_bytes = AES_MIN_BYTES_PER_THREAD;
+		}
+		chunk_bytes -= chunk_bytes % BYTES_IN_STATE;
+
+		ctr_job job = {
+			.ctx = ctx,
+			.counter_block = counter_block,
+			.in = in,
+			.out = out,
+			.num_bytes = num_bytes,
+			.chunk_bytes = chunk_bytes
+		};
+
+		aes_run_parallel(ctr_task, &job, (num_bytes + chunk_bytes - 1) / chunk_bytes);
+	}
+	else{
+		ctr_run(ctx, counter_block, in, out, num_bytes);
+	}
+
+	aes_ctr_add(counter_block, (num_bytes + BYTES_IN_STATE - 1) / BYTES_IN_STATE);
+
+	return output_code;
+}
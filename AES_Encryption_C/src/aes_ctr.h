@@ -0,0 +1,51 @@
+/*
+ ============================================================================
+ Name        : aes_ctr.h
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : AES counter (CTR) mode, NIST SP 800-38A. Encryption and
+               decryption are the same operation.
+ ============================================================================
+ */
+
+#ifndef AES_CTR_H_
+#define AES_CTR_H_
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+#include "aes_encryption.h"
+
+// Counter blocks encrypted per engine call. Large enough for every engine to
+// run its widest interleaved path.
+#define  CTR_BATCH_BLOCKS  16
+
+
+/*
+ * Purpose : Encrypts or decrypts num_bytes of data (any length, no padding)
+ *           by XORing it with the encrypted counter blocks. Large buffers are
+ *           split across worker threads (see aes_workers.h).
+ * Inputs  : Initialized context, 16-byte initial counter block, input data,
+ *           output location, data length in bytes
+ * Outputs : termination_code 0 on success. out may equal in. The counter
+ *           block is advanced (as a 128-bit big-endian number) by the number
+ *           of blocks used, so the next call continues the keystream when
+ *           num_bytes was a multiple of 16.
+ * Notes   : Never reuse a counter value with the same key.
+ */
+aes_out aes_ctr_crypt(const aes_ctx* ctx, uint8_t* counter_block, const uint8_t* in, uint8_t* out, size_t num_bytes);
+
+
+// Adds num_blocks to a 16-byte big-endian counter block
+void aes_ctr_add(uint8_t* counter_block, uint64_t num_blocks);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AES_CTR_H_ */
@@ -14,11 +14,28 @@
                after encryption/decryption is completed. If this did not occur, there
                would be a local copy of the cipher key existing in memory (which would
                compromise security of the encrypted data).
+ Note 3      : The block functions are generated per key length by a macro, with
+               every round unrolled and round keys at constant offsets. A
+               context stores the pair for its key length, so the reference
+               engine does not look at Nr per block.
+ Note 4      : use_aes() expands the key for every block it is given. Callers with
+               more than one block should use the aes_ctx functions instead, which
+               expand the key once and then run any number of blocks. For bulk
+               data, aes_ecb_encrypt_blocks()/aes_ecb_decrypt_blocks() pass the
+               whole buffer to the engine in a single call.
  ============================================================================
  */
 
 
 #include "aes_encryption.h"
+#include "aes_otf.h"
+
+static void encrypt_16_bytes_128(uint8_t* state, const uint8_t* round_keys);
+static void encrypt_16_bytes_192(uint8_t* state, const uint8_t* round_keys);
+static void encrypt_16_bytes_256(uint8_t* state, const uint8_t* round_keys);
+static void decrypt_16_bytes_eq_128(uint8_t* state, const uint8_t* round_keys);
+static void decrypt_16_bytes_eq_192(uint8_t* state, const uint8_t* round_keys);
+static void decrypt_16_bytes_eq_256(uint8_t* state, const uint8_t* round_keys);
 
 aes_out use_aes(uint8_t* data_16_bytes, cipher_len cipher_key_len, uint8_t* cipher_key, aes_op_flag aes_op){
 
@@ -33,103 +50,356 @@ aes_out use_aes(uint8_t* data_16_bytes, cipher_len cipher_key_len, uint8_t* ciph
 		return output_code;
 	}
 
-	// Set parameters related to cipher key length (e.g. number of scrambling rounds).
-	params cp;
+	aes_ctx ctx;
+
+	output_code = aes_ctx_init(&ctx, cipher_key_len, cipher_key);
+
+	if(aes_op == encrypt){
+		aes_ctx_encrypt_block(&ctx, data_16_bytes);
+	}
+	else if(aes_op == decrypt){
+		aes_ctx_decrypt_block(&ctx, data_16_bytes);
+	}
+
+	// Erase the cipher key (as mentioned above)
+	for(uint8_t i = 0; i < (ctx.Nk * BYTES_IN_WORD); i++){
+		cipher_key[i] = 0;
+	}
+
+	aes_ctx_destroy(&ctx);
+
+	return output_code;
+}
 
+
+aes_out aes_ctx_init(aes_ctx* ctx, cipher_len cipher_key_len, const uint8_t* cipher_key){
+
+	aes_out output_code = {
+		.termination_code = 0,
+		.msg = "Encrypt/decrypt successful"
+	};
+
+	if(ctx == NULL){
+		output_code.termination_code = 3;
+		strcpy(output_code.msg, "Pointer to AES context is NULL.");
+		return output_code;
+	}
+
+	if(cipher_key == NULL){
+		output_code.termination_code = 2;
+		strcpy(output_code.msg, "Pointer to cipher key is NULL.");
+		return output_code;
+	}
+
+	// Set parameters related to cipher key length (e.g. number of scrambling rounds).
+	// The unrolled block functions for this key length are chosen here, once.
 	switch (cipher_key_len){
 		case (128):
-			cp.Nk = 4;
-			cp.Nr = 10;
+			ctx->Nk = 4;
+			ctx->Nr = 10;
+#ifndef AES_OTF_KEYS
+			ctx->encrypt_block = encrypt_16_bytes_128;
+			ctx->decrypt_block = decrypt_16_bytes_eq_128;
+#endif
 			break;
 		case (192):
-			cp.Nk = 6;
-			cp.Nr = 12;
+			ctx->Nk = 6;
+			ctx->Nr = 12;
+#ifndef AES_OTF_KEYS
+			ctx->encrypt_block = encrypt_16_bytes_192;
+			ctx->decrypt_block = decrypt_16_bytes_eq_192;
+#endif
 			break;
 		default: // 256-bit key
-			cp.Nk = 8;
-			cp.Nr = 14;
+			ctx->Nk = 8;
+			ctx->Nr = 14;
+#ifndef AES_OTF_KEYS
+			ctx->encrypt_block = encrypt_16_bytes_256;
+			ctx->decrypt_block = decrypt_16_bytes_eq_256;
+#endif
 	}
 
-	uint8_t* round_keys = generate_key_schedule(cipher_key, cp.Nr, cp.Nk);
+	ctx->engine = get_default_aes_engine();
 
-	if(aes_op == encrypt){
-		encrypt_16_bytes(data_16_bytes, round_keys, aes_op, cp.Nr);
+	if(ctx->engine->expand_keys != NULL){
+		ctx->engine->expand_keys(ctx, cipher_key);
 	}
-	else if(aes_op == decrypt){
-		decrypt_16_bytes(data_16_bytes, round_keys, aes_op, cp.Nr);
+	else{
+#ifndef AES_OTF_KEYS
+		generate_key_schedule(cipher_key, ctx->round_keys, ctx->Nr, ctx->Nk);
+#else
+		otf_load_key_words(cipher_key, ctx->Nk, ctx->key_words);
+#endif
 	}
 
-	// Erase the cipher key (as mentioned above)
-	for(uint8_t i = 0; i < (cp.Nk * BYTES_IN_WORD); i++){
-		cipher_key[i] = 0;
+	ctx->dec_keys_ready = false;
+
+	if(ctx->engine->setup_keys != NULL){
+		ctx->engine->setup_keys(ctx);
 	}
 
 	return output_code;
 }
 
 
-void encrypt_16_bytes(uint8_t* data_16_bytes, uint8_t* round_keys, aes_op_flag aes_op, const uint8_t Nr){
+aes_out aes_ctx_set_engine(aes_ctx* ctx, aes_engine_id engine_id){
 
-	// Note: Encrypted data will overwrite original message
-	uint8_t* state = data_16_bytes;
+	aes_out output_code = {
+		.termination_code = 0,
+		.msg = "Encrypt/decrypt successful"
+	};
 
-	uint8_t round_num = 0;
+	if(ctx == NULL){
+		output_code.termination_code = 3;
+		strcpy(output_code.msg, "Pointer to AES context is NULL.");
+		return output_code;
+	}
 
-	add_round_key(state, round_keys, &round_num, aes_op);
+	const aes_engine* engine = get_aes_engine(engine_id);
 
-	while(round_num < Nr){
+	if(engine == NULL){
+		output_code.termination_code = 4;
+		strcpy(output_code.msg, "AES engine is not available in this build.");
+		return output_code;
+	}
 
-		for(uint8_t i = 0; i < BYTES_IN_STATE; i++){
-			state[i] = apply_sbox(state[i]);
-		}
+	ctx->engine = engine;
 
-		shift_rows(state);
+	if(engine->setup_keys != NULL){
+		engine->setup_keys(ctx);
+	}
 
-		mix_col_words(state);
+	return output_code;
+}
+
+
+void aes_ctx_encrypt_block(aes_ctx* ctx, uint8_t* data_16_bytes){
+	ctx->engine->encrypt_blocks(ctx, data_16_bytes, data_16_bytes, 1);
+}
 
-		add_round_key(state, round_keys, &round_num, aes_op);
+
+void aes_ctx_decrypt_block(aes_ctx* ctx, uint8_t* data_16_bytes){
+
+	if(!ctx->dec_keys_ready){
+		aes_ctx_prepare_decrypt(ctx);
 	}
 
-	// Final round does not include mix_col_words
-	for(uint8_t i = 0; i < BYTES_IN_STATE; i++){
-		state[i] = apply_sbox(state[i]);
+	ctx->engine->decrypt_blocks(ctx, data_16_bytes, data_16_bytes, 1);
+}
+
+
+static void check_ecb_input(const aes_ctx* ctx, const uint8_t* in, const uint8_t* out, aes_out* aes_out_ptr){
+
+	if(ctx == NULL){
+		aes_out_ptr->termination_code = 3;
+		strcpy(aes_out_ptr->msg, "Pointer to AES context is NULL.");
 	}
-	shift_rows(state);
-	add_round_key(state, round_keys, &round_num, aes_op);
+	else if(in == NULL || out == NULL){
+		aes_out_ptr->termination_code = 1;
+		strcpy(aes_out_ptr->msg, "Pointer to input data is NULL.");
+	}
+}
+
 
+aes_out aes_ecb_encrypt_blocks(aes_ctx* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks){
+
+	aes_out output_code = {
+		.termination_code = 0,
+		.msg = "Encrypt/decrypt successful"
+	};
+
+	check_ecb_input(ctx, in, out, &output_code);
+
+	if(output_code.termination_code != 0 || num_blocks == 0){
+		return output_code;
+	}
+
+	ctx->engine->encrypt_blocks(ctx, in, out, num_blocks);
+
+	return output_code;
 }
 
 
-void decrypt_16_bytes(uint8_t* data_16_bytes, uint8_t* round_keys, aes_op_flag aes_op, const uint8_t Nr){
+aes_out aes_ecb_decrypt_blocks(aes_ctx* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks){
 
-	uint8_t* state = data_16_bytes;
+	aes_out output_code = {
+		.termination_code = 0,
+		.msg = "Encrypt/decrypt successful"
+	};
 
-	uint8_t round_num = Nr;
+	check_ecb_input(ctx, in, out, &output_code);
 
-	add_round_key(state, round_keys, &round_num, aes_op);
+	if(output_code.termination_code != 0 || num_blocks == 0){
+		return output_code;
+	}
 
-	while(round_num > 0){
+	if(!ctx->dec_keys_ready){
+		aes_ctx_prepare_decrypt(ctx);
+	}
 
-		inv_shift_rows(state);
+	ctx->engine->decrypt_blocks(ctx, in, out, num_blocks);
 
-		for(uint8_t i = 0; i < BYTES_IN_STATE; i++){
-			state[i] = apply_inv_sbox(state[i]);
-		}
+	return output_code;
+}
 
-		add_round_key(state, round_keys, &round_num, aes_op);
 
-		inv_mix_col_words(state);
+void aes_ctx_prepare_decrypt(aes_ctx* ctx){
 
+	if(ctx->engine->expand_dec_keys != NULL){
+		ctx->engine->expand_dec_keys(ctx);
+	}
+	else{
+#ifndef AES_OTF_KEYS
+		generate_dec_key_schedule(ctx->round_keys, ctx->dec_round_keys, ctx->Nr);
+#else
+		otf_last_key_window(ctx->key_words, ctx->Nk, ctx->Nr, ctx->last_key_words);
+#endif
 	}
 
-	// The final round (# 0) doesn't include mix_col_words
-	inv_shift_rows(state);
-	for(uint8_t i = 0; i < BYTES_IN_STATE; i++){
-		state[i] = apply_inv_sbox(state[i]);
+	ctx->dec_keys_ready = true;
+}
+
+
+void aes_ctx_destroy(aes_ctx* ctx){
+
+	if(ctx == NULL){
+		return;
 	}
 
-	add_round_key(state, round_keys, &round_num, aes_op);
+	aes_secure_wipe(ctx, sizeof(aes_ctx));
+}
+
 
+void aes_secure_wipe(void* mem, size_t num_bytes){
+
+#if defined(__GNUC__) || defined(__clang__)
+	// The empty asm claims to read the memory, so the compiler cannot decide the
+	// memset is dead (which it may do for memory that is about to go out of scope).
+	// A context is about 1.4 KB (about 500 bytes with AES_SMALL_FOOTPRINT), and a
+	// full-width memset is far faster than that many volatile byte stores.
+	memset(mem, 0, num_bytes);
+	__asm__ __volatile__("" : : "r"(mem) : "memory");
+#else
+	// Writing through a volatile pointer keeps the compiler from deciding the
+	// stores are dead (which it may do for memory that is about to go out of scope).
+	volatile uint8_t* bytes = (volatile uint8_t*) mem;
+
+	while(num_bytes--){
+		*bytes++ = 0;
+	}
+#endif
+}
+
+
+/*
+ * Key-size-specialized ciphers. ROUNDS_n(ROUND) expands to ROUND(1) ... ROUND(n),
+ * so every middle round is written out with its round key at a constant offset
+ * and there is no round counter left at run time. One function is generated per
+ * key length and direction, and aes_ctx_init() picks the ones a context uses.
+ */
+#define  ROUNDS_9(ROUND)   ROUND(1) ROUND(2) ROUND(3) ROUND(4) ROUND(5) ROUND(6) ROUND(7) ROUND(8) ROUND(9)
+#define  ROUNDS_11(ROUND)  ROUNDS_9(ROUND) ROUND(10) ROUND(11)
+#define  ROUNDS_13(ROUND)  ROUNDS_11(ROUND) ROUND(12) ROUND(13)
+
+// The state is held as four column words throughout (see cipher_utils.h)
+#define  ENC_ROUND(r)  \
+	sub_bytes_words(s); shift_rows_words(s); mix_columns_words(s); add_round_key_words(s, &round_keys[(r) * BYTES_IN_STATE]);
+
+// Equivalent inverse cipher: same order as encryption, keys stored in the order they are used
+#define  DEC_EQ_ROUND(r)  \
+	inv_sub_bytes_words(s); inv_shift_rows_words(s); inv_mix_columns_words(s); add_round_key_words(s, &round_keys[(r) * BYTES_IN_STATE]);
+
+// Inverse cipher on the encryption schedule, which is walked from the last round key down
+#define  DEC_ROUND(r)  \
+	inv_shift_rows_words(s); inv_sub_bytes_words(s); add_round_key_words(s, &round_keys[(Nr - (r)) * BYTES_IN_STATE]); inv_mix_columns_words(s);
+
+#define  DEFINE_AES_BLOCK_FNS(bits, NR, MIDDLE_ROUNDS)                          \
+static void encrypt_16_bytes_##bits(uint8_t* state, const uint8_t* round_keys){ \
+	uint32_t s[COLS_IN_STATE];                                                   \
+	load_state_words(s, state);                                                  \
+	add_round_key_words(s, round_keys);                                          \
+	MIDDLE_ROUNDS(ENC_ROUND)                                                     \
+	sub_bytes_words(s);                                                          \
+	shift_rows_words(s);                                                         \
+	add_round_key_words(s, &round_keys[(NR) * BYTES_IN_STATE]);                  \
+	store_state_words(state, s);                                                 \
+}                                                                                \
+static void decrypt_16_bytes_eq_##bits(uint8_t* state, const uint8_t* round_keys){ \
+	uint32_t s[COLS_IN_STATE];                                                   \
+	load_state_words(s, state);                                                  \
+	add_round_key_words(s, round_keys);                                          \
+	MIDDLE_ROUNDS(DEC_EQ_ROUND)                                                  \
+	inv_sub_bytes_words(s);                                                      \
+	inv_shift_rows_words(s);                                                     \
+	add_round_key_words(s, &round_keys[(NR) * BYTES_IN_STATE]);                  \
+	store_state_words(state, s);                                                 \
+}                                                                                \
+static void decrypt_16_bytes_##bits(uint8_t* state, const uint8_t* round_keys){ \
+	const uint8_t Nr = (NR);                                                     \
+	uint32_t s[COLS_IN_STATE];                                                   \
+	load_state_words(s, state);                                                  \
+	add_round_key_words(s, &round_keys[Nr * BYTES_IN_STATE]);                    \
+	MIDDLE_ROUNDS(DEC_ROUND)                                                     \
+	inv_shift_rows_words(s);                                                     \
+	inv_sub_bytes_words(s);                                                      \
+	add_round_key_words(s, round_keys);                                          \
+	store_state_words(state, s);                                                 \
+}
+
+DEFINE_AES_BLOCK_FNS(128, 10, ROUNDS_9)
+DEFINE_AES_BLOCK_FNS(192, 12, ROUNDS_11)
+DEFINE_AES_BLOCK_FNS(256, 14, ROUNDS_13)
+
+
+// The Nr-based entry points below pick the specialized function on every call.
+// Contexts make that choice once, in aes_ctx_init().
+void encrypt_16_bytes(uint8_t* data_16_bytes, const uint8_t* round_keys, aes_op_flag aes_op, const uint8_t Nr){
+
+	// Note: Encrypted data will overwrite original message
+	(void) aes_op;
+
+	switch(Nr){
+		case 10:
+			encrypt_16_bytes_128(data_16_bytes, round_keys);
+			break;
+		case 12:
+			encrypt_16_bytes_192(data_16_bytes, round_keys);
+			break;
+		default:
+			encrypt_16_bytes_256(data_16_bytes, round_keys);
+	}
+}
+
+
+void decrypt_16_bytes(uint8_t* data_16_bytes, const uint8_t* round_keys, aes_op_flag aes_op, const uint8_t Nr){
+
+	(void) aes_op;
+
+	switch(Nr){
+		case 10:
+			decrypt_16_bytes_128(data_16_bytes, round_keys);
+			break;
+		case 12:
+			decrypt_16_bytes_192(data_16_bytes, round_keys);
+			break;
+		default:
+			decrypt_16_bytes_256(data_16_bytes, round_keys);
+	}
+}
+
+
+void decrypt_16_bytes_eq(uint8_t* data_16_bytes, const uint8_t* dec_round_keys, const uint8_t Nr){
+
+	switch(Nr){
+		case 10:
+			decrypt_16_bytes_eq_128(data_16_bytes, dec_round_keys);
+			break;
+		case 12:
+			decrypt_16_bytes_eq_192(data_16_bytes, dec_round_keys);
+			break;
+		default:
+			decrypt_16_bytes_eq_256(data_16_bytes, dec_round_keys);
+	}
 }
 
 
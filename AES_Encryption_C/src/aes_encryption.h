@@ -43,23 +43,196 @@ typedef enum{key_128 = 128, key_192 = 192, key_256 = 256} cipher_len;
 
 typedef enum{encrypt, decrypt} aes_op_flag;
 
-#include "s_box.h"
-#include "pre_cipher_utils.h"
-#include "cipher_utils.h"
-
 #define  BYTES_IN_WORD   4
 #define  BYTES_IN_STATE  16
 #define  HALF_BYTE       4
 #define  WORDS_IN_STATE  4
 #define  COLS_IN_STATE   4
 #define  ROWS_IN_STATE	 4
+#define  KEY_SCHED_MAX_BYTES  240  // 15 round keys for a 256-bit cipher key
+#define  AES_MAX_NK           8    // Words in a 256-bit cipher key
+
+#if defined(__GNUC__) || defined(__clang__) || defined(__ARMCC_VERSION)
+#define  AES_ALIGNED(n)  __attribute__((aligned(n)))
+#else
+#define  AES_ALIGNED(n)
+#endif
+
+/*
+ * Build options
+ * AES_SMALL_FOOTPRINT : Leaves out engines whose lookup tables are too large for
+ *                       small microcontrollers (the T-table engine) and the
+ *                       GF(2^8) multiplication tables (gf256.h). Unless
+ *                       AES_CONSTANT_TIME is also set, it leaves out the
+ *                       bitsliced engine too, whose copy of the schedule adds
+ *                       960 bytes to every context. Set by the STM32 project.
+ * AES_NO_HW_ACCEL     : Leaves out engines that use CPU-specific instructions.
+ *                       Otherwise they are built on x86 with GCC or Clang and
+ *                       only used if CPUID reports the instructions at runtime.
+ * AES_CONSTANT_TIME   : New contexts default to the bitsliced engine instead of
+ *                       T-tables when neither AES-NI nor SSSE3 is available.
+ *                       GF(2^8) multiplications (gf256.h) use arithmetic
+ *                       instead of lookup tables. Keeps the bitsliced engine
+ *                       in AES_SMALL_FOOTPRINT builds. Cannot be combined with
+ *                       AES_OTF_KEYS, which leaves only the s-box lookups of
+ *                       the reference engine.
+ * AES_NO_THREADS      : Runs the parallel modes (e.g. CTR) on the calling thread
+ *                       only. Otherwise POSIX builds split large buffers across
+ *                       a pool of worker threads (link with -pthread).
+ * AES_OTF_KEYS        : Contexts keep only the cipher key and, once used for
+ *                       decryption, the last Nk words of the schedule, and the
+ *                       reference engine expands round keys as it goes
+ *                       (aes_otf.c). A context drops from ~500 to ~100 bytes,
+ *                       for a slower cipher. Every other engine reads the stored
+ *                       schedule, so this implies AES_SMALL_FOOTPRINT and
+ *                       AES_NO_HW_ACCEL.
+ */
+#ifdef AES_OTF_KEYS
+#ifndef AES_SMALL_FOOTPRINT
+#define  AES_SMALL_FOOTPRINT
+#endif
+#ifndef AES_NO_HW_ACCEL
+#define  AES_NO_HW_ACCEL
+#endif
+#endif
+
+#if defined(AES_CONSTANT_TIME) && defined(AES_OTF_KEYS)
+#error "AES_CONSTANT_TIME needs the bitsliced engine, which AES_OTF_KEYS leaves out"
+#endif
+
+#if !defined(AES_SMALL_FOOTPRINT) || defined(AES_CONSTANT_TIME)
+#define  AES_BITSLICE
+#endif
+
+#if !defined(AES_NO_HW_ACCEL) && (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define  AES_X86_ACCEL
+#endif
+
+#if !defined(AES_NO_THREADS) && !defined(AES_SMALL_FOOTPRINT) && \
+    (defined(__unix__) || defined(__APPLE__))
+#define  AES_THREADS
+#endif
+
+typedef enum{
+	engine_reference,  // Byte-oriented FIPS 197 implementation (cipher_utils.c)
+	engine_t_table,    // 32-bit T-table implementation (t_tables.c)
+	engine_aes_ni,     // x86 AES instructions (aes_ni.c)
+	engine_bitslice,   // Constant-time bitsliced implementation, 8 blocks at a time (bitslice.c)
+	engine_vperm,      // Constant-time SSSE3/AVX2 byte-shuffle implementation (vperm.c)
+	NUM_AES_ENGINES
+} aes_engine_id;
+
+struct aes_context;
+
+// One block in place with a key-size-specialized cipher (see aes_ctx_init())
+typedef void (*aes_block_fn)(uint8_t* state, const uint8_t* round_keys);
+
+/*
+ * Every engine implements the same block interface. in and out may point to
+ * the same buffer. The decrypt function may assume the context's decryption
+ * schedule has already been built. expand_keys and expand_dec_keys are
+ * optional; when NULL the portable key schedule code is used. All engines
+ * produce byte-identical schedules, so a context can change engines freely.
+ * setup_keys is also optional. It is called whenever a context starts using
+ * the engine, after round_keys is filled, to build any engine-specific copy
+ * of the round keys.
+ */
+typedef struct aes_engine_ops{
+	const char* name;
+	bool (*is_supported)(void);
+	void (*encrypt_blocks)(const struct aes_context* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks);
+	void (*decrypt_blocks)(const struct aes_context* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks);
+	void (*expand_keys)(struct aes_context* ctx, const uint8_t* cipher_key);
+	void (*expand_dec_keys)(struct aes_context* ctx);
+	void (*setup_keys)(struct aes_context* ctx);
+} aes_engine;
+
+/*
+ * Expanded-key context. The key schedule is generated once by aes_ctx_init()
+ * and then reused for any number of blocks. The decryption schedule (equivalent
+ * inverse cipher form, see FIPS 197 section 5.3.5) is only generated the first
+ * time the context is used to decrypt. Storage belongs to the caller, so any
+ * number of contexts can be in use at the same time. With AES_OTF_KEYS the
+ * schedules are replaced by two windows of Nk words (see aes_otf.h).
+ */
+typedef struct aes_context{
+#ifndef AES_OTF_KEYS
+	uint8_t round_keys[KEY_SCHED_MAX_BYTES] AES_ALIGNED(16);
+	uint8_t dec_round_keys[KEY_SCHED_MAX_BYTES] AES_ALIGNED(16);
+#else
+	uint32_t key_words[AES_MAX_NK];       // First window of the schedule (the cipher key)
+	uint32_t last_key_words[AES_MAX_NK];  // Last window, where decryption starts
+#endif
+	uint8_t Nk;
+	uint8_t Nr;
+	bool dec_keys_ready;
+	const aes_engine* engine;
+#ifndef AES_OTF_KEYS
+	aes_block_fn encrypt_block;  // Unrolled cipher for this key length, used by the reference engine
+	aes_block_fn decrypt_block;  // Unrolled equivalent inverse cipher, run on dec_round_keys
+#endif
+#ifdef AES_BITSLICE
+	uint64_t bs_round_keys[(KEY_SCHED_MAX_BYTES / BYTES_IN_STATE) * 8];  // Bitsliced copy for the bitslice engine
+#endif
+} aes_ctx;
+
+#include "s_box.h"
+#include "pre_cipher_utils.h"
+#include "cipher_utils.h"
 
 
 aes_out use_aes(uint8_t* data_16_bytes, cipher_len cipher_key_len, uint8_t* cipher_key, aes_op_flag aes_op);
 
-void encrypt_16_bytes(uint8_t* data_16_bytes, uint8_t* round_keys, aes_op_flag aes_op, const uint8_t Nr);
+void encrypt_16_bytes(uint8_t* data_16_bytes, const uint8_t* round_keys, aes_op_flag aes_op, const uint8_t Nr);
+
+void decrypt_16_bytes(uint8_t* data_16_bytes, const uint8_t* round_keys, aes_op_flag aes_op, const uint8_t Nr);
+
+// Equivalent inverse cipher. dec_round_keys must come from generate_dec_key_schedule().
+void decrypt_16_bytes_eq(uint8_t* data_16_bytes, const uint8_t* dec_round_keys, const uint8_t Nr);
+
+
+/*
+ * Purpose : Expands the cipher key into the context. Unlike use_aes(), the
+ *           caller's cipher key is not modified. Once the context has been
+ *           initialized the caller may erase its own copy of the key.
+ * Inputs  : Context storage, cipher key length, cipher key
+ * Outputs : termination_code 0 on success
+ * Notes   : The context uses the fastest engine available in this build. Use
+ *           aes_ctx_set_engine() to pick a specific one.
+ */
+aes_out aes_ctx_init(aes_ctx* ctx, cipher_len cipher_key_len, const uint8_t* cipher_key);
+
+// Switches an initialized context to another engine. Fails if the engine is not in this build.
+aes_out aes_ctx_set_engine(aes_ctx* ctx, aes_engine_id engine_id);
+
+// Encrypts one 16-byte block in place with an initialized context
+void aes_ctx_encrypt_block(aes_ctx* ctx, uint8_t* data_16_bytes);
+
+// Decrypts one 16-byte block in place. Builds the decryption schedule on first use.
+void aes_ctx_decrypt_block(aes_ctx* ctx, uint8_t* data_16_bytes);
+
+/*
+ * Purpose : Encrypts/decrypts consecutive 16-byte blocks in ECB mode with an
+ *           initialized context. Arguments are checked once per call, then the
+ *           blocks are handed to the engine in one go so it can work on
+ *           several of them at a time.
+ * Inputs  : Context, input blocks, output location, number of blocks
+ * Outputs : termination_code 0 on success. Result written to out (out may
+ *           equal in, but the buffers must not otherwise overlap).
+ */
+aes_out aes_ecb_encrypt_blocks(aes_ctx* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks);
+
+aes_out aes_ecb_decrypt_blocks(aes_ctx* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks);
+
+// Builds the decryption schedule now (e.g. before sharing the context between threads)
+void aes_ctx_prepare_decrypt(aes_ctx* ctx);
+
+// Overwrites every round key held by the context
+void aes_ctx_destroy(aes_ctx* ctx);
 
-void decrypt_16_bytes(uint8_t* data_16_bytes, uint8_t* round_keys, aes_op_flag aes_op, const uint8_t Nr);
+// Zeroes memory in a way the compiler is not allowed to optimize out
+void aes_secure_wipe(void* mem, size_t num_bytes);
 
 // Checks inputs to use_aes() to prevent null pointers and invalid numerical inputs
 void check_invalid_input(uint8_t* data_16_bytes, uint8_t* cipher_key, aes_out* aes_out_ptr);
@@ -0,0 +1,357 @@
+/*
+ ============================================================================
+ Name        : aes_gcm.c
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : AES Galois/Counter Mode. Counter mode encryption (with a 32-bit
+               counter) plus the GHASH universal hash over the AAD, the
+               ciphertext and their lengths.
+ Note 1      : GHASH uses PCLMULQDQ when CPUID reports it (ghash_clmul.c).
+               With the AES-NI engine, whole 8-block batches also go through
+               a loop that makes keystream and hashes in the same pass.
+ Note 2      : The portable GHASH uses Shoup's 4-bit tables (ghash_table.c).
+               Table indices depend on the data, so on CPUs with data caches
+               the timing of the portable path is not constant.
+ ============================================================================
+ */
+
+#include "aes_gcm.h"
+#include "cpu_features.h"
+
+
+static void store_be64(uint8_t* bytes, uint64_t value){
+	for(int i = 7; i >= 0; i--){
+		bytes[i] = (uint8_t) value;
+		value >>= 8;
+	}
+}
+
+
+// GCM increments only the last 32 bits of the counter block
+static void inc32(uint8_t* counter_block){
+	for(uint8_t i = BYTES_IN_STATE - 1; i >= BYTES_IN_STATE - 4; i--){
+		if(++counter_block[i] != 0){
+			break;
+		}
+	}
+}
+
+
+static void ghash_blocks(aes_gcm_ctx* gcm, uint8_t* acc, const uint8_t* blocks, size_t num_blocks){
+
+#ifdef AES_X86_ACCEL
+	if(gcm->use_clmul){
+		ghash_clmul_blocks(acc, gcm->h_powers, blocks, num_blocks);
+		return;
+	}
+#endif
+
+	for(size_t block = 0; block < num_blocks; block++){
+		xor_bytes(acc, acc, &blocks[block * BYTES_IN_STATE], BYTES_IN_STATE);
+		ghash_table_mult(&gcm->h_table, acc);
+	}
+}
+
+
+// Hashes AAD left in the partial block (zero padded) before the first data byte
+static void finish_aad(aes_gcm_ctx* gcm){
+
+	uint8_t pos = (uint8_t) (gcm->aad_len % BYTES_IN_STATE);
+
+	if(pos != 0){
+		memset(&gcm->partial[pos], 0, BYTES_IN_STATE - pos);
+		ghash_blocks(gcm, gcm->ghash_acc, gcm->partial, 1);
+	}
+}
+
+
+aes_out aes_gcm_init(aes_gcm_ctx* gcm, const aes_ctx* ctx, aes_op_flag direction, const uint8_t* iv, size_t iv_len){
+
+	aes_out output_code = {
+		.termination_code = 0,
+		.msg = "Encrypt/decrypt successful"
+	};
+
+	if(gcm == NULL || ctx == NULL){
+		output_code.termination_code = 3;
+		strcpy(output_code.msg, "Pointer to AES context is NULL.");
+		return output_code;
+	}
+
+	if(iv == NULL || iv_len == 0){
+		output_code.termination_code = 5;
+		strcpy(output_code.msg, "Pointer to IV/counter block is NULL.");
+		return output_code;
+	}
+
+	memset(gcm, 0, sizeof(aes_gcm_ctx));
+	gcm->aes = ctx;
+	gcm->direction = direction;
+
+	// Hash subkey H = E(K, 0^128)
+	uint8_t hash_key[BYTES_IN_STATE] = {0};
+	ctx->engine->encrypt_blocks(ctx, hash_key, hash_key, 1);
+
+	ghash_table_init(&gcm->h_table, hash_key);
+
+#ifdef AES_X86_ACCEL
+	if(cpu_has_pclmul() && cpu_has_ssse3()){
+		ghash_clmul_init(hash_key, gcm->h_powers);
+		gcm->use_clmul = true;
+		gcm->use_stitched = (ctx->engine == &aes_engines[engine_aes_ni]);
+	}
+#endif
+
+	aes_secure_wipe(hash_key, sizeof(hash_key));
+
+	if(iv_len == GCM_IV_BYTES){
+		// J0 = IV || 0^31 || 1
+		memcpy(gcm->j0, iv, GCM_IV_BYTES);
+		gcm->j0[BYTES_IN_STATE - 1] = 1;
+	}
+	else{
+		// J0 = GHASH(IV || zero padding || 0^64 || [len(IV)]64)
+		uint8_t block[BYTES_IN_STATE] = {0};
+		size_t full_blocks = iv_len / BYTES_IN_STATE;
+		size_t tail = iv_len % BYTES_IN_STATE;
+
+		ghash_blocks(gcm, gcm->j0, iv, full_blocks);
+		if(tail > 0){
+			memcpy(block, &iv[full_blocks * BYTES_IN_STATE], tail);
+			ghash_blocks(gcm, gcm->j0, block, 1);
+		}
+
+		memset(block, 0, sizeof(block));
+		store_be64(&block[8], (uint64_t) iv_len * 8);
+		ghash_blocks(gcm, gcm->j0, block, 1);
+	}
+
+	memcpy(gcm->counter, gcm->j0, BYTES_IN_STATE);
+	inc32(gcm->counter);
+
+	return output_code;
+}
+
+
+aes_out aes_gcm_update_aad(aes_gcm_ctx* gcm, const uint8_t* aad, size_t aad_len){
+
+	aes_out output_code = {
+		.termination_code = 0,
+		.msg = "Encrypt/decrypt successful"
+	};
+
+	if(gcm == NULL || (aad == NULL && aad_len > 0)){
+		output_code.termination_code = 1;
+		strcpy(output_code.msg, "Pointer to input data is NULL.");
+		return output_code;
+	}
+
+	if(gcm->data_len > 0){
+		output_code.termination_code = 9;
+		strcpy(output_code.msg, "GCM call order or length is invalid.");
+		return output_code;
+	}
+
+	uint8_t pos = (uint8_t) (gcm->aad_len % BYTES_IN_STATE);
+	gcm->aad_len += aad_len;
+
+	// Top up a partial block first
+	if(pos != 0){
+		size_t take = BYTES_IN_STATE - pos;
+		if(take > aad_len){
+			take = aad_len;
+		}
+
+		memcpy(&gcm->partial[pos], aad, take);
+		aad += take;
+		aad_len -= take;
+
+		if(pos + take < BYTES_IN_STATE){
+			return output_code;
+		}
+		ghash_blocks(gcm, gcm->ghash_acc, gcm->partial, 1);
+	}
+
+	size_t full_blocks = aad_len / BYTES_IN_STATE;
+	ghash_blocks(gcm, gcm->ghash_acc, aad, full_blocks);
+
+	memcpy(gcm->partial, &aad[full_blocks * BYTES_IN_STATE], aad_len % BYTES_IN_STATE);
+
+	return output_code;
+}
+
+
+aes_out aes_gcm_update(aes_gcm_ctx* gcm, const uint8_t* in, uint8_t* out, size_t num_bytes){
+
+	aes_out output_code = {
+		.termination_code = 0,
+		.msg = "Encrypt/decrypt successful"
+	};
+
+	if(gcm == NULL || (num_bytes > 0 && (in == NULL || out == NULL))){
+		output_code.termination_code = 1;
+		strcpy(output_code.msg, "Pointer to input data is NULL.");
+		return output_code;
+	}
+
+	if(num_bytes == 0){
+		return output_code;
+	}
+
+	if(num_bytes > GCM_MAX_DATA_BYTES - gcm->data_len){
+		output_code.termination_code = 9;
+		strcpy(output_code.msg, "GCM call order or length is invalid.");
+		return output_code;
+	}
+
+	if(gcm->data_len == 0){
+		finish_aad(gcm);
+	}
+
+	const aes_ctx* ctx = gcm->aes;
+	const bool decrypting = (gcm->direction == decrypt);
+	uint8_t pos = (uint8_t) (gcm->data_len % BYTES_IN_STATE);
+	gcm->data_len += num_bytes;
+
+	// Finish the block a previous call left partly done
+	if(pos != 0){
+		while(pos < BYTES_IN_STATE && num_bytes > 0){
+			uint8_t byte_in = *in++;
+			uint8_t byte_out = byte_in ^ gcm->keystream[pos];
+			*out++ = byte_out;
+			gcm->partial[pos++] = decrypting ? byte_in : byte_out;
+			num_bytes--;
+		}
+
+		if(pos < BYTES_IN_STATE){
+			return output_code;
+		}
+		ghash_blocks(gcm, gcm->ghash_acc, gcm->partial, 1);
+	}
+
+	size_t full_blocks = num_bytes / BYTES_IN_STATE;
+
+#ifdef AES_X86_ACCEL
+	if(gcm->use_stitched){
+		size_t done = decrypting ?
+				gcm_clmul_decrypt(ctx, gcm->counter, gcm->ghash_acc, gcm->h_powers, in, out, full_blocks) :
+				gcm_clmul_encrypt(ctx, gcm->counter, gcm->ghash_acc, gcm->h_powers, in, out, full_blocks);
+
+		in += done * BYTES_IN_STATE;
+		out += done * BYTES_IN_STATE;
+		full_blocks -= done;
+		num_bytes -= done * BYTES_IN_STATE;
+	}
+#endif
+
+	// Remaining whole blocks through the engine, a batch at a time
+	uint8_t keystream[GCM_BATCH_BLOCKS * BYTES_IN_STATE] AES_ALIGNED(16);
+
+	while(full_blocks > 0){
+
+		size_t batch = (full_blocks > GCM_BATCH_BLOCKS) ? GCM_BATCH_BLOCKS : full_blocks;
+
+		for(size_t block = 0; block < batch; block++){
+			memcpy(&keystream[block * BYTES_IN_STATE], gcm->counter, BYTES_IN_STATE);
+			inc32(gcm->counter);
+		}
+		ctx->engine->encrypt_blocks(ctx, keystream, keystream, batch);
+
+		// GHASH always covers the ciphertext: the input when decrypting, the output when encrypting
+		if(decrypting){
+			ghash_blocks(gcm, gcm->ghash_acc, in, batch);
+		}
+		xor_bytes(out, in, keystream, batch * BYTES_IN_STATE);
+		if(!decrypting){
+			ghash_blocks(gcm, gcm->ghash_acc, out, batch);
+		}
+
+		in += batch * BYTES_IN_STATE;
+		out += batch * BYTES_IN_STATE;
+		full_blocks -= batch;
+		num_bytes -= batch * BYTES_IN_STATE;
+	}
+
+	aes_secure_wipe(keystream, sizeof(keystream));
+
+	// Start a partial block; its keystream is kept for the next call
+	if(num_bytes > 0){
+		memcpy(gcm->keystream, gcm->counter, BYTES_IN_STATE);
+		inc32(gcm->counter);
+		ctx->engine->encrypt_blocks(ctx, gcm->keystream, gcm->keystream, 1);
+
+		for(pos = 0; pos < num_bytes; pos++){
+			uint8_t byte_in = in[pos];
+			uint8_t byte_out = byte_in ^ gcm->keystream[pos];
+			out[pos] = byte_out;
+			gcm->partial[pos] = decrypting ? byte_in : byte_out;
+		}
+	}
+
+	return output_code;
+}
+
+
+aes_out aes_gcm_final(aes_gcm_ctx* gcm, uint8_t* tag, size_t tag_len){
+
+	aes_out output_code = {
+		.termination_code = 0,
+		.msg = "Encrypt/decrypt successful"
+	};
+
+	if(gcm == NULL || tag == NULL){
+		output_code.termination_code = 1;
+		strcpy(output_code.msg, "Pointer to input data is NULL.");
+		return output_code;
+	}
+
+	if(tag_len < 4 || tag_len > GCM_TAG_BYTES){
+		aes_secure_wipe(gcm, sizeof(aes_gcm_ctx));
+		output_code.termination_code = 9;
+		strcpy(output_code.msg, "GCM call order or length is invalid.");
+		return output_code;
+	}
+
+	if(gcm->data_len == 0){
+		finish_aad(gcm);
+	}
+
+	uint8_t pos = (uint8_t) (gcm->data_len % BYTES_IN_STATE);
+	if(pos != 0){
+		memset(&gcm->partial[pos], 0, BYTES_IN_STATE - pos);
+		ghash_blocks(gcm, gcm->ghash_acc, gcm->partial, 1);
+	}
+
+	// [len(A)]64 || [len(C)]64, in bits
+	uint8_t block[BYTES_IN_STATE];
+	store_be64(block, gcm->aad_len * 8);
+	store_be64(&block[8], gcm->data_len * 8);
+	ghash_blocks(gcm, gcm->ghash_acc, block, 1);
+
+	// T = E(K, J0) ^ GHASH
+	gcm->aes->engine->encrypt_blocks(gcm->aes, gcm->j0, block, 1);
+	xor_bytes(block, block, gcm->ghash_acc, BYTES_IN_STATE);
+
+	if(gcm->direction == encrypt){
+		memcpy(tag, block, tag_len);
+	}
+	else{
+		// Compare every byte so the time taken does not show where the first mismatch is
+		uint8_t diff = 0;
+		for(uint8_t i = 0; i < tag_len; i++){
+			diff |= block[i] ^ tag[i];
+		}
+
+		if(diff != 0){
+			output_code.termination_code = 8;
+			strcpy(output_code.msg, "Authentication failed.");
+		}
+	}
+
+	aes_secure_wipe(block, sizeof(block));
+	aes_secure_wipe(gcm, sizeof(aes_gcm_ctx));
+
+	return output_code;
+}
@@ -0,0 +1,94 @@
+/*
+ ============================================================================
+ Name        : aes_gcm.h
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : AES Galois/Counter Mode (GCM) authenticated encryption, NIST
+               SP 800-38D, with a streaming init/update/final interface.
+ ============================================================================
+ */
+
+#ifndef AES_GCM_H_
+#define AES_GCM_H_
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+#include "aes_encryption.h"
+#include "ghash_clmul.h"
+#include "ghash_table.h"
+
+#define  GCM_TAG_BYTES        16
+#define  GCM_IV_BYTES         12  // Recommended IV length; other lengths are hashed into J0
+#define  GCM_MAX_DATA_BYTES   ((UINT64_C(1) << 36) - 32)  // 2^39 - 256 bits
+#define  GCM_BATCH_BLOCKS     16  // Blocks of keystream per engine call on the non-stitched path
+
+/*
+ * State for one message. The AES context must stay initialized (and must not
+ * change engine) until aes_gcm_final() returns. Call order is aes_gcm_init(),
+ * any number of aes_gcm_update_aad(), any number of aes_gcm_update(), then
+ * aes_gcm_final(). Data may be passed in pieces of any length.
+ */
+typedef struct{
+	const aes_ctx* aes;
+	ghash_table h_table;  // 4-bit multiples of H for the portable GHASH
+#ifdef AES_X86_ACCEL
+	uint8_t h_powers[GHASH_AGGREGATE][BYTES_IN_STATE] AES_ALIGNED(16);  // H^1 .. H^8 for PCLMULQDQ
+#endif
+	uint8_t j0[BYTES_IN_STATE];          // Pre-counter block, encrypted for the tag
+	uint8_t counter[BYTES_IN_STATE];     // Next counter block
+	uint8_t ghash_acc[BYTES_IN_STATE];
+	uint8_t partial[BYTES_IN_STATE];     // AAD or ciphertext bytes of an unfinished block
+	uint8_t keystream[BYTES_IN_STATE];   // Keystream for the unfinished data block
+	uint64_t aad_len;
+	uint64_t data_len;
+	aes_op_flag direction;
+	bool use_clmul;
+	bool use_stitched;  // AES-NI engine: CTR and GHASH in the same pass
+} aes_gcm_ctx;
+
+
+/*
+ * Purpose : Starts a message
+ * Inputs  : GCM state, initialized AES context, encrypt or decrypt, IV and its
+ *           length in bytes (12 recommended, must not be 0)
+ * Outputs : termination_code 0 on success
+ * Notes   : An IV must never be reused with the same key.
+ */
+aes_out aes_gcm_init(aes_gcm_ctx* gcm, const aes_ctx* ctx, aes_op_flag direction, const uint8_t* iv, size_t iv_len);
+
+
+// Adds additional authenticated data. Must come before any aes_gcm_update() call.
+aes_out aes_gcm_update_aad(aes_gcm_ctx* gcm, const uint8_t* aad, size_t aad_len);
+
+
+/*
+ * Purpose : Encrypts or decrypts the next num_bytes of the message
+ * Inputs  : GCM state, input, output location (may equal in), length
+ * Outputs : termination_code 0 on success
+ * Notes   : Decrypted data is not authenticated until aes_gcm_final() returns
+ *           success. It must not be used before then.
+ */
+aes_out aes_gcm_update(aes_gcm_ctx* gcm, const uint8_t* in, uint8_t* out, size_t num_bytes);
+
+
+/*
+ * Purpose : Finishes the message. When encrypting, writes the tag. When
+ *           decrypting, compares the computed tag with the one given.
+ * Inputs  : GCM state, tag (output for encryption, input for decryption), tag
+ *           length in bytes (4 to 16)
+ * Outputs : termination_code 0 on success, 8 if the tag does not match. The
+ *           state is wiped either way.
+ */
+aes_out aes_gcm_final(aes_gcm_ctx* gcm, uint8_t* tag, size_t tag_len);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AES_GCM_H_ */
@@ -0,0 +1,270 @@
+/*
+ ============================================================================
+ Name        : aes_gcm_siv.c
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : AES-GCM-SIV. Per-nonce authentication and encryption keys are
+               derived from the key-generating key, the tag is the encrypted
+               POLYVAL of the AAD, the plaintext and their lengths, and the
+               tag (top bit set) is the initial counter for CTR mode.
+ Note 1      : The 4 or 6 key derivation blocks go through the engine in one
+               call, so engines that interleave blocks derive them together.
+ Note 2      : Encryption must hash the whole plaintext before it can start
+               CTR, so it is two passes. The CTR pass makes
+               GCM_SIV_BATCH_BLOCKS blocks of keystream per engine call (the
+               AES-NI engine runs all 8 in parallel). Decryption hashes each
+               batch of plaintext straight after decrypting it, while it is
+               still in cache.
+ ============================================================================
+ */
+
+#include "aes_gcm_siv.h"
+#include "polyval.h"
+
+typedef struct{
+	aes_ctx enc;                  // Message-encryption key
+	polyval_key auth;             // Message-authentication key
+	uint8_t acc[BYTES_IN_STATE];  // POLYVAL accumulator
+} gcm_siv_state;
+
+
+static void store_le64(uint8_t* bytes, uint64_t value){
+	for(uint8_t i = 0; i < 8; i++){
+		bytes[i] = (uint8_t) value;
+		value >>= 8;
+	}
+}
+
+
+static aes_out gcm_siv_check_args(const aes_ctx* ctx, const uint8_t* nonce, const uint8_t* aad, size_t aad_len,
+                                  const uint8_t* in, const uint8_t* out, size_t data_len, const uint8_t* tag){
+
+	aes_out output_code = {
+		.termination_code = 0,
+		.msg = "Encrypt/decrypt successful"
+	};
+
+	if(ctx == NULL){
+		output_code.termination_code = 3;
+		strcpy(output_code.msg, "Pointer to AES context is NULL.");
+		return output_code;
+	}
+
+	if(ctx->Nk != 4 && ctx->Nk != 8){
+		output_code.termination_code = 2;
+		strcpy(output_code.msg, "GCM-SIV needs a 128 or 256-bit key.");
+		return output_code;
+	}
+
+	if(nonce == NULL){
+		output_code.termination_code = 5;
+		strcpy(output_code.msg, "Pointer to nonce is NULL.");
+		return output_code;
+	}
+
+	if((data_len > 0 && (in == NULL || out == NULL)) || (aad_len > 0 && aad == NULL) || tag == NULL){
+		output_code.termination_code = 1;
+		strcpy(output_code.msg, "Pointer to input data is NULL.");
+		return output_code;
+	}
+
+	if((uint64_t) data_len > GCM_SIV_MAX_BYTES || (uint64_t) aad_len > GCM_SIV_MAX_BYTES){
+		output_code.termination_code = 6;
+		strcpy(output_code.msg, "GCM-SIV data or AAD is too long.");
+		return output_code;
+	}
+
+	return output_code;
+}
+
+
+// Derives the per-nonce keys (RFC 8452 section 4) and hashes the AAD
+static void gcm_siv_start(gcm_siv_state* state, const aes_ctx* ctx, const uint8_t* nonce, const uint8_t* aad, size_t aad_len){
+
+	uint8_t blocks[6 * BYTES_IN_STATE] AES_ALIGNED(16);
+	uint8_t keys[4 * 8 + 16];
+	uint8_t num_blocks = (ctx->Nk == 8) ? 6 : 4;
+
+	// Block i is a little-endian 32-bit i followed by the nonce; the first half of each output is kept
+	for(uint8_t i = 0; i < num_blocks; i++){
+		uint8_t* block = &blocks[i * BYTES_IN_STATE];
+		block[0] = i;
+		block[1] = 0;
+		block[2] = 0;
+		block[3] = 0;
+		memcpy(&block[4], nonce, GCM_SIV_NONCE_BYTES);
+	}
+
+	ctx->engine->encrypt_blocks(ctx, blocks, blocks, num_blocks);
+
+	for(uint8_t i = 0; i < num_blocks; i++){
+		memcpy(&keys[i * 8], &blocks[i * BYTES_IN_STATE], 8);
+	}
+
+	polyval_init(&state->auth, keys);
+
+	// Derived key runs on the same engine as the key-generating key
+	aes_ctx_init(&state->enc, (ctx->Nk == 8) ? key_256 : key_128, &keys[16]);
+	aes_ctx_set_engine(&state->enc, (aes_engine_id) (ctx->engine - aes_engines));
+
+	aes_secure_wipe(blocks, sizeof(blocks));
+	aes_secure_wipe(keys, sizeof(keys));
+
+	memset(state->acc, 0, BYTES_IN_STATE);
+	size_t full_blocks = aad_len / BYTES_IN_STATE;
+	polyval_blocks(&state->auth, state->acc, aad, full_blocks);
+
+	size_t rest = aad_len - full_blocks * BYTES_IN_STATE;
+	if(rest > 0){
+		uint8_t last[BYTES_IN_STATE] = {0};
+		memcpy(last, &aad[full_blocks * BYTES_IN_STATE], rest);
+		polyval_blocks(&state->auth, state->acc, last, 1);
+	}
+}
+
+
+// Hashes data, zero padding a short last block
+static void gcm_siv_hash(gcm_siv_state* state, const uint8_t* data, size_t data_len){
+
+	size_t full_blocks = data_len / BYTES_IN_STATE;
+	polyval_blocks(&state->auth, state->acc, data, full_blocks);
+
+	size_t rest = data_len - full_blocks * BYTES_IN_STATE;
+	if(rest > 0){
+		uint8_t last[BYTES_IN_STATE] = {0};
+		memcpy(last, &data[full_blocks * BYTES_IN_STATE], rest);
+		polyval_blocks(&state->auth, state->acc, last, 1);
+		aes_secure_wipe(last, sizeof(last));
+	}
+}
+
+
+// Hashes the length block and encrypts the masked POLYVAL result into the tag
+static void gcm_siv_tag(gcm_siv_state* state, const uint8_t* nonce, size_t aad_len, size_t data_len, uint8_t* tag){
+
+	uint8_t length_block[BYTES_IN_STATE];
+	store_le64(length_block, (uint64_t) aad_len * 8);
+	store_le64(&length_block[8], (uint64_t) data_len * 8);
+	polyval_blocks(&state->auth, state->acc, length_block, 1);
+
+	for(uint8_t i = 0; i < GCM_SIV_NONCE_BYTES; i++){
+		state->acc[i] ^= nonce[i];
+	}
+	state->acc[BYTES_IN_STATE - 1] &= 0x7f;
+
+	state->enc.engine->encrypt_blocks(&state->enc, state->acc, tag, 1);
+}
+
+
+/*
+ * CTR with the counter in the first 32 bits, little-endian, wrapping modulo
+ * 2^32. When hash_output is set, each batch of output (the plaintext, when
+ * decrypting) is hashed right after it is written.
+ */
+static void gcm_siv_ctr(gcm_siv_state* state, const uint8_t* tag, const uint8_t* in, uint8_t* out, size_t data_len, bool hash_output){
+
+	uint8_t counters[GCM_SIV_BATCH_BLOCKS * BYTES_IN_STATE] AES_ALIGNED(16);
+	uint8_t keystream[GCM_SIV_BATCH_BLOCKS * BYTES_IN_STATE] AES_ALIGNED(16);
+
+	uint32_t counter = load_le32(tag);
+
+	for(uint8_t block = 0; block < GCM_SIV_BATCH_BLOCKS; block++){
+		memcpy(&counters[block * BYTES_IN_STATE], tag, BYTES_IN_STATE);
+		counters[block * BYTES_IN_STATE + BYTES_IN_STATE - 1] |= 0x80;
+	}
+
+	while(data_len > 0){
+
+		size_t num_blocks = (data_len + BYTES_IN_STATE - 1) / BYTES_IN_STATE;
+		if(num_blocks > GCM_SIV_BATCH_BLOCKS){
+			num_blocks = GCM_SIV_BATCH_BLOCKS;
+		}
+
+		// Only the counter words change between batches
+		for(size_t block = 0; block < num_blocks; block++){
+			store_le32(&counters[block * BYTES_IN_STATE], counter);
+			counter++;
+		}
+
+		state->enc.engine->encrypt_blocks(&state->enc, counters, keystream, num_blocks);
+
+		size_t chunk = num_blocks * BYTES_IN_STATE;
+		if(chunk > data_len){
+			chunk = data_len;
+		}
+
+		xor_bytes(out, in, keystream, chunk);
+
+		if(hash_output){
+			gcm_siv_hash(state, out, chunk);
+		}
+
+		in += chunk;
+		out += chunk;
+		data_len -= chunk;
+	}
+
+	aes_secure_wipe(keystream, sizeof(keystream));
+}
+
+
+aes_out aes_gcm_siv_encrypt(const aes_ctx* ctx, const uint8_t* nonce, const uint8_t* aad, size_t aad_len,
+                            const uint8_t* in, uint8_t* out, size_t data_len, uint8_t* tag){
+
+	aes_out output_code = gcm_siv_check_args(ctx, nonce, aad, aad_len, in, out, data_len, tag);
+	if(output_code.termination_code != 0){
+		return output_code;
+	}
+
+	gcm_siv_state state;
+	gcm_siv_start(&state, ctx, nonce, aad, aad_len);
+
+	gcm_siv_hash(&state, in, data_len);
+	gcm_siv_tag(&state, nonce, aad_len, data_len, tag);
+
+	gcm_siv_ctr(&state, tag, in, out, data_len, false);
+
+	aes_secure_wipe(&state, sizeof(state));
+
+	return output_code;
+}
+
+
+aes_out aes_gcm_siv_decrypt(const aes_ctx* ctx, const uint8_t* nonce, const uint8_t* aad, size_t aad_len,
+                            const uint8_t* in, uint8_t* out, size_t data_len, const uint8_t* tag){
+
+	aes_out output_code = gcm_siv_check_args(ctx, nonce, aad, aad_len, in, out, data_len, tag);
+	if(output_code.termination_code != 0){
+		return output_code;
+	}
+
+	gcm_siv_state state;
+	gcm_siv_start(&state, ctx, nonce, aad, aad_len);
+
+	// Batches are whole blocks, so hashing them one batch at a time pads only the last block
+	gcm_siv_ctr(&state, tag, in, out, data_len, true);
+
+	uint8_t expected[GCM_SIV_TAG_BYTES];
+	gcm_siv_tag(&state, nonce, aad_len, data_len, expected);
+
+	// Constant time compare
+	uint8_t diff = 0;
+	for(uint8_t i = 0; i < GCM_SIV_TAG_BYTES; i++){
+		diff |= expected[i] ^ tag[i];
+	}
+
+	aes_secure_wipe(expected, sizeof(expected));
+	aes_secure_wipe(&state, sizeof(state));
+
+	if(diff != 0){
+		if(data_len > 0){
+			aes_secure_wipe(out, data_len);
+		}
+		output_code.termination_code = 8;
+		strcpy(output_code.msg, "Authentication failed.");
+	}
+
+	return output_code;
+}
@@ -0,0 +1,59 @@
+/*
+ ============================================================================
+ Name        : aes_gcm_siv.h
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : AES-GCM-SIV nonce-misuse-resistant authenticated encryption
+               (RFC 8452). Repeating a nonce only reveals whether the same
+               message was encrypted twice under it; it does not leak the
+               keystream or the authentication key like GCM does.
+ ============================================================================
+ */
+
+#ifndef AES_GCM_SIV_H_
+#define AES_GCM_SIV_H_
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+#include "aes_encryption.h"
+
+#define  GCM_SIV_NONCE_BYTES   12
+#define  GCM_SIV_TAG_BYTES     16
+#define  GCM_SIV_MAX_BYTES     (UINT64_C(1) << 36)  // Limit on both the AAD and the data
+#define  GCM_SIV_BATCH_BLOCKS  8                    // Counter blocks per engine call
+
+
+/*
+ * Purpose : Encrypts and authenticates a whole message.
+ * Inputs  : Context holding the key-generating key (128 or 256 bits), 12-byte
+ *           nonce, additional authenticated data (may be NULL when aad_len is
+ *           0), input data, output location (may equal in), data length,
+ *           16-byte tag output location
+ * Outputs : termination_code 0 on success
+ * Notes   : The per-nonce keys are derived on every call, and a second
+ *           context for the derived key is built on the stack (about 900
+ *           bytes in total under AES_SMALL_FOOTPRINT).
+ */
+aes_out aes_gcm_siv_encrypt(const aes_ctx* ctx, const uint8_t* nonce, const uint8_t* aad, size_t aad_len,
+                            const uint8_t* in, uint8_t* out, size_t data_len, uint8_t* tag);
+
+/*
+ * Purpose : Decrypts a message and checks its tag.
+ * Inputs  : Same as aes_gcm_siv_encrypt(), with the received tag as input
+ * Outputs : termination_code 0 on success, 8 when the tag does not match. On
+ *           a mismatch the data_len bytes at out are zeroed.
+ */
+aes_out aes_gcm_siv_decrypt(const aes_ctx* ctx, const uint8_t* nonce, const uint8_t* aad, size_t aad_len,
+                            const uint8_t* in, uint8_t* out, size_t data_len, const uint8_t* tag);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AES_GCM_SIV_H_ */
@@ -0,0 +1,369 @@
+/*
+ ============================================================================
+ Name        : aes_ni.c
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : AES engine using the x86 AES instructions. Each AESENC does a
+               whole round (SubBytes, ShiftRows, MixColumns, AddRoundKey) in
+               constant time.
+ Note 1      : Functions are compiled with the target attribute instead of
+               global -maes flags, so the rest of the module still runs on CPUs
+               without these instructions. Nothing here is called unless
+               aes_ni_supported() returned true.
+ Note 2      : AESENC has a latency of several cycles but can start a new
+               instruction every cycle, so the bulk loops work on 8 independent
+               blocks per round key.
+ ============================================================================
+ */
+
+#include "aes_ni.h"
+
+#ifdef AES_X86_ACCEL
+
+#include <immintrin.h>
+#include "cpu_features.h"
+
+#define AES_NI_TARGET  __attribute__((target("aes,sse2")))
+#define INTERLEAVE     8
+
+// Written out rather than looped so the eight blocks stay in registers at -O2
+#define LOAD_8(b, in, key) \
+	b##0 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) &in[0]), key); \
+	b##1 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) &in[16]), key); \
+	b##2 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) &in[32]), key); \
+	b##3 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) &in[48]), key); \
+	b##4 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) &in[64]), key); \
+	b##5 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) &in[80]), key); \
+	b##6 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) &in[96]), key); \
+	b##7 = _mm_xor_si128(_mm_loadu_si128((const __m128i*) &in[112]), key)
+
+#define ROUND_8(op, b, key) \
+	b##0 = op(b##0, key); b##1 = op(b##1, key); b##2 = op(b##2, key); b##3 = op(b##3, key); \
+	b##4 = op(b##4, key); b##5 = op(b##5, key); b##6 = op(b##6, key); b##7 = op(b##7, key)
+
+#define STORE_8(out, b) \
+	_mm_storeu_si128((__m128i*) &out[0], b##0); \
+	_mm_storeu_si128((__m128i*) &out[16], b##1); \
+	_mm_storeu_si128((__m128i*) &out[32], b##2); \
+	_mm_storeu_si128((__m128i*) &out[48], b##3); \
+	_mm_storeu_si128((__m128i*) &out[64], b##4); \
+	_mm_storeu_si128((__m128i*) &out[80], b##5); \
+	_mm_storeu_si128((__m128i*) &out[96], b##6); \
+	_mm_storeu_si128((__m128i*) &out[112], b##7)
+
+// Chaining value ^ next block of each chain ^ first round key
+#define CHAIN_8(b, in, offset, key) \
+	b##0 = _mm_xor_si128(b##0, _mm_xor_si128(_mm_loadu_si128((const __m128i*) &in[0][offset]), key)); \
+	b##1 = _mm_xor_si128(b##1, _mm_xor_si128(_mm_loadu_si128((const __m128i*) &in[1][offset]), key)); \
+	b##2 = _mm_xor_si128(b##2, _mm_xor_si128(_mm_loadu_si128((const __m128i*) &in[2][offset]), key)); \
+	b##3 = _mm_xor_si128(b##3, _mm_xor_si128(_mm_loadu_si128((const __m128i*) &in[3][offset]), key)); \
+	b##4 = _mm_xor_si128(b##4, _mm_xor_si128(_mm_loadu_si128((const __m128i*) &in[4][offset]), key)); \
+	b##5 = _mm_xor_si128(b##5, _mm_xor_si128(_mm_loadu_si128((const __m128i*) &in[5][offset]), key)); \
+	b##6 = _mm_xor_si128(b##6, _mm_xor_si128(_mm_loadu_si128((const __m128i*) &in[6][offset]), key)); \
+	b##7 = _mm_xor_si128(b##7, _mm_xor_si128(_mm_loadu_si128((const __m128i*) &in[7][offset]), key))
+
+
+bool aes_ni_supported(void){
+	return cpu_has_aes_ni();
+}
+
+
+/*---------------- KEY EXPANSION -------------------*/
+
+// XORs every word of the previous round key into the words above it
+// (w[i] ^= w[i-1] ^ ... ^ w[0]) and adds the broadcast word from AESKEYGENASSIST.
+AES_NI_TARGET static inline __m128i expand_step(__m128i key, __m128i assist){
+	key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+	key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+	key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+	return _mm_xor_si128(key, assist);
+}
+
+// The round constant must be an immediate, hence the macros
+#define EXPAND_128(rk, i, rcon) \
+	rk[i] = expand_step(rk[i - 1], _mm_shuffle_epi32(_mm_aeskeygenassist_si128(rk[i - 1], rcon), 0xff))
+
+#define EXPAND_256_EVEN(rk, i, rcon) \
+	rk[i] = expand_step(rk[i - 2], _mm_shuffle_epi32(_mm_aeskeygenassist_si128(rk[i - 1], rcon), 0xff))
+
+// Odd round keys of a 256-bit schedule use SubWord without RotWord or a round constant
+#define EXPAND_256_ODD(rk, i) \
+	rk[i] = expand_step(rk[i - 2], _mm_shuffle_epi32(_mm_aeskeygenassist_si128(rk[i - 1], 0x00), 0xaa))
+
+
+AES_NI_TARGET static void expand_128(const uint8_t* cipher_key, uint8_t* key_schedule){
+
+	__m128i rk[11];
+
+	rk[0] = _mm_loadu_si128((const __m128i*) cipher_key);
+	EXPAND_128(rk, 1, 0x01);
+	EXPAND_128(rk, 2, 0x02);
+	EXPAND_128(rk, 3, 0x04);
+	EXPAND_128(rk, 4, 0x08);
+	EXPAND_128(rk, 5, 0x10);
+	EXPAND_128(rk, 6, 0x20);
+	EXPAND_128(rk, 7, 0x40);
+	EXPAND_128(rk, 8, 0x80);
+	EXPAND_128(rk, 9, 0x1b);
+	EXPAND_128(rk, 10, 0x36);
+
+	for(uint8_t i = 0; i <= 10; i++){
+		_mm_storeu_si128((__m128i*) &key_schedule[i * BYTES_IN_STATE], rk[i]);
+	}
+}
+
+
+// One 192-bit step: six new schedule words from the previous six (lo holds
+// words 0-3, hi holds words 4-5 in its low half).
+AES_NI_TARGET static inline void expand_192_step(__m128i* lo, __m128i* hi, __m128i assist){
+
+	assist = _mm_shuffle_epi32(assist, 0x55);
+	*lo = expand_step(*lo, assist);
+
+	__m128i last = _mm_shuffle_epi32(*lo, 0xff);
+	*hi = _mm_xor_si128(*hi, _mm_slli_si128(*hi, 4));
+	*hi = _mm_xor_si128(*hi, last);
+}
+
+#define EXPAND_192(lo, hi, rcon) \
+	expand_192_step(&lo, &hi, _mm_aeskeygenassist_si128(hi, rcon))
+
+
+AES_NI_TARGET static void expand_192(const uint8_t* cipher_key, uint8_t* key_schedule){
+
+	// The schedule is written 24 bytes (6 words) at a time. The last step runs past
+	// the 208 bytes of round keys but stays inside KEY_SCHED_MAX_BYTES.
+	__m128i lo = _mm_loadu_si128((const __m128i*) cipher_key);
+	__m128i hi = _mm_loadl_epi64((const __m128i*) &cipher_key[16]);
+	uint8_t* dst = key_schedule;
+
+	_mm_storeu_si128((__m128i*) dst, lo);
+	_mm_storel_epi64((__m128i*) &dst[16], hi);
+
+	EXPAND_192(lo, hi, 0x01); dst += 24; _mm_storeu_si128((__m128i*) dst, lo); _mm_storel_epi64((__m128i*) &dst[16], hi);
+	EXPAND_192(lo, hi, 0x02); dst += 24; _mm_storeu_si128((__m128i*) dst, lo); _mm_storel_epi64((__m128i*) &dst[16], hi);
+	EXPAND_192(lo, hi, 0x04); dst += 24; _mm_storeu_si128((__m128i*) dst, lo); _mm_storel_epi64((__m128i*) &dst[16], hi);
+	EXPAND_192(lo, hi, 0x08); dst += 24; _mm_storeu_si128((__m128i*) dst, lo); _mm_storel_epi64((__m128i*) &dst[16], hi);
+	EXPAND_192(lo, hi, 0x10); dst += 24; _mm_storeu_si128((__m128i*) dst, lo); _mm_storel_epi64((__m128i*) &dst[16], hi);
+	EXPAND_192(lo, hi, 0x20); dst += 24; _mm_storeu_si128((__m128i*) dst, lo); _mm_storel_epi64((__m128i*) &dst[16], hi);
+	EXPAND_192(lo, hi, 0x40); dst += 24; _mm_storeu_si128((__m128i*) dst, lo); _mm_storel_epi64((__m128i*) &dst[16], hi);
+	EXPAND_192(lo, hi, 0x80); dst += 24; _mm_storeu_si128((__m128i*) dst, lo); _mm_storel_epi64((__m128i*) &dst[16], hi);
+}
+
+
+AES_NI_TARGET static void expand_256(const uint8_t* cipher_key, uint8_t* key_schedule){
+
+	__m128i rk[15];
+
+	rk[0] = _mm_loadu_si128((const __m128i*) cipher_key);
+	rk[1] = _mm_loadu_si128((const __m128i*) &cipher_key[16]);
+	EXPAND_256_EVEN(rk, 2, 0x01);
+	EXPAND_256_ODD(rk, 3);
+	EXPAND_256_EVEN(rk, 4, 0x02);
+	EXPAND_256_ODD(rk, 5);
+	EXPAND_256_EVEN(rk, 6, 0x04);
+	EXPAND_256_ODD(rk, 7);
+	EXPAND_256_EVEN(rk, 8, 0x08);
+	EXPAND_256_ODD(rk, 9);
+	EXPAND_256_EVEN(rk, 10, 0x10);
+	EXPAND_256_ODD(rk, 11);
+	EXPAND_256_EVEN(rk, 12, 0x20);
+	EXPAND_256_ODD(rk, 13);
+	EXPAND_256_EVEN(rk, 14, 0x40);
+
+	for(uint8_t i = 0; i <= 14; i++){
+		_mm_storeu_si128((__m128i*) &key_schedule[i * BYTES_IN_STATE], rk[i]);
+	}
+}
+
+
+void aes_ni_expand_keys(aes_ctx* ctx, const uint8_t* cipher_key){
+
+	switch(ctx->Nk){
+		case 4:
+			expand_128(cipher_key, ctx->round_keys);
+			break;
+		case 6:
+			expand_192(cipher_key, ctx->round_keys);
+			break;
+		default:
+			expand_256(cipher_key, ctx->round_keys);
+	}
+}
+
+
+AES_NI_TARGET void aes_ni_expand_dec_keys(aes_ctx* ctx){
+
+	const uint8_t Nr = ctx->Nr;
+	const __m128i* rk = (const __m128i*) ctx->round_keys;
+	__m128i* dk = (__m128i*) ctx->dec_round_keys;
+
+	dk[0] = _mm_load_si128(&rk[Nr]);
+
+	for(uint8_t round = 1; round < Nr; round++){
+		dk[round] = _mm_aesimc_si128(_mm_load_si128(&rk[Nr - round]));
+	}
+
+	dk[Nr] = _mm_load_si128(&rk[0]);
+}
+
+
+/*---------------- BLOCK FUNCTIONS -------------------*/
+
+AES_NI_TARGET void aes_ni_encrypt_blocks(const aes_ctx* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks){
+
+	const uint8_t Nr = ctx->Nr;
+	__m128i rk[15];
+
+	for(uint8_t i = 0; i <= Nr; i++){
+		rk[i] = _mm_load_si128((const __m128i*) &ctx->round_keys[i * BYTES_IN_STATE]);
+	}
+
+	__m128i b0, b1, b2, b3, b4, b5, b6, b7;
+
+	while(num_blocks >= INTERLEAVE){
+
+		LOAD_8(b, in, rk[0]);
+
+		for(uint8_t round = 1; round < Nr; round++){
+			ROUND_8(_mm_aesenc_si128, b, rk[round]);
+		}
+
+		ROUND_8(_mm_aesenclast_si128, b, rk[Nr]);
+		STORE_8(out, b);
+
+		in += INTERLEAVE * BYTES_IN_STATE;
+		out += INTERLEAVE * BYTES_IN_STATE;
+		num_blocks -= INTERLEAVE;
+	}
+
+	while(num_blocks > 0){
+
+		__m128i block = _mm_xor_si128(_mm_loadu_si128((const __m128i*) in), rk[0]);
+
+		for(uint8_t round = 1; round < Nr; round++){
+			block = _mm_aesenc_si128(block, rk[round]);
+		}
+
+		_mm_storeu_si128((__m128i*) out, _mm_aesenclast_si128(block, rk[Nr]));
+
+		in += BYTES_IN_STATE;
+		out += BYTES_IN_STATE;
+		num_blocks--;
+	}
+}
+
+
+AES_NI_TARGET void aes_ni_decrypt_blocks(const aes_ctx* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks){
+
+	const uint8_t Nr = ctx->Nr;
+	__m128i dk[15];
+
+	for(uint8_t i = 0; i <= Nr; i++){
+		dk[i] = _mm_load_si128((const __m128i*) &ctx->dec_round_keys[i * BYTES_IN_STATE]);
+	}
+
+	__m128i b0, b1, b2, b3, b4, b5, b6, b7;
+
+	while(num_blocks >= INTERLEAVE){
+
+		LOAD_8(b, in, dk[0]);
+
+		for(uint8_t round = 1; round < Nr; round++){
+			ROUND_8(_mm_aesdec_si128, b, dk[round]);
+		}
+
+		ROUND_8(_mm_aesdeclast_si128, b, dk[Nr]);
+		STORE_8(out, b);
+
+		in += INTERLEAVE * BYTES_IN_STATE;
+		out += INTERLEAVE * BYTES_IN_STATE;
+		num_blocks -= INTERLEAVE;
+	}
+
+	while(num_blocks > 0){
+
+		__m128i block = _mm_xor_si128(_mm_loadu_si128((const __m128i*) in), dk[0]);
+
+		for(uint8_t round = 1; round < Nr; round++){
+			block = _mm_aesdec_si128(block, dk[round]);
+		}
+
+		_mm_storeu_si128((__m128i*) out, _mm_aesdeclast_si128(block, dk[Nr]));
+
+		in += BYTES_IN_STATE;
+		out += BYTES_IN_STATE;
+		num_blocks--;
+	}
+}
+
+
+/*---------------- CBC-MAC -------------------*/
+
+AES_NI_TARGET void aes_ni_cbc_mac(const aes_ctx* ctx, uint8_t* mac, const uint8_t* in, size_t num_blocks){
+
+	const uint8_t Nr = ctx->Nr;
+	__m128i rk[15];
+
+	for(uint8_t i = 0; i <= Nr; i++){
+		rk[i] = _mm_load_si128((const __m128i*) &ctx->round_keys[i * BYTES_IN_STATE]);
+	}
+
+	__m128i block = _mm_loadu_si128((const __m128i*) mac);
+
+	while(num_blocks > 0){
+
+		block = _mm_xor_si128(block, _mm_xor_si128(_mm_loadu_si128((const __m128i*) in), rk[0]));
+
+		for(uint8_t round = 1; round < Nr; round++){
+			block = _mm_aesenc_si128(block, rk[round]);
+		}
+		block = _mm_aesenclast_si128(block, rk[Nr]);
+
+		in += BYTES_IN_STATE;
+		num_blocks--;
+	}
+
+	_mm_storeu_si128((__m128i*) mac, block);
+}
+
+
+AES_NI_TARGET void aes_ni_cbc_mac_8(const aes_ctx* ctx, uint8_t* macs, const uint8_t* const* in, size_t num_blocks){
+
+	const uint8_t Nr = ctx->Nr;
+	__m128i rk[15];
+
+	for(uint8_t i = 0; i <= Nr; i++){
+		rk[i] = _mm_load_si128((const __m128i*) &ctx->round_keys[i * BYTES_IN_STATE]);
+	}
+
+	__m128i b0, b1, b2, b3, b4, b5, b6, b7;
+
+	b0 = _mm_loadu_si128((const __m128i*) &macs[0]);
+	b1 = _mm_loadu_si128((const __m128i*) &macs[16]);
+	b2 = _mm_loadu_si128((const __m128i*) &macs[32]);
+	b3 = _mm_loadu_si128((const __m128i*) &macs[48]);
+	b4 = _mm_loadu_si128((const __m128i*) &macs[64]);
+	b5 = _mm_loadu_si128((const __m128i*) &macs[80]);
+	b6 = _mm_loadu_si128((const __m128i*) &macs[96]);
+	b7 = _mm_loadu_si128((const __m128i*) &macs[112]);
+
+	for(size_t block = 0; block < num_blocks; block++){
+
+		size_t offset = block * BYTES_IN_STATE;
+
+		CHAIN_8(b, in, offset, rk[0]);
+
+		for(uint8_t round = 1; round < Nr; round++){
+			ROUND_8(_mm_aesenc_si128, b, rk[round]);
+		}
+
+		ROUND_8(_mm_aesenclast_si128, b, rk[Nr]);
+	}
+
+	STORE_8(macs, b);
+}
+
+#endif /* AES_X86_ACCEL */
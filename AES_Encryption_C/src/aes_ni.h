@@ -0,0 +1,62 @@
+/*
+ ============================================================================
+ Name        : aes_ni.h
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : AES engine using the x86 AES instructions (AESENC, AESDEC,
+               AESKEYGENASSIST, AESIMC). Only built when AES_X86_ACCEL is
+               defined, and only selected when CPUID reports AES support.
+ ============================================================================
+ */
+
+#ifndef AES_NI_H_
+#define AES_NI_H_
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+#include <stdint.h>
+#include "aes_encryption.h"
+
+#ifdef AES_X86_ACCEL
+
+// Checks CPUID for the AES instructions (and SSE2, which they depend on)
+bool aes_ni_supported(void);
+
+// Key schedule with AESKEYGENASSIST. Output is identical to generate_key_schedule().
+void aes_ni_expand_keys(aes_ctx* ctx, const uint8_t* cipher_key);
+
+// Equivalent inverse cipher round keys with AESIMC. Identical to generate_dec_key_schedule().
+void aes_ni_expand_dec_keys(aes_ctx* ctx);
+
+/*
+ * Purpose : Encrypts/decrypts consecutive 16-byte blocks. Eight blocks are kept
+ *           in flight at once so the latency of each AESENC/AESDEC is hidden
+ *           behind the other seven.
+ * Inputs  : Initialized context, input blocks, output location, block count
+ * Outputs : Result written to out (out may equal in)
+ */
+void aes_ni_encrypt_blocks(const aes_ctx* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks);
+
+void aes_ni_decrypt_blocks(const aes_ctx* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks);
+
+// CBC-MAC over consecutive blocks. mac (16 bytes) is the chaining value in and out.
+// The round keys and chaining value stay in registers for the whole run.
+void aes_ni_cbc_mac(const aes_ctx* ctx, uint8_t* mac, const uint8_t* in, size_t num_blocks);
+
+// Advances 8 independent CBC-MAC chains by num_blocks each. Chain i reads
+// consecutive blocks from in[i] and keeps its chaining value at macs[16 * i].
+void aes_ni_cbc_mac_8(const aes_ctx* ctx, uint8_t* macs, const uint8_t* const* in, size_t num_blocks);
+
+#endif /* AES_X86_ACCEL */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AES_NI_H_ */
@@ -0,0 +1,384 @@
+/*
+ ============================================================================
+ Name        : aes_ocb.c
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : AES-OCB3 (RFC 7253). Each block is C_i = Offset_i ^ E(P_i ^ Offset_i)
+               with Offset_i = Offset_(i-1) ^ L_ntz(i), and the tag covers a
+               plain XOR checksum of the plaintext. The AAD is hashed the same
+               way with its own offsets.
+ Note 1      : Offsets for up to OCB_BATCH_BLOCKS blocks are worked out first,
+               then all of those blocks go through the engine in one call, so
+               AES-NI and the bitsliced engine get all 8 blocks at once.
+ Note 2      : Only table lookups and XORs depend on the data outside the block
+               cipher, so OCB adds almost nothing to the cost of the engine.
+ ============================================================================
+ */
+
+#include "aes_ocb.h"
+
+
+// Multiplication by x in GF(2^128), big-endian bit order (RFC 7253 section 2)
+static void ocb_double(uint8_t* out, const uint8_t* in){
+
+	uint8_t carry = in[0] >> 7;
+
+	for(uint8_t i = 0; i < BYTES_IN_STATE - 1; i++){
+		out[i] = (uint8_t) ((in[i] << 1) | (in[i + 1] >> 7));
+	}
+	out[BYTES_IN_STATE - 1] = (uint8_t) ((in[BYTES_IN_STATE - 1] << 1) ^ (carry * 0x87));
+}
+
+
+// Number of trailing zero bits (i is never 0)
+static uint8_t ntz(uint64_t i){
+
+#if defined(__GNUC__) || defined(__clang__)
+	return (uint8_t) __builtin_ctzll(i);
+#else
+	uint8_t count = 0;
+	while((i & 1) == 0){
+		i >>= 1;
+		count++;
+	}
+	return count;
+#endif
+}
+
+
+// Returns L_index, from the table or (past its end) by doubling into scratch
+static const uint8_t* get_l(const aes_ocb_key* key, uint8_t index, uint8_t* scratch){
+
+	if(index < OCB_L_COUNT){
+		return key->l[index];
+	}
+
+	memcpy(scratch, key->l[OCB_L_COUNT - 1], BYTES_IN_STATE);
+	for(uint8_t i = OCB_L_COUNT - 1; i < index; i++){
+		ocb_double(scratch, scratch);
+	}
+
+	return scratch;
+}
+
+
+/*
+ * Runs whole blocks through the block cipher with consecutive offsets. The
+ * offset is advanced past them and checksum gets the XOR of the plaintext
+ * blocks (if checksum is not NULL). With encrypt_output false the blocks are
+ * hashed instead: sum gets the XOR of E(A_i ^ Offset_i).
+ */
+static void ocb_blocks(const aes_ocb_key* key, uint8_t* offset, uint64_t* block_count, const uint8_t* in,
+		uint8_t* out, size_t num_blocks, aes_op_flag direction, uint8_t* checksum, uint8_t* sum){
+
+	uint8_t offsets[OCB_BATCH_BLOCKS * BYTES_IN_STATE];
+	uint8_t work[OCB_BATCH_BLOCKS * BYTES_IN_STATE] AES_ALIGNED(16);
+	uint8_t scratch[BYTES_IN_STATE];
+
+	while(num_blocks > 0){
+
+		size_t batch = (num_blocks > OCB_BATCH_BLOCKS) ? OCB_BATCH_BLOCKS : num_blocks;
+		size_t batch_bytes = batch * BYTES_IN_STATE;
+
+		for(size_t b = 0; b < batch; b++){
+			xor_bytes(offset, offset, get_l(key, ntz(++(*block_count)), scratch), BYTES_IN_STATE);
+			memcpy(&offsets[b * BYTES_IN_STATE], offset, BYTES_IN_STATE);
+		}
+
+		xor_bytes(work, in, offsets, batch_bytes);
+
+		if(direction == encrypt && checksum != NULL){
+			for(size_t b = 0; b < batch; b++){
+				xor_bytes(checksum, checksum, &in[b * BYTES_IN_STATE], BYTES_IN_STATE);
+			}
+		}
+
+		if(direction == decrypt){
+			key->aes.engine->decrypt_blocks(&key->aes, work, work, batch);
+		}
+		else{
+			key->aes.engine->encrypt_blocks(&key->aes, work, work, batch);
+		}
+
+		if(sum != NULL){
+			for(size_t b = 0; b < batch; b++){
+				xor_bytes(sum, sum, &work[b * BYTES_IN_STATE], BYTES_IN_STATE);
+			}
+		}
+		else{
+			xor_bytes(out, work, offsets, batch_bytes);
+
+			if(direction == decrypt){
+				for(size_t b = 0; b < batch; b++){
+					xor_bytes(checksum, checksum, &out[b * BYTES_IN_STATE], BYTES_IN_STATE);
+				}
+			}
+			out += batch_bytes;
+		}
+
+		in += batch_bytes;
+		num_blocks -= batch;
+	}
+
+	aes_secure_wipe(work, sizeof(work));
+}
+
+
+aes_out aes_ocb_init_key(aes_ocb_key* key, cipher_len cipher_key_len, const uint8_t* cipher_key){
+
+	if(key == NULL){
+		aes_out output_code = {.termination_code = 3, .msg = "Pointer to AES context is NULL."};
+		return output_code;
+	}
+
+	aes_out output_code = aes_ctx_init(&key->aes, cipher_key_len, cipher_key);
+
+	if(output_code.termination_code != 0){
+		return output_code;
+	}
+
+	aes_ctx_prepare_decrypt(&key->aes);
+
+	memset(key->l_star, 0, BYTES_IN_STATE);
+	key->aes.engine->encrypt_blocks(&key->aes, key->l_star, key->l_star, 1);
+
+	ocb_double(key->l_dollar, key->l_star);
+	ocb_double(key->l[0], key->l_dollar);
+	for(uint8_t i = 1; i < OCB_L_COUNT; i++){
+		ocb_double(key->l[i], key->l[i - 1]);
+	}
+
+	return output_code;
+}
+
+
+aes_out aes_ocb_init(aes_ocb_ctx* ocb, const aes_ocb_key* key, aes_op_flag direction,
+		const uint8_t* nonce, size_t nonce_len, size_t tag_len){
+
+	aes_out output_code = {
+		.termination_code = 0,
+		.msg = "Encrypt/decrypt successful"
+	};
+
+	if(ocb == NULL || key == NULL){
+		output_code.termination_code = 3;
+		strcpy(output_code.msg, "Pointer to AES context is NULL.");
+		return output_code;
+	}
+
+	if(nonce == NULL || nonce_len == 0 || nonce_len > OCB_MAX_NONCE_BYTES || tag_len == 0 || tag_len > OCB_TAG_BYTES){
+		output_code.termination_code = 5;
+		strcpy(output_code.msg, "Invalid nonce or tag length.");
+		return output_code;
+	}
+
+	memset(ocb, 0, sizeof(aes_ocb_ctx));
+	ocb->key = key;
+	ocb->direction = direction;
+	ocb->tag_len = (uint8_t) tag_len;
+
+	// Nonce block = num2str(TAGLEN mod 128, 7) || zeros || 1 || N
+	uint8_t nonce_block[BYTES_IN_STATE] = {0};
+	nonce_block[0] = (uint8_t) (((tag_len * 8) % 128) << 1);
+	nonce_block[BYTES_IN_STATE - 1 - nonce_len] |= 0x01;
+	memcpy(&nonce_block[BYTES_IN_STATE - nonce_len], nonce, nonce_len);
+
+	uint8_t bottom = nonce_block[BYTES_IN_STATE - 1] & 0x3f;
+	nonce_block[BYTES_IN_STATE - 1] &= 0xc0;
+
+	// Stretch = Ktop || (Ktop[1..64] ^ Ktop[9..72])
+	uint8_t stretch[BYTES_IN_STATE + 8];
+	key->aes.engine->encrypt_blocks(&key->aes, nonce_block, stretch, 1);
+	for(uint8_t i = 0; i < 8; i++){
+		stretch[BYTES_IN_STATE + i] = stretch[i] ^ stretch[i + 1];
+	}
+
+	// Offset_0 = Stretch[1 + bottom .. 128 + bottom]
+	uint8_t byte_shift = bottom / 8;
+	uint8_t bit_shift = bottom % 8;
+	for(uint8_t i = 0; i < BYTES_IN_STATE; i++){
+		ocb->offset[i] = (uint8_t) (stretch[i + byte_shift] << bit_shift);
+		if(bit_shift != 0){
+			ocb->offset[i] |= (uint8_t) (stretch[i + byte_shift + 1] >> (8 - bit_shift));
+		}
+	}
+
+	aes_secure_wipe(stretch, sizeof(stretch));
+
+	return output_code;
+}
+
+
+aes_out aes_ocb_update_aad(aes_ocb_ctx* ocb, const uint8_t* aad, size_t aad_len){
+
+	aes_out output_code = {
+		.termination_code = 0,
+		.msg = "Encrypt/decrypt successful"
+	};
+
+	if(ocb == NULL || (aad == NULL && aad_len > 0)){
+		output_code.termination_code = 1;
+		strcpy(output_code.msg, "Pointer to input data is NULL.");
+		return output_code;
+	}
+
+	const aes_ocb_key* key = ocb->key;
+
+	if(ocb->aad_partial_len > 0){
+		size_t take = BYTES_IN_STATE - ocb->aad_partial_len;
+		if(take > aad_len){
+			take = aad_len;
+		}
+
+		memcpy(&ocb->aad_partial[ocb->aad_partial_len], aad, take);
+		ocb->aad_partial_len += (uint8_t) take;
+		aad += take;
+		aad_len -= take;
+
+		if(ocb->aad_partial_len < BYTES_IN_STATE){
+			return output_code;
+		}
+
+		ocb_blocks(key, ocb->aad_offset, &ocb->num_aad_blocks, ocb->aad_partial, NULL, 1, encrypt, NULL, ocb->aad_sum);
+		ocb->aad_partial_len = 0;
+	}
+
+	size_t full_blocks = aad_len / BYTES_IN_STATE;
+	ocb_blocks(key, ocb->aad_offset, &ocb->num_aad_blocks, aad, NULL, full_blocks, encrypt, NULL, ocb->aad_sum);
+
+	ocb->aad_partial_len = (uint8_t) (aad_len % BYTES_IN_STATE);
+	memcpy(ocb->aad_partial, &aad[full_blocks * BYTES_IN_STATE], ocb->aad_partial_len);
+
+	return output_code;
+}
+
+
+aes_out aes_ocb_update(aes_ocb_ctx* ocb, const uint8_t* in, size_t in_len, uint8_t* out, size_t* out_len){
+
+	aes_out output_code = {
+		.termination_code = 0,
+		.msg = "Encrypt/decrypt successful"
+	};
+
+	if(ocb == NULL || out_len == NULL || (in_len > 0 && (in == NULL || out == NULL))){
+		output_code.termination_code = 1;
+		strcpy(output_code.msg, "Pointer to input data is NULL.");
+		return output_code;
+	}
+
+	const aes_ocb_key* key = ocb->key;
+	*out_len = 0;
+
+	// Complete the held-back block first
+	if(ocb->partial_len > 0){
+		size_t take = BYTES_IN_STATE - ocb->partial_len;
+		if(take > in_len){
+			take = in_len;
+		}
+
+		memcpy(&ocb->partial[ocb->partial_len], in, take);
+		ocb->partial_len += (uint8_t) take;
+		in += take;
+		in_len -= take;
+
+		if(ocb->partial_len < BYTES_IN_STATE){
+			return output_code;
+		}
+
+		ocb_blocks(key, ocb->offset, &ocb->num_blocks, ocb->partial, out, 1, ocb->direction, ocb->checksum, NULL);
+		ocb->partial_len = 0;
+		out += BYTES_IN_STATE;
+		*out_len += BYTES_IN_STATE;
+	}
+
+	size_t full_blocks = in_len / BYTES_IN_STATE;
+	ocb_blocks(key, ocb->offset, &ocb->num_blocks, in, out, full_blocks, ocb->direction, ocb->checksum, NULL);
+	*out_len += full_blocks * BYTES_IN_STATE;
+
+	// A short final block is handled differently, so it waits for more data or aes_ocb_final()
+	ocb->partial_len = (uint8_t) (in_len % BYTES_IN_STATE);
+	memcpy(ocb->partial, &in[full_blocks * BYTES_IN_STATE], ocb->partial_len);
+
+	return output_code;
+}
+
+
+aes_out aes_ocb_final(aes_ocb_ctx* ocb, uint8_t* out, size_t* out_len, uint8_t* tag){
+
+	aes_out output_code = {
+		.termination_code = 0,
+		.msg = "Encrypt/decrypt successful"
+	};
+
+	if(ocb == NULL || out == NULL || out_len == NULL || tag == NULL){
+		output_code.termination_code = 1;
+		strcpy(output_code.msg, "Pointer to input data is NULL.");
+		return output_code;
+	}
+
+	const aes_ocb_key* key = ocb->key;
+	uint8_t block[BYTES_IN_STATE];
+
+	// Last partial AAD block: A_* || 1 || 0s, with Offset_* = Offset_m ^ L_*
+	if(ocb->aad_partial_len > 0){
+		memset(&ocb->aad_partial[ocb->aad_partial_len], 0, BYTES_IN_STATE - ocb->aad_partial_len);
+		ocb->aad_partial[ocb->aad_partial_len] = 0x80;
+		xor_bytes(ocb->aad_offset, ocb->aad_offset, key->l_star, BYTES_IN_STATE);
+		xor_bytes(block, ocb->aad_partial, ocb->aad_offset, BYTES_IN_STATE);
+		key->aes.engine->encrypt_blocks(&key->aes, block, block, 1);
+		xor_bytes(ocb->aad_sum, ocb->aad_sum, block, BYTES_IN_STATE);
+	}
+
+	// Last partial data block: XOR with Pad = E(Offset_*), checksum gets P_* || 1 || 0s
+	*out_len = ocb->partial_len;
+	if(ocb->partial_len > 0){
+		xor_bytes(ocb->offset, ocb->offset, key->l_star, BYTES_IN_STATE);
+		key->aes.engine->encrypt_blocks(&key->aes, ocb->offset, block, 1);
+		xor_bytes(out, ocb->partial, block, ocb->partial_len);
+
+		const uint8_t* plain = (ocb->direction == encrypt) ? ocb->partial : out;
+		memset(block, 0, BYTES_IN_STATE);
+		memcpy(block, plain, ocb->partial_len);
+		block[ocb->partial_len] = 0x80;
+		xor_bytes(ocb->checksum, ocb->checksum, block, BYTES_IN_STATE);
+	}
+
+	// Tag = E(Checksum ^ Offset ^ L_$) ^ HASH(K, A)
+	xor_bytes(block, ocb->checksum, ocb->offset, BYTES_IN_STATE);
+	xor_bytes(block, block, key->l_dollar, BYTES_IN_STATE);
+	key->aes.engine->encrypt_blocks(&key->aes, block, block, 1);
+	xor_bytes(block, block, ocb->aad_sum, BYTES_IN_STATE);
+
+	if(ocb->direction == encrypt){
+		memcpy(tag, block, ocb->tag_len);
+	}
+	else{
+		// Compare every byte so the time taken does not show where the first mismatch is
+		uint8_t diff = 0;
+		for(uint8_t i = 0; i < ocb->tag_len; i++){
+			diff |= block[i] ^ tag[i];
+		}
+
+		if(diff != 0){
+			output_code.termination_code = 8;
+			strcpy(output_code.msg, "Authentication failed.");
+		}
+	}
+
+	aes_secure_wipe(block, sizeof(block));
+	aes_secure_wipe(ocb, sizeof(aes_ocb_ctx));
+
+	return output_code;
+}
+
+
+void aes_ocb_destroy_key(aes_ocb_key* key){
+
+	if(key == NULL){
+		return;
+	}
+
+	aes_secure_wipe(key, sizeof(aes_ocb_key));
+}
@@ -0,0 +1,127 @@
+/*
+ ============================================================================
+ Name        : aes_ocb.h
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : AES-OCB3 authenticated encryption (RFC 7253) with a streaming
+               init/update/final interface. One AES call per block covers both
+               encryption and authentication.
+ ============================================================================
+ */
+
+#ifndef AES_OCB_H_
+#define AES_OCB_H_
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+#include "aes_encryption.h"
+
+#define  OCB_TAG_BYTES        16
+#define  OCB_MAX_NONCE_BYTES  15
+#define  OCB_BATCH_BLOCKS     8   // Blocks per engine call in the main loop
+
+// Number of precomputed L_i values. Messages of up to 2^OCB_L_COUNT - 1 blocks
+// only use the table; longer ones work out the rare larger L_i on the fly.
+#ifdef AES_SMALL_FOOTPRINT
+#define  OCB_L_COUNT  8
+#else
+#define  OCB_L_COUNT  32
+#endif
+
+/*
+ * Key context: the expanded AES key plus the offsets that depend only on the
+ * key. L_* = E(K, 0^128), L_$ = double(L_*), L_0 = double(L_$) and
+ * L_i = double(L_(i-1)). Read-only once built, so it can be shared.
+ */
+typedef struct{
+	aes_ctx aes;
+	uint8_t l_star[BYTES_IN_STATE];
+	uint8_t l_dollar[BYTES_IN_STATE];
+	uint8_t l[OCB_L_COUNT][BYTES_IN_STATE];
+} aes_ocb_key;
+
+/*
+ * State for one message. AAD may be added at any point before
+ * aes_ocb_final(). Data may be passed in pieces of any length; bytes of an
+ * unfinished block are held back until the block fills or the message ends.
+ */
+typedef struct{
+	const aes_ocb_key* key;
+	uint8_t offset[BYTES_IN_STATE];
+	uint8_t checksum[BYTES_IN_STATE];
+	uint8_t aad_offset[BYTES_IN_STATE];
+	uint8_t aad_sum[BYTES_IN_STATE];
+	uint8_t partial[BYTES_IN_STATE];       // Held-back data bytes
+	uint8_t aad_partial[BYTES_IN_STATE];   // Held-back AAD bytes
+	uint64_t num_blocks;                   // Whole data blocks processed
+	uint64_t num_aad_blocks;
+	uint8_t partial_len;
+	uint8_t aad_partial_len;
+	uint8_t tag_len;
+	aes_op_flag direction;
+} aes_ocb_ctx;
+
+
+/*
+ * Purpose : Expands the AES key (including the decryption schedule) and builds
+ *           the L table
+ * Inputs  : OCB key context, cipher key length, cipher key
+ * Outputs : termination_code 0 on success
+ */
+aes_out aes_ocb_init_key(aes_ocb_key* key, cipher_len cipher_key_len, const uint8_t* cipher_key);
+
+
+/*
+ * Purpose : Starts a message
+ * Inputs  : Message state, key context, encrypt or decrypt, nonce (1 to 15
+ *           bytes, 12 recommended), tag length in bytes (1 to 16)
+ * Outputs : termination_code 0 on success
+ * Notes   : A nonce must never be reused with the same key.
+ */
+aes_out aes_ocb_init(aes_ocb_ctx* ocb, const aes_ocb_key* key, aes_op_flag direction,
+		const uint8_t* nonce, size_t nonce_len, size_t tag_len);
+
+
+// Adds associated data (authenticated, not encrypted)
+aes_out aes_ocb_update_aad(aes_ocb_ctx* ocb, const uint8_t* aad, size_t aad_len);
+
+
+/*
+ * Purpose : Encrypts or decrypts the next in_len bytes of the message
+ * Inputs  : Message state, input, input length, output location (room for
+ *           in_len + 15 bytes), output length pointer
+ * Outputs : termination_code 0 on success, *out_len set to the bytes written
+ *           (always a multiple of 16). out may equal in as long as no bytes
+ *           are being held back from an earlier call; otherwise the buffers
+ *           must not overlap.
+ * Notes   : Decrypted data is not authenticated until aes_ocb_final() returns
+ *           success. It must not be used before then.
+ */
+aes_out aes_ocb_update(aes_ocb_ctx* ocb, const uint8_t* in, size_t in_len, uint8_t* out, size_t* out_len);
+
+
+/*
+ * Purpose : Finishes the message: writes any held-back bytes (fewer than 16),
+ *           then writes the tag (encryption) or checks it (decryption)
+ * Inputs  : Message state, output location (room for 15 bytes), output length
+ *           pointer, tag
+ * Outputs : termination_code 0 on success, 8 if the tag does not match. The
+ *           state is wiped either way.
+ */
+aes_out aes_ocb_final(aes_ocb_ctx* ocb, uint8_t* out, size_t* out_len, uint8_t* tag);
+
+
+// Wipes the key schedule and L table
+void aes_ocb_destroy_key(aes_ocb_key* key);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AES_OCB_H_ */
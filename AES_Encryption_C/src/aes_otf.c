@@ -0,0 +1,167 @@
+/*
+ ============================================================================
+ Name        : aes_otf.c
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : On-the-fly key expansion. The schedule is handled as windows of
+               Nk words. Stepping a window forward computes the next Nk words
+               in place (FIPS 197 section 5.2), and every step can be undone,
+               so decryption walks the same windows in reverse.
+ Note 1      : A round key is 4 words, which does not line up with 6-word
+               windows, so round keys are taken one word at a time and the
+               window is stepped whenever it runs out.
+ Note 2      : Each round also pays for Nk/4 words of key expansion, about
+               one SubWord per round on top of the four SubBytes words.
+ ============================================================================
+ */
+
+#include "aes_otf.h"
+
+typedef struct{
+	uint32_t window[AES_MAX_NK];
+	uint8_t Nk;
+	uint8_t pos;   // Next word of the window to use (encryption) or one past it (decryption)
+	uint8_t step;  // Index of the current window; window i + 1 is made with aes_rcon[i]
+} otf_schedule;
+
+
+// Turns window i into window i + 1
+static inline void key_window_forward(uint32_t* window, uint8_t Nk, uint8_t step){
+
+	// RotWord moves byte 1 to byte 0, which is a right rotation of the packed word
+	window[0] ^= sub_word(gf_rotr_word(window[Nk - 1], 8)) ^ aes_rcon[step];
+
+	for(uint8_t j = 1; j < Nk; j++){
+		// One extra SubWord in the middle of the window for 256-bit AES
+		window[j] ^= (Nk == 8 && j == 4) ? sub_word(window[3]) : window[j - 1];
+	}
+}
+
+
+// Turns window i + 1 back into window i. Each word is undone from the top, while the word below it is still new.
+static inline void key_window_backward(uint32_t* window, uint8_t Nk, uint8_t step){
+
+	for(uint8_t j = Nk - 1; j > 0; j--){
+		window[j] ^= (Nk == 8 && j == 4) ? sub_word(window[3]) : window[j - 1];
+	}
+
+	window[0] ^= sub_word(gf_rotr_word(window[Nk - 1], 8)) ^ aes_rcon[step];
+}
+
+
+static inline void add_next_round_key(uint32_t* state_words, otf_schedule* schedule){
+
+	for(uint8_t col = 0; col < COLS_IN_STATE; col++){
+		if(schedule->pos == schedule->Nk){
+			key_window_forward(schedule->window, schedule->Nk, schedule->step);
+			schedule->step++;
+			schedule->pos = 0;
+		}
+		state_words[col] ^= schedule->window[schedule->pos++];
+	}
+}
+
+
+// Round keys in reverse, so the last column of each round key is taken first
+static inline void add_prev_round_key(uint32_t* state_words, otf_schedule* schedule){
+
+	for(uint8_t col = COLS_IN_STATE; col > 0; col--){
+		if(schedule->pos == 0){
+			schedule->step--;
+			key_window_backward(schedule->window, schedule->Nk, schedule->step);
+			schedule->pos = schedule->Nk;
+		}
+		state_words[col - 1] ^= schedule->window[--schedule->pos];
+	}
+}
+
+
+// Number of windows that hold the 4 * (Nr + 1) schedule words
+static inline uint8_t num_key_windows(uint8_t Nk, uint8_t Nr){
+	return (uint8_t) ((WORDS_IN_STATE * (Nr + 1) + Nk - 1) / Nk);
+}
+
+
+void otf_load_key_words(const uint8_t* cipher_key, uint8_t Nk, uint32_t* key_words){
+	for(uint8_t i = 0; i < Nk; i++){
+		key_words[i] = load_le32(&cipher_key[i * BYTES_IN_WORD]);
+	}
+}
+
+
+void otf_last_key_window(const uint32_t* key_words, uint8_t Nk, uint8_t Nr, uint32_t* last_window){
+
+	memcpy(last_window, key_words, Nk * sizeof(uint32_t));
+
+	uint8_t last_step = num_key_windows(Nk, Nr) - 1;
+
+	for(uint8_t step = 0; step < last_step; step++){
+		key_window_forward(last_window, Nk, step);
+	}
+}
+
+
+void encrypt_16_bytes_otf(uint8_t* data_16_bytes, const uint32_t* key_words, uint8_t Nk, uint8_t Nr){
+
+	otf_schedule schedule;
+	memcpy(schedule.window, key_words, Nk * sizeof(uint32_t));
+	schedule.Nk = Nk;
+	schedule.pos = 0;
+	schedule.step = 0;
+
+	uint32_t state_words[COLS_IN_STATE];
+	load_state_words(state_words, data_16_bytes);
+
+	add_next_round_key(state_words, &schedule);
+
+	for(uint8_t round = 1; round < Nr; round++){
+		sub_bytes_words(state_words);
+		shift_rows_words(state_words);
+		mix_columns_words(state_words);
+		add_next_round_key(state_words, &schedule);
+	}
+
+	// Final round does not include MixColumns
+	sub_bytes_words(state_words);
+	shift_rows_words(state_words);
+	add_next_round_key(state_words, &schedule);
+
+	store_state_words(data_16_bytes, state_words);
+
+	aes_secure_wipe(&schedule, sizeof(schedule));
+}
+
+
+void decrypt_16_bytes_otf(uint8_t* data_16_bytes, const uint32_t* last_window, uint8_t Nk, uint8_t Nr){
+
+	otf_schedule schedule;
+	memcpy(schedule.window, last_window, Nk * sizeof(uint32_t));
+	schedule.Nk = Nk;
+	schedule.step = num_key_windows(Nk, Nr) - 1;
+
+	// The final round key ends partway into the last window
+	schedule.pos = (uint8_t) (WORDS_IN_STATE * (Nr + 1) - schedule.step * Nk);
+
+	uint32_t state_words[COLS_IN_STATE];
+	load_state_words(state_words, data_16_bytes);
+
+	add_prev_round_key(state_words, &schedule);
+
+	for(uint8_t round = Nr - 1; round > 0; round--){
+		inv_shift_rows_words(state_words);
+		inv_sub_bytes_words(state_words);
+		add_prev_round_key(state_words, &schedule);
+		inv_mix_columns_words(state_words);
+	}
+
+	// The final round (# 0) doesn't include InvMixColumns
+	inv_shift_rows_words(state_words);
+	inv_sub_bytes_words(state_words);
+	add_prev_round_key(state_words, &schedule);
+
+	store_state_words(data_16_bytes, state_words);
+
+	aes_secure_wipe(&schedule, sizeof(schedule));
+}
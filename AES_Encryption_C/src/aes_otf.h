@@ -0,0 +1,52 @@
+/*
+ ============================================================================
+ Name        : aes_otf.h
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : AES with on-the-fly key expansion. Round keys are generated as
+               the rounds need them from a window of Nk schedule words, so no
+               key schedule is stored. Decryption starts from the last window
+               of the schedule and runs the expansion backwards.
+ Note 1      : Built with AES_OTF_KEYS, aes_ctx holds only the key words and
+               the last window, and the reference engine uses these functions.
+               They are available in every build, e.g. for benchmarking
+               against the stored schedule.
+ ============================================================================
+ */
+
+#ifndef AES_OTF_H_
+#define AES_OTF_H_
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+#include <stdint.h>
+#include "aes_encryption.h"
+
+
+// Packs the cipher key into Nk words, little-endian like the state columns (cipher_utils.h)
+void otf_load_key_words(const uint8_t* cipher_key, uint8_t Nk, uint32_t* key_words);
+
+/*
+ * Purpose : Expands the key forward to the window holding the final round key,
+ *           the starting point for decryption. Done once per key.
+ * Inputs  : Nk key words, Nk, Nr, output location for Nk words
+ */
+void otf_last_key_window(const uint32_t* key_words, uint8_t Nk, uint8_t Nr, uint32_t* last_window);
+
+// Encrypts one block in place, expanding the round keys from key_words as it goes
+void encrypt_16_bytes_otf(uint8_t* data_16_bytes, const uint32_t* key_words, uint8_t Nk, uint8_t Nr);
+
+// Decrypts one block in place (FIPS 197 inverse cipher), running the schedule backwards from last_window
+void decrypt_16_bytes_otf(uint8_t* data_16_bytes, const uint32_t* last_window, uint8_t Nk, uint8_t Nr);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AES_OTF_H_ */
@@ -0,0 +1,186 @@
+/*
+ ============================================================================
+ Name        : aes_workers.c
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : Worker thread pool shared by the parallel modes. Threads are
+               started the first time they are needed and then sleep on a
+               condition variable between calls.
+ Note 1      : Only one parallel call runs on the pool at a time. Tasks are
+               handed out one index at a time under the pool lock, so callers
+               should make each task large (tens of KB of data or more).
+ ============================================================================
+ */
+
+#include "aes_workers.h"
+
+#define  AES_MAX_THREADS  64
+
+static unsigned max_threads = 0;  // 0 until set or first looked up
+
+
+static void run_serial(aes_task_fn task, void* arg, size_t num_tasks){
+	for(size_t i = 0; i < num_tasks; i++){
+		task(arg, i);
+	}
+}
+
+
+#ifdef AES_THREADS
+
+#include <pthread.h>
+#include <unistd.h>
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_ready = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t work_done = PTHREAD_COND_INITIALIZER;
+
+static unsigned num_workers = 0;
+static bool pool_busy = false;
+
+// Current job. Every field is protected by pool_lock.
+static aes_task_fn job_task;
+static void* job_arg;
+static size_t job_num_tasks;
+static size_t job_next_task;
+static size_t job_tasks_done;
+static unsigned long job_generation = 0;
+
+
+// Runs tasks of the current job until none are left. Called with pool_lock held.
+static void work_on_job(void){
+
+	while(job_next_task < job_num_tasks){
+
+		size_t index = job_next_task++;
+		aes_task_fn task = job_task;
+		void* arg = job_arg;
+
+		pthread_mutex_unlock(&pool_lock);
+		task(arg, index);
+		pthread_mutex_lock(&pool_lock);
+
+		if(++job_tasks_done == job_num_tasks){
+			pthread_cond_signal(&work_done);
+		}
+	}
+}
+
+
+static void* worker_main(void* worker_id_ptr){
+
+	unsigned worker_id = (unsigned) (uintptr_t) worker_id_ptr;
+	unsigned long seen_generation = 0;
+
+	pthread_mutex_lock(&pool_lock);
+
+	while(true){
+
+		while(job_generation == seen_generation){
+			pthread_cond_wait(&work_ready, &pool_lock);
+		}
+		seen_generation = job_generation;
+
+		// Workers beyond the current limit stay idle (the caller counts as one thread)
+		if(worker_id + 1 < aes_get_max_threads()){
+			work_on_job();
+		}
+	}
+
+	return NULL;
+}
+
+
+// Starts workers until there are enough for the current limit. Called with pool_lock held.
+static void start_workers(void){
+
+	while(num_workers + 1 < aes_get_max_threads()){
+
+		pthread_t thread;
+		pthread_attr_t attr;
+
+		pthread_attr_init(&attr);
+		pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+		int error = pthread_create(&thread, &attr, worker_main, (void*) (uintptr_t) num_workers);
+		pthread_attr_destroy(&attr);
+
+		if(error != 0){
+			break;  // Carry on with the workers that did start
+		}
+
+		num_workers++;
+	}
+}
+
+
+void aes_run_parallel(aes_task_fn task, void* arg, size_t num_tasks){
+
+	if(num_tasks <= 1 || aes_get_max_threads() <= 1){
+		run_serial(task, arg, num_tasks);
+		return;
+	}
+
+	pthread_mutex_lock(&pool_lock);
+
+	if(pool_busy){
+		pthread_mutex_unlock(&pool_lock);
+		run_serial(task, arg, num_tasks);
+		return;
+	}
+
+	pool_busy = true;
+	start_workers();
+
+	job_task = task;
+	job_arg = arg;
+	job_num_tasks = num_tasks;
+	job_next_task = 0;
+	job_tasks_done = 0;
+	job_generation++;
+	pthread_cond_broadcast(&work_ready);
+
+	work_on_job();
+
+	while(job_tasks_done < job_num_tasks){
+		pthread_cond_wait(&work_done, &pool_lock);
+	}
+
+	pool_busy = false;
+	pthread_mutex_unlock(&pool_lock);
+}
+
+
+static unsigned online_cpus(void){
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	return (cpus < 1) ? 1 : (unsigned) cpus;
+}
+
+#else
+
+void aes_run_parallel(aes_task_fn task, void* arg, size_t num_tasks){
+	run_serial(task, arg, num_tasks);
+}
+
+
+static unsigned online_cpus(void){
+	return 1;
+}
+
+#endif /* AES_THREADS */
+
+
+unsigned aes_get_max_threads(void){
+
+	if(max_threads == 0){
+		max_threads = online_cpus();
+	}
+
+	return (max_threads > AES_MAX_THREADS) ? AES_MAX_THREADS : max_threads;
+}
+
+
+void aes_set_max_threads(unsigned num_threads){
+	max_threads = num_threads;
+}
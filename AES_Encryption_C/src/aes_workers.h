@@ -0,0 +1,61 @@
+/*
+ ============================================================================
+ Name        : aes_workers.h
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : Worker thread pool shared by the modes that can split a buffer
+               into independent pieces (CTR, CBC decryption, XTS sectors).
+ ============================================================================
+ */
+
+#ifndef AES_WORKERS_H_
+#define AES_WORKERS_H_
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+#include "aes_encryption.h"
+
+// Work below this many bytes per thread is not worth handing to another thread
+#define  AES_MIN_BYTES_PER_THREAD  (64 * 1024)
+
+// Runs task(arg, index) once for every index in [0, num_tasks)
+typedef void (*aes_task_fn)(void* arg, size_t index);
+
+
+/*
+ * Purpose : Runs num_tasks independent tasks and returns once all of them are
+ *           done. The calling thread works on tasks as well. Tasks may run in
+ *           any order and on any thread.
+ * Inputs  : Task function, argument passed to every task, number of tasks
+ * Outputs : None
+ * Notes   : If the pool is already busy (another thread or a task is running
+ *           a parallel call) the tasks are run on the calling thread instead.
+ *           Without AES_THREADS every task runs on the calling thread.
+ */
+void aes_run_parallel(aes_task_fn task, void* arg, size_t num_tasks);
+
+
+// Number of threads aes_run_parallel() may use, including the caller
+unsigned aes_get_max_threads(void);
+
+
+/*
+ * Purpose : Limits the number of threads used by aes_run_parallel(). 0 selects
+ *           one thread per online CPU. Must not be called while a parallel
+ *           call is running.
+ * Inputs  : Thread count including the caller
+ * Outputs : None
+ */
+void aes_set_max_threads(unsigned num_threads);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AES_WORKERS_H_ */
@@ -0,0 +1,452 @@
+/*
+ ============================================================================
+ Name        : aes_xts.c
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : XTS-AES. Block j of a sector is C = E(K1, P ^ T_j) ^ T_j, where
+               T_0 = E(K2, sector number) and T_(j+1) = T_j * x in GF(2^128).
+ Note 1      : Tweaks are made XTS_BATCH_BLOCKS at a time so the data key only
+               goes through the engine once per batch. On x86 the doubling is
+               done with SSE2: each 32-bit lane is shifted left by one and the
+               bit shifted out of the lane below (or the 0x87 reduction, for
+               lane 0) is added back in.
+ Note 2      : Each sector only depends on its own number, so sector ranges go
+               to worker threads with nothing shared but the read-only keys.
+ Note 3      : aes_xts_crypt_file() reads, processes and writes back one chunk
+               of sectors at a time, seeking relative to the current position so
+               files larger than 2GB work without 64-bit file offsets.
+ ============================================================================
+ */
+
+#include <stdio.h>
+#include "aes_xts.h"
+#include "aes_workers.h"
+
+#ifdef AES_X86_ACCEL
+#include <immintrin.h>
+#endif
+
+// Sectors read from an image file per chunk
+#define  XTS_FILE_CHUNK_BYTES  (4 * 1024 * 1024)
+
+typedef struct{
+	const aes_xts_ctx* xts;
+	uint64_t first_sector;
+	const uint8_t* in;
+	uint8_t* out;
+	size_t num_bytes;
+	size_t sector_size;
+	size_t sectors_per_task;
+	bool decrypting;
+} xts_job;
+
+
+/*
+ * Writes num_tweaks consecutive tweaks starting at tweak, and leaves tweak
+ * holding the one after the last. Tweaks are little-endian 128-bit numbers.
+ */
+#ifdef AES_X86_ACCEL
+
+__attribute__((target("sse2"))) static void make_tweaks(uint8_t* tweak, uint8_t* tweaks, size_t num_tweaks){
+
+	const __m128i carry_mask = _mm_setr_epi32(0x87, 1, 1, 1);
+	__m128i t = _mm_loadu_si128((const __m128i*) tweak);
+
+	for(size_t i = 0; i < num_tweaks; i++){
+		_mm_storeu_si128((__m128i*) &tweaks[i * BYTES_IN_STATE], t);
+
+		// Top bit of each lane, moved up one lane (lane 3's top bit goes to lane 0)
+		__m128i carries = _mm_shuffle_epi32(_mm_srai_epi32(t, 31), _MM_SHUFFLE(2, 1, 0, 3));
+		t = _mm_xor_si128(_mm_slli_epi32(t, 1), _mm_and_si128(carries, carry_mask));
+	}
+
+	_mm_storeu_si128((__m128i*) tweak, t);
+}
+
+#else
+
+static void make_tweaks(uint8_t* tweak, uint8_t* tweaks, size_t num_tweaks){
+
+	uint64_t lo = (uint64_t) load_le32(tweak) | ((uint64_t) load_le32(&tweak[4]) << 32);
+	uint64_t hi = (uint64_t) load_le32(&tweak[8]) | ((uint64_t) load_le32(&tweak[12]) << 32);
+
+	for(size_t i = 0; i < num_tweaks; i++){
+		uint8_t* out = &tweaks[i * BYTES_IN_STATE];
+		store_le32(out, (uint32_t) lo);
+		store_le32(&out[4], (uint32_t) (lo >> 32));
+		store_le32(&out[8], (uint32_t) hi);
+		store_le32(&out[12], (uint32_t) (hi >> 32));
+
+		uint64_t reduce = (hi >> 63) * 0x87;
+		hi = (hi << 1) | (lo >> 63);
+		lo = (lo << 1) ^ reduce;
+	}
+
+	store_le32(tweak, (uint32_t) lo);
+	store_le32(&tweak[4], (uint32_t) (lo >> 32));
+	store_le32(&tweak[8], (uint32_t) hi);
+	store_le32(&tweak[12], (uint32_t) (hi >> 32));
+}
+
+#endif /* AES_X86_ACCEL */
+
+
+// Runs num_blocks whole blocks starting at the given tweak, which is advanced past them
+static void xts_blocks(const aes_ctx* data_key, uint8_t* tweak, const uint8_t* in, uint8_t* out,
+		size_t num_blocks, bool decrypting){
+
+	uint8_t tweaks[XTS_BATCH_BLOCKS * BYTES_IN_STATE] AES_ALIGNED(16);
+	uint8_t work[XTS_BATCH_BLOCKS * BYTES_IN_STATE] AES_ALIGNED(16);
+
+	while(num_blocks > 0){
+
+		size_t batch = (num_blocks > XTS_BATCH_BLOCKS) ? XTS_BATCH_BLOCKS : num_blocks;
+		size_t batch_bytes = batch * BYTES_IN_STATE;
+
+		make_tweaks(tweak, tweaks, batch);
+
+		xor_bytes(work, in, tweaks, batch_bytes);
+		if(decrypting){
+			data_key->engine->decrypt_blocks(data_key, work, work, batch);
+		}
+		else{
+			data_key->engine->encrypt_blocks(data_key, work, work, batch);
+		}
+		xor_bytes(out, work, tweaks, batch_bytes);
+
+		in += batch_bytes;
+		out += batch_bytes;
+		num_blocks -= batch;
+	}
+
+	aes_secure_wipe(work, sizeof(work));
+}
+
+
+static void xts_sector(const aes_xts_ctx* xts, uint64_t sector_num, const uint8_t* in, uint8_t* out,
+		size_t num_bytes, bool decrypting){
+
+	// T_0 = E(K2, sector number as a 16-byte little-endian value)
+	uint8_t tweak[BYTES_IN_STATE] = {0};
+	store_le32(tweak, (uint32_t) sector_num);
+	store_le32(&tweak[4], (uint32_t) (sector_num >> 32));
+	xts->tweak_key.engine->encrypt_blocks(&xts->tweak_key, tweak, tweak, 1);
+
+	size_t full_blocks = num_bytes / BYTES_IN_STATE;
+	size_t tail = num_bytes % BYTES_IN_STATE;
+
+	if(tail == 0){
+		xts_blocks(&xts->data_key, tweak, in, out, full_blocks, decrypting);
+		return;
+	}
+
+	// Ciphertext stealing: the last whole block and the partial block are handled together
+	size_t last_full = (full_blocks - 1) * BYTES_IN_STATE;
+	xts_blocks(&xts->data_key, tweak, in, out, full_blocks - 1, decrypting);
+
+	uint8_t tweak_pair[2 * BYTES_IN_STATE];  // T_(m-1) and T_m
+	uint8_t block[BYTES_IN_STATE];
+	make_tweaks(tweak, tweak_pair, 2);
+
+	// Encryption uses T_(m-1) first; decryption has to undo the T_m step first
+	const uint8_t* first_tweak = decrypting ? &tweak_pair[BYTES_IN_STATE] : tweak_pair;
+	const uint8_t* second_tweak = decrypting ? tweak_pair : &tweak_pair[BYTES_IN_STATE];
+
+	xor_bytes(block, &in[last_full], first_tweak, BYTES_IN_STATE);
+	if(decrypting){
+		xts->data_key.engine->decrypt_blocks(&xts->data_key, block, block, 1);
+	}
+	else{
+		xts->data_key.engine->encrypt_blocks(&xts->data_key, block, block, 1);
+	}
+	xor_bytes(block, block, first_tweak, BYTES_IN_STATE);
+
+	// The partial block's bytes swap places with the head of this block
+	uint8_t stolen[BYTES_IN_STATE];
+	memcpy(stolen, &in[last_full + BYTES_IN_STATE], tail);
+	memcpy(&out[last_full + BYTES_IN_STATE], block, tail);
+	memcpy(block, stolen, tail);
+
+	xor_bytes(block, block, second_tweak, BYTES_IN_STATE);
+	if(decrypting){
+		xts->data_key.engine->decrypt_blocks(&xts->data_key, block, block, 1);
+	}
+	else{
+		xts->data_key.engine->encrypt_blocks(&xts->data_key, block, block, 1);
+	}
+	xor_bytes(&out[last_full], block, second_tweak, BYTES_IN_STATE);
+
+	aes_secure_wipe(block, sizeof(block));
+	aes_secure_wipe(stolen, sizeof(stolen));
+}
+
+
+static void xts_task(void* arg, size_t index){
+
+	const xts_job* job = (const xts_job*) arg;
+
+	size_t first = index * job->sectors_per_task;
+	size_t offset = first * job->sector_size;
+
+	for(size_t sector = 0; sector < job->sectors_per_task && offset < job->num_bytes; sector++){
+
+		size_t num_bytes = job->num_bytes - offset;
+		if(num_bytes > job->sector_size){
+			num_bytes = job->sector_size;
+		}
+
+		xts_sector(job->xts, job->first_sector + first + sector, &job->in[offset], &job->out[offset],
+				num_bytes, job->decrypting);
+
+		offset += num_bytes;
+	}
+}
+
+
+static aes_out check_xts_input(const aes_xts_ctx* xts, const uint8_t* in, const uint8_t* out,
+		size_t num_bytes, size_t sector_size){
+
+	aes_out output_code = {
+		.termination_code = 0,
+		.msg = "Encrypt/decrypt successful"
+	};
+
+	if(xts == NULL){
+		output_code.termination_code = 3;
+		strcpy(output_code.msg, "Pointer to AES context is NULL.");
+	}
+	else if(in == NULL || out == NULL){
+		output_code.termination_code = 1;
+		strcpy(output_code.msg, "Pointer to input data is NULL.");
+	}
+	else if(sector_size < BYTES_IN_STATE || (num_bytes % sector_size != 0 && num_bytes % sector_size < BYTES_IN_STATE)){
+		output_code.termination_code = 6;
+		strcpy(output_code.msg, "XTS data unit is shorter than 16 bytes.");
+	}
+
+	return output_code;
+}
+
+
+static aes_out xts_sectors(const aes_xts_ctx* xts, uint64_t first_sector, const uint8_t* in, uint8_t* out,
+		size_t num_bytes, size_t sector_size, bool decrypting){
+
+	aes_out output_code = check_xts_input(xts, in, out, num_bytes, sector_size);
+
+	if(output_code.termination_code != 0 || num_bytes == 0){
+		return output_code;
+	}
+
+	size_t num_sectors = (num_bytes + sector_size - 1) / sector_size;
+	unsigned num_threads = aes_get_max_threads();
+
+	// At least AES_MIN_BYTES_PER_THREAD per task, and a few tasks per thread
+	size_t sectors_per_task = num_sectors / (4 * (size_t) num_threads);
+	if(sectors_per_task * sector_size < AES_MIN_BYTES_PER_THREAD){
+		sectors_per_task = (AES_MIN_BYTES_PER_THREAD + sector_size - 1) / sector_size;
+	}
+
+	xts_job job = {
+		.xts = xts,
+		.first_sector = first_sector,
+		.in = in,
+		.out = out,
+		.num_bytes = num_bytes,
+		.sector_size = sector_size,
+		.sectors_per_task = sectors_per_task,
+		.decrypting = decrypting
+	};
+
+	aes_run_parallel(xts_task, &job, (num_sectors + sectors_per_task - 1) / sectors_per_task);
+
+	return output_code;
+}
+
+
+aes_out aes_xts_init(aes_xts_ctx* xts, cipher_len key_len, const uint8_t* key){
+
+	aes_out output_code = {
+		.termination_code = 0,
+		.msg = "Encrypt/decrypt successful"
+	};
+
+	if(xts == NULL){
+		output_code.termination_code = 3;
+		strcpy(output_code.msg, "Pointer to AES context is NULL.");
+		return output_code;
+	}
+
+	if(key == NULL){
+		output_code.termination_code = 2;
+		strcpy(output_code.msg, "Pointer to cipher key is NULL.");
+		return output_code;
+	}
+
+	// IEEE 1619 defines XTS-AES-128 and XTS-AES-256 only
+	if(key_len != key_128 && key_len != key_256){
+		output_code.termination_code = 2;
+		strcpy(output_code.msg, "XTS needs a 128 or 256-bit key.");
+		return output_code;
+	}
+
+	size_t half_bytes = (size_t) key_len / 8;
+
+	// Equal halves would make the tweak predictable from the data key (SP 800-38E)
+	if(memcmp(key, &key[half_bytes], half_bytes) == 0){
+		output_code.termination_code = 2;
+		strcpy(output_code.msg, "XTS data and tweak keys must differ.");
+		return output_code;
+	}
+
+	output_code = aes_ctx_init(&xts->data_key, key_len, key);
+	if(output_code.termination_code != 0){
+		return output_code;
+	}
+
+	output_code = aes_ctx_init(&xts->tweak_key, key_len, &key[half_bytes]);
+	if(output_code.termination_code != 0){
+		aes_ctx_destroy(&xts->data_key);
+		return output_code;
+	}
+
+	// Built now so the context is read-only from here on
+	aes_ctx_prepare_decrypt(&xts->data_key);
+
+	return output_code;
+}
+
+
+aes_out aes_xts_encrypt_sector(const aes_xts_ctx* xts, uint64_t sector_num, const uint8_t* in, uint8_t* out, size_t num_bytes){
+
+	aes_out output_code = check_xts_input(xts, in, out, num_bytes, num_bytes);
+
+	if(output_code.termination_code == 0){
+		xts_sector(xts, sector_num, in, out, num_bytes, false);
+	}
+
+	return output_code;
+}
+
+
+aes_out aes_xts_decrypt_sector(const aes_xts_ctx* xts, uint64_t sector_num, const uint8_t* in, uint8_t* out, size_t num_bytes){
+
+	aes_out output_code = check_xts_input(xts, in, out, num_bytes, num_bytes);
+
+	if(output_code.termination_code == 0){
+		xts_sector(xts, sector_num, in, out, num_bytes, true);
+	}
+
+	return output_code;
+}
+
+
+aes_out aes_xts_encrypt_sectors(const aes_xts_ctx* xts, uint64_t first_sector, const uint8_t* in, uint8_t* out,
+		size_t num_bytes, size_t sector_size){
+	return xts_sectors(xts, first_sector, in, out, num_bytes, sector_size, false);
+}
+
+
+aes_out aes_xts_decrypt_sectors(const aes_xts_ctx* xts, uint64_t first_sector, const uint8_t* in, uint8_t* out,
+		size_t num_bytes, size_t sector_size){
+	return xts_sectors(xts, first_sector, in, out, num_bytes, sector_size, true);
+}
+
+
+aes_out aes_xts_crypt_file(const char* path, const aes_xts_ctx* xts, size_t sector_size, aes_op_flag direction){
+
+	aes_out output_code = {
+		.termination_code = 0,
+		.msg = "Encrypt/decrypt successful"
+	};
+
+	if(path == NULL || xts == NULL || sector_size < BYTES_IN_STATE || sector_size > XTS_FILE_CHUNK_BYTES){
+		output_code.termination_code = 1;
+		strcpy(output_code.msg, "Invalid image path, context or sector size.");
+		return output_code;
+	}
+
+	FILE* image = fopen(path, "r+b");
+	if(image == NULL){
+		output_code.termination_code = 12;
+		strcpy(output_code.msg, "Could not open image file.");
+		return output_code;
+	}
+
+	// Refuse a file whose last sector is too short before any of it is changed. ftell()
+	// fails for files past 2GB where long is 32 bits; the per-chunk check still applies there.
+	if(fseek(image, 0, SEEK_END) == 0){
+		long file_size = ftell(image);
+		if(file_size > 0 && (size_t) file_size % sector_size != 0 && (size_t) file_size % sector_size < BYTES_IN_STATE){
+			fclose(image);
+			output_code.termination_code = 6;
+			strcpy(output_code.msg, "XTS data unit is shorter than 16 bytes.");
+			return output_code;
+		}
+	}
+	rewind(image);
+
+	size_t chunk_bytes = XTS_FILE_CHUNK_BYTES - (XTS_FILE_CHUNK_BYTES % sector_size);
+	uint8_t* chunk = malloc(chunk_bytes);
+	uint64_t sector_num = 0;
+
+	if(chunk == NULL){
+		fclose(image);
+		output_code.termination_code = 12;
+		strcpy(output_code.msg, "Could not allocate the file buffer.");
+		return output_code;
+	}
+
+	while(output_code.termination_code == 0){
+
+		size_t num_read = fread(chunk, 1, chunk_bytes, image);
+
+		if(num_read == 0){
+			if(ferror(image)){
+				output_code.termination_code = 12;
+				strcpy(output_code.msg, "Could not read image file.");
+			}
+			break;
+		}
+
+		output_code = (direction == encrypt) ?
+				aes_xts_encrypt_sectors(xts, sector_num, chunk, chunk, num_read, sector_size) :
+				aes_xts_decrypt_sectors(xts, sector_num, chunk, chunk, num_read, sector_size);
+
+		if(output_code.termination_code != 0){
+			break;
+		}
+
+		// Back up over the chunk, overwrite it, then re-sync the stream before the next read
+		if(fseek(image, -(long) num_read, SEEK_CUR) != 0 || fwrite(chunk, 1, num_read, image) != num_read ||
+				fseek(image, 0, SEEK_CUR) != 0){
+			output_code.termination_code = 12;
+			strcpy(output_code.msg, "Could not write image file.");
+			break;
+		}
+
+		sector_num += num_read / sector_size;
+	}
+
+	aes_secure_wipe(chunk, chunk_bytes);
+	free(chunk);
+
+	if(fclose(image) != 0 && output_code.termination_code == 0){
+		output_code.termination_code = 12;
+		strcpy(output_code.msg, "Could not write image file.");
+	}
+
+	return output_code;
+}
+
+
+void aes_xts_destroy(aes_xts_ctx* xts){
+
+	if(xts == NULL){
+		return;
+	}
+
+	aes_ctx_destroy(&xts->data_key);
+	aes_ctx_destroy(&xts->tweak_key);
+}
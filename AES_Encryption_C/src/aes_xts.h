@@ -0,0 +1,94 @@
+/*
+ ============================================================================
+ Name        : aes_xts.h
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : XTS-AES (IEEE 1619, NIST SP 800-38E) for sector and disk image
+               encryption, with ciphertext stealing for data units that are
+               not a multiple of 16 bytes.
+ ============================================================================
+ */
+
+#ifndef AES_XTS_H_
+#define AES_XTS_H_
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+#include "aes_encryption.h"
+
+// Blocks of tweaks made and run through the engine at a time
+#define  XTS_BATCH_BLOCKS  16
+
+/*
+ * Two independent AES keys: one encrypts the data, the other encrypts the
+ * sector number to make the starting tweak. Built once by aes_xts_init() and
+ * only read afterwards, so one context can serve any number of threads.
+ */
+typedef struct{
+	aes_ctx data_key;
+	aes_ctx tweak_key;
+} aes_xts_ctx;
+
+
+/*
+ * Purpose : Expands both XTS keys
+ * Inputs  : XTS context, length of each half (key_128 for XTS-AES-128,
+ *           key_256 for XTS-AES-256), key (data key followed by tweak key,
+ *           so 32 or 64 bytes)
+ * Outputs : termination_code 0 on success, 2 for any other key length or
+ *           when the two halves are equal.
+ */
+aes_out aes_xts_init(aes_xts_ctx* xts, cipher_len key_len, const uint8_t* key);
+
+
+/*
+ * Purpose : Encrypts/decrypts one data unit (sector)
+ * Inputs  : XTS context, data unit number, input, output location (may equal
+ *           in), length in bytes (at least 16)
+ * Outputs : termination_code 0 on success
+ */
+aes_out aes_xts_encrypt_sector(const aes_xts_ctx* xts, uint64_t sector_num, const uint8_t* in, uint8_t* out, size_t num_bytes);
+
+aes_out aes_xts_decrypt_sector(const aes_xts_ctx* xts, uint64_t sector_num, const uint8_t* in, uint8_t* out, size_t num_bytes);
+
+
+/*
+ * Purpose : Encrypts/decrypts consecutive sectors. Sectors are independent, so
+ *           large buffers are split across worker threads (see aes_workers.h).
+ * Inputs  : XTS context, number of the first sector, input, output location
+ *           (may equal in), length in bytes, sector size in bytes (at least
+ *           16). The last sector may be shorter but must be at least 16 bytes.
+ * Outputs : termination_code 0 on success
+ */
+aes_out aes_xts_encrypt_sectors(const aes_xts_ctx* xts, uint64_t first_sector, const uint8_t* in, uint8_t* out,
+		size_t num_bytes, size_t sector_size);
+
+aes_out aes_xts_decrypt_sectors(const aes_xts_ctx* xts, uint64_t first_sector, const uint8_t* in, uint8_t* out,
+		size_t num_bytes, size_t sector_size);
+
+
+/*
+ * Purpose : Encrypts or decrypts a disk image file in place, sector by sector.
+ *           Sector 0 is at the start of the file.
+ * Inputs  : Image file path, XTS context, sector size, encrypt or decrypt
+ * Outputs : termination_code 0 on success, 12 if the file cannot be read or
+ *           written. A file that ends in a partial sector of at least 16 bytes
+ *           is handled with ciphertext stealing.
+ */
+aes_out aes_xts_crypt_file(const char* path, const aes_xts_ctx* xts, size_t sector_size, aes_op_flag direction);
+
+
+// Wipes both key schedules
+void aes_xts_destroy(aes_xts_ctx* xts);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AES_XTS_H_ */
@@ -0,0 +1,486 @@
+/*
+ ============================================================================
+ Name        : bitslice.c
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : Constant-time bitsliced AES engine. Four blocks are spread over
+               eight 64-bit words ("planes"): plane j holds bit j of all 64
+               bytes. Two such sets are processed together, giving 8 blocks per
+               call. SubBytes is the Boyar-Peralta S-box circuit (AND/XOR/NOT
+               only), and ShiftRows/MixColumns become rotates, shifts and XORs
+               of whole planes.
+ Note 1      : Inside a plane, byte i of block b sits at bit (4 * i) + b. Byte i
+               is row (i % 4) of column (i / 4), so each column fills a 16-bit
+               lane and each row is one nibble of that lane.
+ Note 2      : There are no lookups indexed by data and no data-dependent
+               branches, so run time does not depend on the key or the data.
+ ============================================================================
+ */
+
+#include "bitslice.h"
+
+#ifdef AES_BITSLICE
+
+#define PLANES  8
+
+
+/*---------------- PACKING -------------------*/
+
+// Transposes the 8x8 bit matrix held in x (byte k = row k)
+static inline uint64_t transpose_8x8_bits(uint64_t x){
+	uint64_t t;
+	t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+	x ^= t ^ (t << 7);
+	t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+	x ^= t ^ (t << 14);
+	t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+	x ^= t ^ (t << 28);
+	return x;
+}
+
+// Swaps the bit groups selected by mask in b with the groups shift bits higher in a
+static inline void swap_move(uint64_t* a, uint64_t* b, uint64_t mask, uint8_t shift){
+	uint64_t t = ((*a >> shift) ^ *b) & mask;
+	*b ^= t;
+	*a ^= t << shift;
+}
+
+// Transposes the 8x8 byte matrix held in w (byte j of word g <-> byte g of word j)
+static void transpose_8x8_bytes(uint64_t* w){
+	for(uint8_t g = 0; g < 4; g++){
+		swap_move(&w[g], &w[g + 4], 0x00000000FFFFFFFFULL, 32);
+	}
+	for(uint8_t g = 0; g < 8; g += 4){
+		swap_move(&w[g], &w[g + 2], 0x0000FFFF0000FFFFULL, 16);
+		swap_move(&w[g + 1], &w[g + 3], 0x0000FFFF0000FFFFULL, 16);
+	}
+	for(uint8_t g = 0; g < 8; g += 2){
+		swap_move(&w[g], &w[g + 1], 0x00FF00FF00FF00FFULL, 8);
+	}
+}
+
+
+// Converts four 16-byte blocks into bit planes (see Note 1)
+static void pack_planes(uint64_t* q, const uint8_t* b0, const uint8_t* b1, const uint8_t* b2, const uint8_t* b3){
+
+	// Word g holds bytes 2g and 2g + 1 of each block, i.e. plane bits 8g to 8g + 7
+	for(uint8_t g = 0; g < PLANES; g++){
+		uint8_t i = 2 * g;
+		q[g] = (uint64_t) b0[i] | ((uint64_t) b1[i] << 8) | ((uint64_t) b2[i] << 16) | ((uint64_t) b3[i] << 24) |
+		       ((uint64_t) b0[i + 1] << 32) | ((uint64_t) b1[i + 1] << 40) |
+		       ((uint64_t) b2[i + 1] << 48) | ((uint64_t) b3[i + 1] << 56);
+		q[g] = transpose_8x8_bits(q[g]);
+	}
+
+	transpose_8x8_bytes(q);
+}
+
+
+static void unpack_planes(uint64_t* q, uint8_t* b0, uint8_t* b1, uint8_t* b2, uint8_t* b3){
+
+	transpose_8x8_bytes(q);
+
+	for(uint8_t g = 0; g < PLANES; g++){
+		uint64_t w = transpose_8x8_bits(q[g]);
+		uint8_t i = 2 * g;
+		b0[i] = (uint8_t) w;
+		b1[i] = (uint8_t) (w >> 8);
+		b2[i] = (uint8_t) (w >> 16);
+		b3[i] = (uint8_t) (w >> 24);
+		b0[i + 1] = (uint8_t) (w >> 32);
+		b1[i + 1] = (uint8_t) (w >> 40);
+		b2[i + 1] = (uint8_t) (w >> 48);
+		b3[i + 1] = (uint8_t) (w >> 56);
+	}
+}
+
+
+/*---------------- ROUND TRANSFORMS -------------------*/
+
+// Boyar-Peralta circuit for the AES s-box (113 gates). q[7] is the most significant bit.
+static void sub_bytes_planes(uint64_t* q){
+
+	uint64_t x0, x1, x2, x3, x4, x5, x6, x7;
+	uint64_t y1, y2, y3, y4, y5, y6, y7, y8, y9, y10, y11, y12, y13, y14, y15, y16, y17, y18, y19, y20, y21;
+	uint64_t z0, z1, z2, z3, z4, z5, z6, z7, z8, z9, z10, z11, z12, z13, z14, z15, z16, z17;
+	uint64_t t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13, t14, t15, t16, t17, t18, t19;
+	uint64_t t20, t21, t22, t23, t24, t25, t26, t27, t28, t29, t30, t31, t32, t33, t34, t35, t36, t37, t38, t39;
+	uint64_t t40, t41, t42, t43, t44, t45, t46, t47, t48, t49, t50, t51, t52, t53, t54, t55, t56, t57, t58, t59;
+	uint64_t t60, t61, t62, t63, t64, t65, t66, t67;
+	uint64_t s0, s1, s2, s3, s4, s5, s6, s7;
+
+	x0 = q[7]; x1 = q[6]; x2 = q[5]; x3 = q[4];
+	x4 = q[3]; x5 = q[2]; x6 = q[1]; x7 = q[0];
+
+	// Top linear transformation
+	y14 = x3 ^ x5;
+	y13 = x0 ^ x6;
+	y9 = x0 ^ x3;
+	y8 = x0 ^ x5;
+	t0 = x1 ^ x2;
+	y1 = t0 ^ x7;
+	y4 = y1 ^ x3;
+	y12 = y13 ^ y14;
+	y2 = y1 ^ x0;
+	y5 = y1 ^ x6;
+	y3 = y5 ^ y8;
+	t1 = x4 ^ y12;
+	y15 = t1 ^ x5;
+	y20 = t1 ^ x1;
+	y6 = y15 ^ x7;
+	y10 = y15 ^ t0;
+	y11 = y20 ^ y9;
+	y7 = x7 ^ y11;
+	y17 = y10 ^ y11;
+	y19 = y10 ^ y8;
+	y16 = t0 ^ y11;
+	y21 = y13 ^ y16;
+	y18 = x0 ^ y16;
+
+	// Non-linear section (inversion in GF(2^8))
+	t2 = y12 & y15;
+	t3 = y3 & y6;
+	t4 = t3 ^ t2;
+	t5 = y4 & x7;
+	t6 = t5 ^ t2;
+	t7 = y13 & y16;
+	t8 = y5 & y1;
+	t9 = t8 ^ t7;
+	t10 = y2 & y7;
+	t11 = t10 ^ t7;
+	t12 = y9 & y11;
+	t13 = y14 & y17;
+	t14 = t13 ^ t12;
+	t15 = y8 & y10;
+	t16 = t15 ^ t12;
+	t17 = t4 ^ t14;
+	t18 = t6 ^ t16;
+	t19 = t9 ^ t14;
+	t20 = t11 ^ t16;
+	t21 = t17 ^ y20;
+	t22 = t18 ^ y19;
+	t23 = t19 ^ y21;
+	t24 = t20 ^ y18;
+
+	t25 = t21 ^ t22;
+	t26 = t21 & t23;
+	t27 = t24 ^ t26;
+	t28 = t25 & t27;
+	t29 = t28 ^ t22;
+	t30 = t23 ^ t24;
+	t31 = t22 ^ t26;
+	t32 = t31 & t30;
+	t33 = t32 ^ t24;
+	t34 = t23 ^ t33;
+	t35 = t27 ^ t33;
+	t36 = t24 & t35;
+	t37 = t36 ^ t34;
+	t38 = t27 ^ t36;
+	t39 = t29 & t38;
+	t40 = t25 ^ t39;
+
+	t41 = t40 ^ t37;
+	t42 = t29 ^ t33;
+	t43 = t29 ^ t40;
+	t44 = t33 ^ t37;
+	t45 = t42 ^ t41;
+	z0 = t44 & y15;
+	z1 = t37 & y6;
+	z2 = t33 & x7;
+	z3 = t43 & y16;
+	z4 = t40 & y1;
+	z5 = t29 & y7;
+	z6 = t42 & y11;
+	z7 = t45 & y17;
+	z8 = t41 & y10;
+	z9 = t44 & y12;
+	z10 = t37 & y3;
+	z11 = t33 & y4;
+	z12 = t43 & y13;
+	z13 = t40 & y5;
+	z14 = t29 & y2;
+	z15 = t42 & y9;
+	z16 = t45 & y14;
+	z17 = t41 & y8;
+
+	// Bottom linear transformation (includes the affine transform)
+	t46 = z15 ^ z16;
+	t47 = z10 ^ z11;
+	t48 = z5 ^ z13;
+	t49 = z9 ^ z10;
+	t50 = z2 ^ z12;
+	t51 = z2 ^ z5;
+	t52 = z7 ^ z8;
+	t53 = z0 ^ z3;
+	t54 = z6 ^ z7;
+	t55 = z16 ^ z17;
+	t56 = z12 ^ t48;
+	t57 = t50 ^ t53;
+	t58 = z4 ^ t46;
+	t59 = z3 ^ t54;
+	t60 = t46 ^ t57;
+	t61 = z14 ^ t57;
+	t62 = t52 ^ t58;
+	t63 = t49 ^ t58;
+	t64 = z4 ^ t59;
+	t65 = t61 ^ t62;
+	t66 = z1 ^ t63;
+	s0 = t59 ^ t63;
+	s6 = t56 ^ ~t62;
+	s7 = t48 ^ ~t60;
+	t67 = t64 ^ t65;
+	s3 = t53 ^ t66;
+	s4 = t51 ^ t66;
+	s5 = t47 ^ t65;
+	s1 = t64 ^ ~s3;
+	s2 = t55 ^ ~t67;
+
+	q[7] = s0; q[6] = s1; q[5] = s2; q[4] = s3;
+	q[3] = s4; q[2] = s5; q[1] = s6; q[0] = s7;
+}
+
+
+// Inverse of the s-box affine transform (applied twice around the forward circuit)
+static void inv_affine_planes(uint64_t* q){
+
+	uint64_t q0 = ~q[0], q1 = ~q[1], q2 = q[2], q3 = q[3];
+	uint64_t q4 = q[4], q5 = ~q[5], q6 = ~q[6], q7 = q[7];
+
+	q[7] = q1 ^ q4 ^ q6;
+	q[6] = q0 ^ q3 ^ q5;
+	q[5] = q7 ^ q2 ^ q4;
+	q[4] = q6 ^ q1 ^ q3;
+	q[3] = q5 ^ q0 ^ q2;
+	q[2] = q4 ^ q7 ^ q1;
+	q[1] = q3 ^ q6 ^ q0;
+	q[0] = q2 ^ q5 ^ q7;
+}
+
+
+// inv_sbox(x) = A^-1(sbox(A^-1(x))), since sbox(x) = A(x^-1) and inversion is its own inverse
+static void inv_sub_bytes_planes(uint64_t* q){
+	inv_affine_planes(q);
+	sub_bytes_planes(q);
+	inv_affine_planes(q);
+}
+
+
+static inline uint64_t rot_r64(uint64_t x, uint8_t n){
+	return (x >> n) | (x << (64 - n));
+}
+
+// Row r of every column is rotated left by r columns (16 bits per column)
+static void shift_rows_planes(uint64_t* q){
+	for(uint8_t j = 0; j < PLANES; j++){
+		uint64_t x = q[j];
+		q[j] = (x & 0x000F000F000F000FULL) |
+		       (rot_r64(x, 16) & 0x00F000F000F000F0ULL) |
+		       (rot_r64(x, 32) & 0x0F000F000F000F00ULL) |
+		       (rot_r64(x, 48) & 0xF000F000F000F000ULL);
+	}
+}
+
+static void inv_shift_rows_planes(uint64_t* q){
+	for(uint8_t j = 0; j < PLANES; j++){
+		uint64_t x = q[j];
+		q[j] = (x & 0x000F000F000F000FULL) |
+		       (rot_r64(x, 48) & 0x00F000F000F000F0ULL) |
+		       (rot_r64(x, 32) & 0x0F000F000F000F00ULL) |
+		       (rot_r64(x, 16) & 0xF000F000F000F000ULL);
+	}
+}
+
+
+// Moves row r + 1 (or r + 2) of each column into row r
+static inline uint64_t rot_rows_1(uint64_t x){
+	return ((x >> 4) & 0x0FFF0FFF0FFF0FFFULL) | ((x << 12) & 0xF000F000F000F000ULL);
+}
+
+static inline uint64_t rot_rows_2(uint64_t x){
+	return ((x >> 8) & 0x00FF00FF00FF00FFULL) | ((x << 8) & 0xFF00FF00FF00FF00ULL);
+}
+
+// Multiplication by {02} across all planes (reduction by x^8 + x^4 + x^3 + x + 1)
+static inline void xtime_planes(const uint64_t* in, uint64_t* out){
+	uint64_t hi = in[7];
+	out[7] = in[6];
+	out[6] = in[5];
+	out[5] = in[4];
+	out[4] = in[3] ^ hi;
+	out[3] = in[2] ^ hi;
+	out[2] = in[1];
+	out[1] = in[0] ^ hi;
+	out[0] = hi;
+}
+
+
+// r_i = {02}a_i + {03}a_(i+1) + a_(i+2) + a_(i+3)
+//     = {02}(a_i + a_(i+1)) + a_(i+1) + (a_(i+2) + a_(i+3))
+static void mix_columns_planes(uint64_t* q){
+
+	uint64_t r1[PLANES], t[PLANES], t2[PLANES];
+
+	for(uint8_t j = 0; j < PLANES; j++){
+		r1[j] = rot_rows_1(q[j]);
+		t[j] = q[j] ^ r1[j];
+	}
+
+	xtime_planes(t, t2);
+
+	for(uint8_t j = 0; j < PLANES; j++){
+		q[j] = t2[j] ^ r1[j] ^ rot_rows_2(t[j]);
+	}
+}
+
+
+// InvMixColumns = MixColumns after multiplying each column by ({04}x^2 + {05}),
+// i.e. u_i = a_i + {04}(a_i + a_(i+2))
+static void inv_mix_columns_planes(uint64_t* q){
+
+	uint64_t t[PLANES], t2[PLANES];
+
+	for(uint8_t j = 0; j < PLANES; j++){
+		t[j] = q[j] ^ rot_rows_2(q[j]);
+	}
+
+	xtime_planes(t, t2);
+	xtime_planes(t2, t);
+
+	for(uint8_t j = 0; j < PLANES; j++){
+		q[j] ^= t[j];
+	}
+
+	mix_columns_planes(q);
+}
+
+
+static inline void add_round_key_planes(uint64_t* q, const uint64_t* bs_key){
+	for(uint8_t j = 0; j < PLANES; j++){
+		q[j] ^= bs_key[j];
+	}
+}
+
+
+/*---------------- ENGINE FUNCTIONS -------------------*/
+
+void bitslice_setup_keys(aes_ctx* ctx){
+
+	// Every round key is packed as if it were four copies of the same block
+	for(uint8_t round = 0; round <= ctx->Nr; round++){
+		const uint8_t* rk = &ctx->round_keys[round * BYTES_IN_STATE];
+		pack_planes(&ctx->bs_round_keys[round * PLANES], rk, rk, rk, rk);
+	}
+}
+
+
+// Runs the cipher on 8 blocks held as two sets of planes
+static void encrypt_8(const aes_ctx* ctx, uint64_t* qa, uint64_t* qb){
+
+	const uint64_t* bs_keys = ctx->bs_round_keys;
+
+	add_round_key_planes(qa, bs_keys);
+	add_round_key_planes(qb, bs_keys);
+
+	for(uint8_t round = 1; round < ctx->Nr; round++){
+		sub_bytes_planes(qa);
+		sub_bytes_planes(qb);
+		shift_rows_planes(qa);
+		shift_rows_planes(qb);
+		mix_columns_planes(qa);
+		mix_columns_planes(qb);
+		add_round_key_planes(qa, &bs_keys[round * PLANES]);
+		add_round_key_planes(qb, &bs_keys[round * PLANES]);
+	}
+
+	sub_bytes_planes(qa);
+	sub_bytes_planes(qb);
+	shift_rows_planes(qa);
+	shift_rows_planes(qb);
+	add_round_key_planes(qa, &bs_keys[ctx->Nr * PLANES]);
+	add_round_key_planes(qb, &bs_keys[ctx->Nr * PLANES]);
+}
+
+
+// Direct inverse cipher, using the encryption round keys in reverse order
+static void decrypt_8(const aes_ctx* ctx, uint64_t* qa, uint64_t* qb){
+
+	const uint64_t* bs_keys = ctx->bs_round_keys;
+
+	add_round_key_planes(qa, &bs_keys[ctx->Nr * PLANES]);
+	add_round_key_planes(qb, &bs_keys[ctx->Nr * PLANES]);
+
+	for(uint8_t round = ctx->Nr - 1; round > 0; round--){
+		inv_shift_rows_planes(qa);
+		inv_shift_rows_planes(qb);
+		inv_sub_bytes_planes(qa);
+		inv_sub_bytes_planes(qb);
+		add_round_key_planes(qa, &bs_keys[round * PLANES]);
+		add_round_key_planes(qb, &bs_keys[round * PLANES]);
+		inv_mix_columns_planes(qa);
+		inv_mix_columns_planes(qb);
+	}
+
+	inv_shift_rows_planes(qa);
+	inv_shift_rows_planes(qb);
+	inv_sub_bytes_planes(qa);
+	inv_sub_bytes_planes(qb);
+	add_round_key_planes(qa, bs_keys);
+	add_round_key_planes(qb, bs_keys);
+}
+
+
+static void run_blocks(const aes_ctx* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks,
+		void (*cipher_8)(const aes_ctx*, uint64_t*, uint64_t*)){
+
+	uint64_t qa[PLANES], qb[PLANES];
+	uint8_t partial[BITSLICE_BLOCKS * BYTES_IN_STATE];
+
+	while(num_blocks > 0){
+
+		size_t group_blocks = (num_blocks < BITSLICE_BLOCKS) ? num_blocks : BITSLICE_BLOCKS;
+		const uint8_t* src = in;
+		uint8_t* dst = out;
+
+		// A short final group is run through a zero-padded copy
+		if(group_blocks < BITSLICE_BLOCKS){
+			memset(partial, 0, sizeof(partial));
+			memcpy(partial, in, group_blocks * BYTES_IN_STATE);
+			src = partial;
+			dst = partial;
+		}
+
+		pack_planes(qa, &src[0], &src[16], &src[32], &src[48]);
+		pack_planes(qb, &src[64], &src[80], &src[96], &src[112]);
+
+		cipher_8(ctx, qa, qb);
+
+		unpack_planes(qa, &dst[0], &dst[16], &dst[32], &dst[48]);
+		unpack_planes(qb, &dst[64], &dst[80], &dst[96], &dst[112]);
+
+		if(group_blocks < BITSLICE_BLOCKS){
+			memcpy(out, partial, group_blocks * BYTES_IN_STATE);
+			aes_secure_wipe(partial, sizeof(partial));
+		}
+
+		in += group_blocks * BYTES_IN_STATE;
+		out += group_blocks * BYTES_IN_STATE;
+		num_blocks -= group_blocks;
+	}
+
+	aes_secure_wipe(qa, sizeof(qa));
+	aes_secure_wipe(qb, sizeof(qb));
+}
+
+
+void bitslice_encrypt_blocks(const aes_ctx* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks){
+	run_blocks(ctx, in, out, num_blocks, encrypt_8);
+}
+
+
+void bitslice_decrypt_blocks(const aes_ctx* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks){
+	run_blocks(ctx, in, out, num_blocks, decrypt_8);
+}
+
+#endif /* AES_BITSLICE */
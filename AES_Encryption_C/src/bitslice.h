@@ -0,0 +1,50 @@
+/*
+ ============================================================================
+ Name        : bitslice.h
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : Constant-time bitsliced AES engine. Runs 8 blocks per call
+               using only 64-bit integer operations, with no table lookups and
+               no branches on secret data.
+ ============================================================================
+ */
+
+#ifndef BITSLICE_H_
+#define BITSLICE_H_
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+#include <stdint.h>
+#include "aes_encryption.h"
+
+#ifdef AES_BITSLICE
+
+#define BITSLICE_BLOCKS  8
+
+// Builds ctx->bs_round_keys from ctx->round_keys
+void bitslice_setup_keys(aes_ctx* ctx);
+
+/*
+ * Purpose : Encrypts/decrypts consecutive 16-byte blocks, 8 at a time. A
+ *           final group of fewer than 8 blocks is padded internally, so it
+ *           costs the same as a full group.
+ * Inputs  : Initialized context, input blocks, output location, block count
+ * Outputs : Result written to out (out may equal in)
+ */
+void bitslice_encrypt_blocks(const aes_ctx* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks);
+
+void bitslice_decrypt_blocks(const aes_ctx* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks);
+
+#endif /* AES_BITSLICE */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BITSLICE_H_ */
@@ -14,168 +14,215 @@
                input dataset). If this module were used to encrypt GB of data then
                copying the whole input dataset would make the module significantly
                slower.
+ Note 2      : The round steps themselves work on four 32-bit column words (see
+               cipher_utils.h). A column is 4 consecutive bytes, so packing is
+               one load per column, and ShiftRows becomes masks on the words.
+               The byte-state functions below wrap the word forms.
+ Note 3      : The engine table (aes_engines) lives here as well. Every engine
+               runs blocks through the same interface, so aes_ctx can switch
+               between the reference code below and faster implementations.
  ============================================================================
  */
 
 #include "cipher_utils.h"
+#include "gf256.h"
+#include "t_tables.h"
+#include "aes_ni.h"
+#include "bitslice.h"
+#include "vperm.h"
+#include "aes_otf.h"
+
+
+static bool always_supported(void);
+static void reference_encrypt_blocks(const aes_ctx* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks);
+static void reference_decrypt_blocks(const aes_ctx* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks);
+
+
+// Indexed by aes_engine_id. Engines left out of the build keep only their name.
+const aes_engine aes_engines[NUM_AES_ENGINES] = {
+	[engine_reference] = {
+		.name = "reference",
+		.is_supported = always_supported,
+		.encrypt_blocks = reference_encrypt_blocks,
+		.decrypt_blocks = reference_decrypt_blocks
+	},
+#ifndef AES_SMALL_FOOTPRINT
+	[engine_t_table] = {
+		.name = "t-table",
+		.is_supported = always_supported,
+		.encrypt_blocks = t_table_encrypt_blocks,
+		.decrypt_blocks = t_table_decrypt_blocks
+	},
+#else
+	[engine_t_table] = {.name = "t-table"},
+#endif
+#ifdef AES_BITSLICE
+	[engine_bitslice] = {
+		.name = "bitslice",
+		.is_supported = always_supported,
+		.encrypt_blocks = bitslice_encrypt_blocks,
+		.decrypt_blocks = bitslice_decrypt_blocks,
+		.setup_keys = bitslice_setup_keys
+	},
+#else
+	[engine_bitslice] = {.name = "bitslice"},
+#endif
+#ifdef AES_X86_ACCEL
+	[engine_aes_ni] = {
+		.name = "aes-ni",
+		.is_supported = aes_ni_supported,
+		.encrypt_blocks = aes_ni_encrypt_blocks,
+		.decrypt_blocks = aes_ni_decrypt_blocks,
+		.expand_keys = aes_ni_expand_keys,
+		.expand_dec_keys = aes_ni_expand_dec_keys
+	},
+	[engine_vperm] = {
+		.name = "vperm",
+		.is_supported = vperm_supported,
+		.encrypt_blocks = vperm_encrypt_blocks,
+		.decrypt_blocks = vperm_decrypt_blocks
+	},
+#else
+	[engine_aes_ni] = {.name = "aes-ni"},
+	[engine_vperm] = {.name = "vperm"},
+#endif
+};
 
 
+const aes_engine* get_aes_engine(aes_engine_id engine_id){
 
-// Translate 2D state matrix row/col to index of flat 16-bit array
-uint8_t get_idx_rc[ROWS_IN_STATE][COLS_IN_STATE] = {
-	{0, 4, 8, 12},
-	{1, 5, 9, 13},
-	{2, 6, 10, 14},
-	{3, 7, 11, 15}
-};
-
-void add_round_key(uint8_t* state, uint8_t* round_key, uint8_t* round_num, aes_op_flag aes_op){
-	for(uint8_t i = 0; i < BYTES_IN_STATE; i++){
-		state[i] ^= round_key[(BYTES_IN_STATE * (*round_num)) + i];
+	if(engine_id >= NUM_AES_ENGINES){
+		return NULL;
 	}
 
-	if (aes_op == encrypt){
-		(*round_num)++; // '0' for encryption
-	}
-	else if (aes_op == decrypt){
-		(*round_num)--; // '1' for decryption
-	}
-}
+	const aes_engine* engine = &aes_engines[engine_id];
 
+	if(engine->is_supported == NULL || !engine->is_supported()){
+		return NULL;
+	}
 
-void shift_rows(uint8_t* state){
-	// Row 0 is untouched.
+	return engine;
+}
 
-	// Shift elements in row 1 one spot to the left
-	uint8_t temp_byte = state[get_idx_rc[1][0]];
 
-	state[get_idx_rc[1][0]] = state[get_idx_rc[1][1]];
-	state[get_idx_rc[1][1]] = state[get_idx_rc[1][2]];
-	state[get_idx_rc[1][2]] = state[get_idx_rc[1][3]];
-	state[get_idx_rc[1][3]] = temp_byte;
+const aes_engine* get_default_aes_engine(void){
 
+	// Most preferred first. vperm is slower than the T-tables but has no
+	// secret-dependent memory accesses, so it only goes ahead of them in
+	// AES_CONSTANT_TIME builds. Otherwise it is used when the T-tables are
+	// left out (AES_SMALL_FOOTPRINT).
+#ifdef AES_CONSTANT_TIME
+	const aes_engine_id preference[] = {engine_aes_ni, engine_vperm, engine_bitslice, engine_reference};
+#else
+	const aes_engine_id preference[] = {engine_aes_ni, engine_t_table, engine_vperm, engine_reference};
+#endif
 
-	// Shift elements in row 2 two spots to the left
-	temp_byte = state[get_idx_rc[2][0]];
+	// Not cached, so there is no shared state to race on from the worker pool.
+	// The CPUID checks behind is_supported() are cached in cpu_features.c.
+	for(uint8_t i = 0; i < sizeof(preference) / sizeof(preference[0]); i++){
+		const aes_engine* engine = get_aes_engine(preference[i]);
 
-	uint8_t temp_byte2 = state[get_idx_rc[2][1]];
+		if(engine != NULL){
+			return engine;
+		}
+	}
 
-	state[get_idx_rc[2][0]] = state[get_idx_rc[2][2]];
-	state[get_idx_rc[2][1]] = state[get_idx_rc[2][3]];
-	state[get_idx_rc[2][2]] = temp_byte;
-	state[get_idx_rc[2][3]] = temp_byte2;
+	return NULL;
+}
 
-	// Shift elements in row 3 one spot to the right (eq. 3 spots to the left)
-	temp_byte = state[get_idx_rc[3][3]];
-	state[get_idx_rc[3][3]] = state[get_idx_rc[3][2]];
-	state[get_idx_rc[3][2]] = state[get_idx_rc[3][1]];
-	state[get_idx_rc[3][1]] = state[get_idx_rc[3][0]];
-	state[get_idx_rc[3][0]] = temp_byte;
 
+static bool always_supported(void){
+	return true;
 }
 
 
-void mix_col_words(uint8_t* state){
+static void reference_encrypt_blocks(const aes_ctx* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks){
 
-	uint8_t r0, r1, r2, r3;
+	for(size_t block = 0; block < num_blocks; block++){
+		if(out != in){
+			memcpy(out, in, BYTES_IN_STATE);
+		}
+#ifndef AES_OTF_KEYS
+		ctx->encrypt_block(out, ctx->round_keys);
+#else
+		encrypt_16_bytes_otf(out, ctx->key_words, ctx->Nk, ctx->Nr);
+#endif
+
+		in += BYTES_IN_STATE;
+		out += BYTES_IN_STATE;
+	}
+}
 
-	for(uint8_t col = 0; col < COLS_IN_STATE; col++){
 
-		r0 = state[get_idx_rc[0][col]];
-		r1 = state[get_idx_rc[1][col]];
-		r2 = state[get_idx_rc[2][col]];
-		r3 = state[get_idx_rc[3][col]];
+static void reference_decrypt_blocks(const aes_ctx* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks){
 
-		// All equations shown in comments are finite fields operations
-		// r0 = ({02} * r0) + ({03} * r1) + r2 + r3
-		state[get_idx_rc[0][col]] = mult_by_x(r0, 1) ^ (r1 ^ mult_by_x(r1, 1)) ^ r2 ^ r3;
+	for(size_t block = 0; block < num_blocks; block++){
+		if(out != in){
+			memcpy(out, in, BYTES_IN_STATE);
+		}
+#ifndef AES_OTF_KEYS
+		ctx->decrypt_block(out, ctx->dec_round_keys);
+#else
+		decrypt_16_bytes_otf(out, ctx->last_key_words, ctx->Nk, ctx->Nr);
+#endif
+
+		in += BYTES_IN_STATE;
+		out += BYTES_IN_STATE;
+	}
+}
 
-		// r1 = r0 + ({02} * r1) + ({03} * r2) + r3
-		state[get_idx_rc[1][col]] = r0 ^ mult_by_x(r1, 1) ^ (r2 ^ mult_by_x(r2, 1)) ^ r3;
 
-		// r2 = r0 + r1 + ({02} * r2) + ({03} * r3)
-		state[get_idx_rc[2][col]] = r0 ^ r1 ^ mult_by_x(r2, 1) ^ (r3 ^ mult_by_x(r3, 1));
 
-		// r3 = ({03} * r0) + r1 + r2 + ({02} * r3)
-		state[get_idx_rc[3][col]] = (r0 ^ mult_by_x(r0, 1)) ^ r1 ^ r2 ^ mult_by_x(r3, 1);
+void add_round_key(uint8_t* state, const uint8_t* round_key, uint8_t* round_num, aes_op_flag aes_op){
+	for(uint8_t i = 0; i < BYTES_IN_STATE; i++){
+		state[i] ^= round_key[(BYTES_IN_STATE * (*round_num)) + i];
 	}
 
+	if (aes_op == encrypt){
+		(*round_num)++; // '0' for encryption
+	}
+	else if (aes_op == decrypt){
+		(*round_num)--; // '1' for decryption
+	}
 }
 
 
-void inv_shift_rows(uint8_t* state){
-	// Row 0 is not to be modified.
-
-	// Shift elements in row 1 one spot to the right
-	uint8_t temp_byte = state[get_idx_rc[1][3]];
-
-	state[get_idx_rc[1][3]] = state[get_idx_rc[1][2]];
-	state[get_idx_rc[1][2]] = state[get_idx_rc[1][1]];
-	state[get_idx_rc[1][1]] = state[get_idx_rc[1][0]];
-	state[get_idx_rc[1][0]] = temp_byte;
+void shift_rows(uint8_t* state){
+	uint32_t state_words[COLS_IN_STATE];
+	load_state_words(state_words, state);
+	shift_rows_words(state_words);
+	store_state_words(state, state_words);
+}
 
-	// Shift elements in row 2 two spots to the right
-	temp_byte = state[get_idx_rc[2][2]];
 
-	uint8_t temp_byte2 = state[get_idx_rc[2][3]];
+void mix_col_words(uint8_t* state){
+	uint32_t state_words[COLS_IN_STATE];
+	load_state_words(state_words, state);
+	mix_columns_words(state_words);
+	store_state_words(state, state_words);
+}
 
-	state[get_idx_rc[2][3]] = state[get_idx_rc[2][1]];
-	state[get_idx_rc[2][2]] = state[get_idx_rc[2][0]];
-	state[get_idx_rc[2][0]] = temp_byte;
-	state[get_idx_rc[2][1]] = temp_byte2;
 
-	// Shift elements in row 3 one spot to the left (eq. 3 to the right)
-	temp_byte = state[get_idx_rc[3][0]];
-	state[get_idx_rc[3][0]] = state[get_idx_rc[3][1]];
-	state[get_idx_rc[3][1]] = state[get_idx_rc[3][2]];
-	state[get_idx_rc[3][2]] = state[get_idx_rc[3][3]];
-	state[get_idx_rc[3][3]] = temp_byte;
+void inv_shift_rows(uint8_t* state){
+	uint32_t state_words[COLS_IN_STATE];
+	load_state_words(state_words, state);
+	inv_shift_rows_words(state_words);
+	store_state_words(state, state_words);
 }
 
 
 void inv_mix_col_words(uint8_t* state){
-
-	uint8_t r0, r1, r2, r3;
-
-	// Like with shift_rows, the state matrix is conceptualized as a 4x4 2D matrix
-	for(uint8_t col = 0; col < COLS_IN_STATE; col++){
-
-		r0 = state[get_idx_rc[0][col]];
-		r1 = state[get_idx_rc[1][col]];
-		r2 = state[get_idx_rc[2][col]];
-		r3 = state[get_idx_rc[3][col]];
-
-		// All equations shown in comments are finite fields operations
-		// r0 = ({0e} * r0) + ({0b} * r1) + ({0d} * r2) + ({09} * r3)
-		state[get_idx_rc[0][col]] = mult_by_x_expansion(0x0e, r0) ^ mult_by_x_expansion(0x0b, r1) ^
-				           mult_by_x_expansion(0x0d, r2) ^ mult_by_x_expansion(0x09, r3);
-
-		// r1 = ({09} * r0) + ({0e} * r1) + ({0b} * r2) + ({0d} * r3)
-		state[get_idx_rc[1][col]] = mult_by_x_expansion(0x09, r0) ^ mult_by_x_expansion(0x0e, r1) ^
-				               mult_by_x_expansion(0x0b, r2) ^ mult_by_x_expansion(0x0d, r3);
-
-		// r2 = ({0d} * r0) + ({09} * r1) + ({0e} * r2) + ({0b} * r3)
-		state[get_idx_rc[2][col]] = mult_by_x_expansion(0x0d, r0) ^ mult_by_x_expansion(0x09, r1) ^
-	               	           mult_by_x_expansion(0x0e, r2) ^ mult_by_x_expansion(0x0b, r3);
-
-		// r3 = ({0b} * r0) + ({0d} * r1) + ({09} * r2) + ({0e} * r3)
-		state[get_idx_rc[3][col]] = mult_by_x_expansion(0x0b, r0) ^ mult_by_x_expansion(0x0d, r1) ^
-    	           	   	       mult_by_x_expansion(0x09, r2) ^ mult_by_x_expansion(0x0e, r3);
-	}
-
+	uint32_t state_words[COLS_IN_STATE];
+	load_state_words(state_words, state);
+	inv_mix_columns_words(state_words);
+	store_state_words(state, state_words);
 }
 
 
 uint8_t mult_by_x(uint8_t byte, uint8_t num_multiplications){
 
-	// Check if the 7th bit is a one. If yes then reduce the polynomial
 	for(uint8_t i = 1; i <= num_multiplications; i++){
-		// Need to check if 8th bit of input byte is 1. If yes, xor.
-		if(byte > 127){
-			byte <<= 1;
-			byte ^= 0x1b;
-		}
-		else byte <<= 1;
+		byte = gf_xtime(byte);
 	}
 
 	return byte;
@@ -184,24 +231,15 @@ uint8_t mult_by_x(uint8_t byte, uint8_t num_multiplications){
 
 uint8_t mult_by_x_expansion(uint8_t expansion_hex, uint8_t byte){
 
-	uint8_t out;
 	// inv_mix_col_words only has four expansions: {09}, {0b}, {0d}, and {0e}
-	if(expansion_hex == 0x09){
-		// ({08} + {01}) * byte
-		out = mult_by_x(byte, 3) ^ byte;
-	}
-	else if(expansion_hex == 0x0b){
-		// ({08} + {02} + {01}) * byte
-		out = mult_by_x(byte, 3) ^ mult_by_x(byte, 1) ^ byte;
+	switch(expansion_hex){
+		case 0x09:
+			return gf_mul9(byte);
+		case 0x0b:
+			return gf_mul11(byte);
+		case 0x0d:
+			return gf_mul13(byte);
+		default:
+			return gf_mul14(byte);
 	}
-	else if(expansion_hex == 0x0d){
-		// ({08} + {04} + {01}) * byte
-		out = mult_by_x(byte, 3) ^ mult_by_x(byte, 2) ^ byte;
-	}
-	else if(expansion_hex == 0x0e){
-		// ({08} + {04} + {02}) * byte
-		out = mult_by_x(byte, 3) ^ mult_by_x(byte, 2) ^ mult_by_x(byte, 1);
-	}
-
-	return out;
 }
@@ -19,9 +19,150 @@
 
 
 #include "aes_encryption.h"
+#include "s_box.h"
+#include "gf256.h"
+
+// Engine table. Entries for engines left out of the build have NULL functions.
+extern const aes_engine aes_engines[NUM_AES_ENGINES];
+
+// Returns the engine if it is built in and supported by this CPU, otherwise NULL
+const aes_engine* get_aes_engine(aes_engine_id engine_id);
+
+// Returns the fastest engine available
+const aes_engine* get_default_aes_engine(void);
+
+
+// Little-endian loads/stores. Compilers reduce these to single word accesses.
+static inline uint32_t load_le32(const uint8_t* bytes){
+	return (uint32_t) bytes[0] | ((uint32_t) bytes[1] << 8) |
+	       ((uint32_t) bytes[2] << 16) | ((uint32_t) bytes[3] << 24);
+}
+
+static inline void store_le32(uint8_t* bytes, uint32_t word){
+	bytes[0] = (uint8_t) word;
+	bytes[1] = (uint8_t) (word >> 8);
+	bytes[2] = (uint8_t) (word >> 16);
+	bytes[3] = (uint8_t) (word >> 24);
+}
+
+
+// out = a ^ b for num_bytes bytes, 8 bytes at a time. memcpy keeps the word
+// accesses legal for unaligned buffers; compilers turn it into plain loads.
+static inline void xor_bytes(uint8_t* out, const uint8_t* a, const uint8_t* b, size_t num_bytes){
+
+	size_t i = 0;
+
+	for(; i + 8 <= num_bytes; i += 8){
+		uint64_t x, y;
+		memcpy(&x, &a[i], 8);
+		memcpy(&y, &b[i], 8);
+		x ^= y;
+		memcpy(&out[i], &x, 8);
+	}
+
+	for(; i < num_bytes; i++){
+		out[i] = a[i] ^ b[i];
+	}
+}
+
+
+/*
+ * Word-packed state used by the reference engine. The 16 state bytes are held
+ * as four column words, each packed little-endian, so row r of the state is
+ * byte r of every word. Columns are 4 consecutive bytes of the block, so a
+ * column is a single load.
+ */
+static inline void load_state_words(uint32_t* state_words, const uint8_t* state){
+	for(uint8_t col = 0; col < COLS_IN_STATE; col++){
+		state_words[col] = load_le32(&state[col * ROWS_IN_STATE]);
+	}
+}
+
+static inline void store_state_words(uint8_t* state, const uint32_t* state_words){
+	for(uint8_t col = 0; col < COLS_IN_STATE; col++){
+		store_le32(&state[col * ROWS_IN_STATE], state_words[col]);
+	}
+}
+
+static inline void add_round_key_words(uint32_t* state_words, const uint8_t* round_key){
+	for(uint8_t col = 0; col < COLS_IN_STATE; col++){
+		state_words[col] ^= load_le32(&round_key[col * ROWS_IN_STATE]);
+	}
+}
+
+
+// Applies the s-box to each byte of a word
+static inline uint32_t sub_word(uint32_t word){
+	return (uint32_t) s_box[word & 0xff] | ((uint32_t) s_box[(word >> 8) & 0xff] << 8) |
+	       ((uint32_t) s_box[(word >> 16) & 0xff] << 16) | ((uint32_t) s_box[word >> 24] << 24);
+}
+
+static inline uint32_t inv_sub_word(uint32_t word){
+	return (uint32_t) inv_s_box[word & 0xff] | ((uint32_t) inv_s_box[(word >> 8) & 0xff] << 8) |
+	       ((uint32_t) inv_s_box[(word >> 16) & 0xff] << 16) | ((uint32_t) inv_s_box[word >> 24] << 24);
+}
+
+static inline void sub_bytes_words(uint32_t* state_words){
+	for(uint8_t col = 0; col < COLS_IN_STATE; col++){
+		state_words[col] = sub_word(state_words[col]);
+	}
+}
+
+static inline void inv_sub_bytes_words(uint32_t* state_words){
+	for(uint8_t col = 0; col < COLS_IN_STATE; col++){
+		state_words[col] = inv_sub_word(state_words[col]);
+	}
+}
+
+
+// Masks selecting one row from a column word
+#define  ROW_0  0x000000ffU
+#define  ROW_1  0x0000ff00U
+#define  ROW_2  0x00ff0000U
+#define  ROW_3  0xff000000U
+
+// ShiftRows moves row r left by r columns, so new column c takes row r from old
+// column (c + r) mod 4. Rows stay at the same byte, so masks are all it takes.
+static inline void shift_rows_words(uint32_t* state_words){
+	uint32_t c0 = state_words[0], c1 = state_words[1], c2 = state_words[2], c3 = state_words[3];
+
+	state_words[0] = (c0 & ROW_0) | (c1 & ROW_1) | (c2 & ROW_2) | (c3 & ROW_3);
+	state_words[1] = (c1 & ROW_0) | (c2 & ROW_1) | (c3 & ROW_2) | (c0 & ROW_3);
+	state_words[2] = (c2 & ROW_0) | (c3 & ROW_1) | (c0 & ROW_2) | (c1 & ROW_3);
+	state_words[3] = (c3 & ROW_0) | (c0 & ROW_1) | (c1 & ROW_2) | (c2 & ROW_3);
+}
+
+// Row r moves right by r columns: new column c takes row r from old column (c - r) mod 4
+static inline void inv_shift_rows_words(uint32_t* state_words){
+	uint32_t c0 = state_words[0], c1 = state_words[1], c2 = state_words[2], c3 = state_words[3];
+
+	state_words[0] = (c0 & ROW_0) | (c3 & ROW_1) | (c2 & ROW_2) | (c1 & ROW_3);
+	state_words[1] = (c1 & ROW_0) | (c0 & ROW_1) | (c3 & ROW_2) | (c2 & ROW_3);
+	state_words[2] = (c2 & ROW_0) | (c1 & ROW_1) | (c0 & ROW_2) | (c3 & ROW_3);
+	state_words[3] = (c3 & ROW_0) | (c2 & ROW_1) | (c1 & ROW_2) | (c0 & ROW_3);
+}
+
+
+// Once the state is in words, the packed-column forms beat byte table lookups in
+// both directions, and they need no tables, so every build uses them.
+static inline void mix_columns_words(uint32_t* state_words){
+	for(uint8_t col = 0; col < COLS_IN_STATE; col++){
+		state_words[col] = gf_mix_column_word(state_words[col]);
+	}
+}
+
+static inline void inv_mix_columns_words(uint32_t* state_words){
+	for(uint8_t col = 0; col < COLS_IN_STATE; col++){
+		state_words[col] = gf_inv_mix_column_word(state_words[col]);
+	}
+}
+
+
+// Byte-state forms of the round steps, for the key schedule code and other callers of the
+// original interface. Each one packs the state into words, runs the word form and unpacks it.
 
 // XOR's (finite field "add") current round key to the state matrix
-void add_round_key(uint8_t* state, uint8_t* round_key, uint8_t* round_num, aes_op_flag aes_operation);
+void add_round_key(uint8_t* state, const uint8_t* round_key, uint8_t* round_num, aes_op_flag aes_operation);
 
 
 // Shifts rows 2, 3, and 4 of the 2D (4x4) state matrix right
@@ -41,7 +182,7 @@ void inv_mix_col_words(uint8_t* state);
  * Multiplies a finite field polynomial by x. Multiplication of two large order
  * polynomials can be broken into one of the polynomials being multiplied by
  * x many times (with polynomial modulo if order =8). See NIST standard
- * document (FIPS 197) for more details.
+ * document (FIPS 197) for more details. Each step is one gf_xtime() (gf256.h).
  */
 uint8_t mult_by_x(uint8_t byte, uint8_t num_multiplications);
 
@@ -51,7 +192,8 @@ uint8_t mult_by_x(uint8_t byte, uint8_t num_multiplications);
  * polynomial A by another polynomial B where (B % X != 0).
  * {02} represents a multiply by x in finite fields notation.
  * {03} is x + 1, and so on. See the NIST standard (FIPS 197) for more
- * information. This function is needed specifically for use in inv_mix_col_words().
+ * information. Handles the four InvMixColumns constants {09}, {0b}, {0d} and
+ * {0e}. The cipher itself uses the packed-column forms in gf256.h.
  */
 uint8_t mult_by_x_expansion(uint8_t expansion_hex, uint8_t byte);
 
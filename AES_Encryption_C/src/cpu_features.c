@@ -0,0 +1,131 @@
+/*
+ ============================================================================
+ Name        : cpu_features.c
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : Runtime checks for optional x86 instruction set extensions.
+ Note 1      : AVX registers can only be used if the OS saves them on context
+               switches, which is checked with XGETBV in addition to CPUID.
+ Note 2      : CPUID is read once and the answers are cached. It is slow on
+               real hardware and traps to the hypervisor in a VM, and these
+               checks run every time a context or hash key is set up.
+ ============================================================================
+ */
+
+#include "cpu_features.h"
+
+#ifdef AES_X86_ACCEL
+
+#include <cpuid.h>
+
+// CPUID leaf 1 register bits
+#define ECX_SSSE3    (1u << 9)
+#define ECX_PCLMUL   (1u << 1)
+#define ECX_AES      (1u << 25)
+#define ECX_OSXSAVE  (1u << 27)
+#define ECX_AVX      (1u << 28)
+#define EDX_SSE2     (1u << 26)
+
+// CPUID leaf 7 register bits
+#define EBX_AVX2     (1u << 5)
+
+
+// Cached feature bits
+#define HAS_AES_NI   (1u << 0)
+#define HAS_PCLMUL   (1u << 1)
+#define HAS_SSSE3    (1u << 2)
+#define HAS_AVX2     (1u << 3)
+#define HAS_CHECKED  (1u << 31)
+
+
+static bool leaf_1(unsigned int* ecx, unsigned int* edx){
+	unsigned int eax, ebx;
+	return __get_cpuid(1, &eax, &ebx, ecx, edx) != 0;
+}
+
+
+static bool avx2_usable(unsigned int ecx){
+
+	unsigned int eax, ebx, edx;
+
+	if(!(ecx & ECX_AVX) || !(ecx & ECX_OSXSAVE)){
+		return false;
+	}
+
+	// XCR0 bits 1 and 2: the OS saves SSE and AVX state
+	unsigned int xcr0_lo, xcr0_hi;
+	__asm__ volatile("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+	if((xcr0_lo & 0x6) != 0x6){
+		return false;
+	}
+
+	if(__get_cpuid_max(0, NULL) < 7){
+		return false;
+	}
+
+	__cpuid_count(7, 0, eax, ebx, ecx, edx);
+
+	return (ebx & EBX_AVX2) != 0;
+}
+
+
+/*
+ * The cache is read and written atomically, since contexts are set up from
+ * the worker pool. Threads that miss it on the first call each run CPUID and
+ * store the same bits.
+ */
+static unsigned int cpu_features(void){
+
+	static unsigned int features = 0;
+
+	unsigned int cached = __atomic_load_n(&features, __ATOMIC_ACQUIRE);
+	if(cached & HAS_CHECKED){
+		return cached;
+	}
+
+	unsigned int found = HAS_CHECKED;
+	unsigned int ecx, edx;
+
+	if(leaf_1(&ecx, &edx)){
+		if((ecx & ECX_AES) && (edx & EDX_SSE2)){
+			found |= HAS_AES_NI;
+		}
+		if((ecx & ECX_PCLMUL) && (edx & EDX_SSE2)){
+			found |= HAS_PCLMUL;
+		}
+		if(ecx & ECX_SSSE3){
+			found |= HAS_SSSE3;
+		}
+		if(avx2_usable(ecx)){
+			found |= HAS_AVX2;
+		}
+	}
+
+	__atomic_store_n(&features, found, __ATOMIC_RELEASE);
+
+	return found;
+}
+
+
+bool cpu_has_aes_ni(void){
+	return (cpu_features() & HAS_AES_NI) != 0;
+}
+
+
+bool cpu_has_pclmul(void){
+	return (cpu_features() & HAS_PCLMUL) != 0;
+}
+
+
+bool cpu_has_ssse3(void){
+	return (cpu_features() & HAS_SSSE3) != 0;
+}
+
+
+bool cpu_has_avx2(void){
+	return (cpu_features() & HAS_AVX2) != 0;
+}
+
+#endif /* AES_X86_ACCEL */
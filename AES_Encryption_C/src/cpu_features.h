@@ -0,0 +1,41 @@
+/*
+ ============================================================================
+ Name        : cpu_features.h
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : Runtime checks for optional x86 instruction set extensions.
+               Used to decide which AES engines can run on the current CPU.
+ ============================================================================
+ */
+
+#ifndef CPU_FEATURES_H_
+#define CPU_FEATURES_H_
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+#include <stdbool.h>
+#include "aes_encryption.h"
+
+#ifdef AES_X86_ACCEL
+
+bool cpu_has_aes_ni(void);   // AESENC etc. (and SSE2)
+
+bool cpu_has_pclmul(void);   // PCLMULQDQ carry-less multiply
+
+bool cpu_has_ssse3(void);    // PSHUFB
+
+bool cpu_has_avx2(void);     // 256-bit integer vectors, including OS support for saving them
+
+#endif /* AES_X86_ACCEL */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CPU_FEATURES_H_ */
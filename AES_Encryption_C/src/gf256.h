@@ -0,0 +1,142 @@
+/*
+ ============================================================================
+ Name        : gf256.h
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : Arithmetic in GF(2^8), the field AES works in. Multiplication
+               by the MixColumns/InvMixColumns constants, the key schedule
+               round constants, and xtime on four bytes packed in a word.
+ Note 1      : By default the byte multiplications are table lookups. With
+               AES_CONSTANT_TIME they are computed with shifts and masks, so
+               no memory address depends on the data. AES_SMALL_FOOTPRINT
+               (or AES_OTF_KEYS, which implies it) also uses the arithmetic
+               forms and leaves the 1.25 KB of tables out.
+ ============================================================================
+ */
+
+#ifndef GF256_H_
+#define GF256_H_
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+#include <stdint.h>
+
+#define  AES_RCON_LEN  10  // Enough for AES-128, the key length with the most Nk steps
+
+// Key schedule round constants. aes_rcon[i] is used for word (i + 1) * Nk.
+extern const uint8_t aes_rcon[AES_RCON_LEN];
+
+#if !defined(AES_CONSTANT_TIME) && !defined(AES_SMALL_FOOTPRINT) && !defined(AES_OTF_KEYS)
+#define  GF256_TABLES
+#endif
+
+#ifdef GF256_TABLES
+extern const uint8_t gf_mul2_table[256];
+extern const uint8_t gf_mul9_table[256];
+extern const uint8_t gf_mul11_table[256];
+extern const uint8_t gf_mul13_table[256];
+extern const uint8_t gf_mul14_table[256];
+#endif
+
+
+// {02} * b. The mask is 0x1b when the top bit is set, so there is no branch.
+static inline uint8_t gf_xtime(uint8_t b){
+#ifdef GF256_TABLES
+	return gf_mul2_table[b];
+#else
+	return (uint8_t) ((b << 1) ^ (0x1b & (uint8_t) -(b >> 7)));
+#endif
+}
+
+
+// The four InvMixColumns constants. {09} = {08} + {01}, {0b} = {08} + {02} + {01}, and so on.
+static inline uint8_t gf_mul9(uint8_t b){
+#ifdef GF256_TABLES
+	return gf_mul9_table[b];
+#else
+	uint8_t b8 = gf_xtime(gf_xtime(gf_xtime(b)));
+	return b8 ^ b;
+#endif
+}
+
+static inline uint8_t gf_mul11(uint8_t b){
+#ifdef GF256_TABLES
+	return gf_mul11_table[b];
+#else
+	uint8_t b2 = gf_xtime(b);
+	uint8_t b8 = gf_xtime(gf_xtime(b2));
+	return b8 ^ b2 ^ b;
+#endif
+}
+
+static inline uint8_t gf_mul13(uint8_t b){
+#ifdef GF256_TABLES
+	return gf_mul13_table[b];
+#else
+	uint8_t b4 = gf_xtime(gf_xtime(b));
+	uint8_t b8 = gf_xtime(b4);
+	return b8 ^ b4 ^ b;
+#endif
+}
+
+static inline uint8_t gf_mul14(uint8_t b){
+#ifdef GF256_TABLES
+	return gf_mul14_table[b];
+#else
+	uint8_t b2 = gf_xtime(b);
+	uint8_t b4 = gf_xtime(b2);
+	uint8_t b8 = gf_xtime(b4);
+	return b8 ^ b4 ^ b2;
+#endif
+}
+
+
+/*
+ * xtime on each byte of a word at once (SWAR). The low 7 bits of every byte
+ * shift left without crossing into the next byte, and each byte whose top bit
+ * was set gets 0x1b XORed in. Always table-free and branch-free.
+ */
+static inline uint32_t gf_xtime_word(uint32_t w){
+	uint32_t high_bits = (w >> 7) & 0x01010101U;
+	return ((w & 0x7f7f7f7fU) << 1) ^ (high_bits * 0x1b);
+}
+
+
+// Rotates a packed column right by whole bytes. Byte i of the result is byte i + n/8 of w.
+static inline uint32_t gf_rotr_word(uint32_t w, unsigned n){
+	return (w >> n) | (w << (32 - n));
+}
+
+
+/*
+ * MixColumns on one column packed little-endian (row 0 in the low byte).
+ * With t = w ^ (w >>> 8), byte i of xtime(t) is {02}r[i] + {02}r[i+1], which
+ * leaves r[i+1] + r[i+2] + r[i+3] to add from the rotations.
+ */
+static inline uint32_t gf_mix_column_word(uint32_t w){
+	uint32_t t = w ^ gf_rotr_word(w, 8);
+	return gf_xtime_word(t) ^ gf_rotr_word(w, 8) ^ gf_rotr_word(t, 16);
+}
+
+
+/*
+ * InvMixColumns on a packed column. The inverse matrix factors as MixColumns
+ * times {05 00 04 00} (The Design of Rijndael, section 4.1.3), so each byte
+ * first gets {04} times (itself + the byte two rows away) added.
+ */
+static inline uint32_t gf_inv_mix_column_word(uint32_t w){
+	uint32_t u = gf_xtime_word(gf_xtime_word(w ^ gf_rotr_word(w, 16)));
+	return gf_mix_column_word(w ^ u);
+}
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GF256_H_ */
@@ -0,0 +1,326 @@
+/*
+ ============================================================================
+ Name        : ghash_clmul.c
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : PCLMULQDQ GHASH and stitched AES-NI/GHASH loops for AES-GCM.
+ Note 1      : GCM numbers bits from the most significant end. Blocks are byte
+               reversed on load, the 256-bit carry-less product is shifted left
+               by one bit, and the result is reduced modulo
+               x^128 + x^7 + x^2 + x + 1 with shifts (Gueron and Kounavis,
+               "Intel Carry-Less Multiplication Instruction and its Usage for
+               Computing the GCM Mode", algorithms 1 and 4).
+ Note 2      : The shift and reduction are linear, so the products of 8 blocks
+               with H^8 .. H^1 are summed first and reduced once.
+ ============================================================================
+ */
+
+#include "ghash_clmul.h"
+
+#ifdef AES_X86_ACCEL
+
+#include <immintrin.h>
+
+#define CLMUL_TARGET  __attribute__((target("pclmul,ssse3")))
+#define GCM_TARGET    __attribute__((target("aes,pclmul,ssse3")))
+
+#define BSWAP_MASK  _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15)
+
+
+// Adds a * b (unreduced) into the 256-bit sum held as lo, mid and hi
+CLMUL_TARGET static inline void clmul_add(__m128i a, __m128i b, __m128i* lo, __m128i* mid, __m128i* hi){
+	*lo = _mm_xor_si128(*lo, _mm_clmulepi64_si128(a, b, 0x00));
+	*hi = _mm_xor_si128(*hi, _mm_clmulepi64_si128(a, b, 0x11));
+	*mid = _mm_xor_si128(*mid, _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10), _mm_clmulepi64_si128(a, b, 0x01)));
+}
+
+
+CLMUL_TARGET static inline __m128i reduce(__m128i lo, __m128i mid, __m128i hi){
+
+	lo = _mm_xor_si128(lo, _mm_slli_si128(mid, 8));
+	hi = _mm_xor_si128(hi, _mm_srli_si128(mid, 8));
+
+	// Shift the 256-bit product hi:lo left by one bit
+	__m128i lo_carry = _mm_srli_epi32(lo, 31);
+	__m128i hi_carry = _mm_srli_epi32(hi, 31);
+	lo = _mm_slli_epi32(lo, 1);
+	hi = _mm_slli_epi32(hi, 1);
+
+	__m128i cross = _mm_srli_si128(lo_carry, 12);
+	hi_carry = _mm_slli_si128(hi_carry, 4);
+	lo_carry = _mm_slli_si128(lo_carry, 4);
+	lo = _mm_or_si128(lo, lo_carry);
+	hi = _mm_or_si128(hi, _mm_or_si128(hi_carry, cross));
+
+	// First reduction phase
+	__m128i t = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(lo, 31), _mm_slli_epi32(lo, 30)), _mm_slli_epi32(lo, 25));
+	__m128i t_high = _mm_srli_si128(t, 4);
+	lo = _mm_xor_si128(lo, _mm_slli_si128(t, 12));
+
+	// Second reduction phase
+	t = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(lo, 1), _mm_srli_epi32(lo, 2)), _mm_srli_epi32(lo, 7));
+	t = _mm_xor_si128(t, t_high);
+	lo = _mm_xor_si128(lo, t);
+
+	return _mm_xor_si128(hi, lo);
+}
+
+
+CLMUL_TARGET static inline __m128i gf_mult(__m128i a, __m128i b){
+	__m128i lo = _mm_setzero_si128(), mid = _mm_setzero_si128(), hi = _mm_setzero_si128();
+	clmul_add(a, b, &lo, &mid, &hi);
+	return reduce(lo, mid, hi);
+}
+
+
+CLMUL_TARGET void ghash_clmul_init(const uint8_t* hash_key, uint8_t h_powers[GHASH_AGGREGATE][BYTES_IN_STATE]){
+
+	__m128i h = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) hash_key), BSWAP_MASK);
+	__m128i power = h;
+
+	_mm_storeu_si128((__m128i*) h_powers[0], h);
+
+	for(uint8_t i = 1; i < GHASH_AGGREGATE; i++){
+		power = gf_mult(power, h);
+		_mm_storeu_si128((__m128i*) h_powers[i], power);
+	}
+}
+
+
+// Loads 8 byte-reversed blocks; the accumulator is added to the first
+#define LOAD_REVERSED_8(c, in, acc, mask) \
+	c##0 = _mm_xor_si128(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) &(in)[0]), mask), acc); \
+	c##1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) &(in)[16]), mask); \
+	c##2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) &(in)[32]), mask); \
+	c##3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) &(in)[48]), mask); \
+	c##4 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) &(in)[64]), mask); \
+	c##5 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) &(in)[80]), mask); \
+	c##6 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) &(in)[96]), mask); \
+	c##7 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) &(in)[112]), mask)
+
+
+CLMUL_TARGET void ghash_clmul_blocks(uint8_t* ghash_acc, const uint8_t h_powers[GHASH_AGGREGATE][BYTES_IN_STATE],
+		const uint8_t* blocks, size_t num_blocks){
+
+	const __m128i mask = BSWAP_MASK;
+	__m128i hp[GHASH_AGGREGATE];
+
+	for(uint8_t i = 0; i < GHASH_AGGREGATE; i++){
+		hp[i] = _mm_loadu_si128((const __m128i*) h_powers[i]);
+	}
+
+	__m128i x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) ghash_acc), mask);
+	__m128i c0, c1, c2, c3, c4, c5, c6, c7;
+
+	while(num_blocks >= GHASH_AGGREGATE){
+
+		__m128i lo = _mm_setzero_si128(), mid = _mm_setzero_si128(), hi = _mm_setzero_si128();
+
+		LOAD_REVERSED_8(c, blocks, x, mask);
+		clmul_add(c0, hp[7], &lo, &mid, &hi);
+		clmul_add(c1, hp[6], &lo, &mid, &hi);
+		clmul_add(c2, hp[5], &lo, &mid, &hi);
+		clmul_add(c3, hp[4], &lo, &mid, &hi);
+		clmul_add(c4, hp[3], &lo, &mid, &hi);
+		clmul_add(c5, hp[2], &lo, &mid, &hi);
+		clmul_add(c6, hp[1], &lo, &mid, &hi);
+		clmul_add(c7, hp[0], &lo, &mid, &hi);
+		x = reduce(lo, mid, hi);
+
+		blocks += GHASH_AGGREGATE * BYTES_IN_STATE;
+		num_blocks -= GHASH_AGGREGATE;
+	}
+
+	while(num_blocks > 0){
+		__m128i block = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) blocks), mask);
+		x = gf_mult(_mm_xor_si128(x, block), hp[0]);
+
+		blocks += BYTES_IN_STATE;
+		num_blocks--;
+	}
+
+	_mm_storeu_si128((__m128i*) ghash_acc, _mm_shuffle_epi8(x, mask));
+}
+
+
+/*---------------- STITCHED AES-NI + GHASH -------------------*/
+
+// The counter is kept byte reversed, which puts its last 32 bits in lane 0
+#define COUNTERS_8(b, ctr, mask, key) \
+	b##0 = _mm_xor_si128(_mm_shuffle_epi8(ctr, mask), key); \
+	b##1 = _mm_xor_si128(_mm_shuffle_epi8(_mm_add_epi32(ctr, _mm_setr_epi32(1, 0, 0, 0)), mask), key); \
+	b##2 = _mm_xor_si128(_mm_shuffle_epi8(_mm_add_epi32(ctr, _mm_setr_epi32(2, 0, 0, 0)), mask), key); \
+	b##3 = _mm_xor_si128(_mm_shuffle_epi8(_mm_add_epi32(ctr, _mm_setr_epi32(3, 0, 0, 0)), mask), key); \
+	b##4 = _mm_xor_si128(_mm_shuffle_epi8(_mm_add_epi32(ctr, _mm_setr_epi32(4, 0, 0, 0)), mask), key); \
+	b##5 = _mm_xor_si128(_mm_shuffle_epi8(_mm_add_epi32(ctr, _mm_setr_epi32(5, 0, 0, 0)), mask), key); \
+	b##6 = _mm_xor_si128(_mm_shuffle_epi8(_mm_add_epi32(ctr, _mm_setr_epi32(6, 0, 0, 0)), mask), key); \
+	b##7 = _mm_xor_si128(_mm_shuffle_epi8(_mm_add_epi32(ctr, _mm_setr_epi32(7, 0, 0, 0)), mask), key); \
+	ctr = _mm_add_epi32(ctr, _mm_setr_epi32(8, 0, 0, 0))
+
+#define ROUND_8(op, b, key) \
+	b##0 = op(b##0, key); b##1 = op(b##1, key); b##2 = op(b##2, key); b##3 = op(b##3, key); \
+	b##4 = op(b##4, key); b##5 = op(b##5, key); b##6 = op(b##6, key); b##7 = op(b##7, key)
+
+// One AES round for all 8 blocks plus the GHASH multiply of one block
+#define STITCHED_ROUND(b, rk, c, hp, lo, mid, hi) \
+	ROUND_8(_mm_aesenc_si128, b, rk); \
+	clmul_add(c, hp, &lo, &mid, &hi)
+
+// Rounds 1 to 8 each carry one GHASH multiply; the rest of the rounds run alone
+#define ROUNDS_WITH_GHASH(b, rk, Nr, c, hp, x) do{ \
+	__m128i lo = _mm_setzero_si128(), mid = _mm_setzero_si128(), hi = _mm_setzero_si128(); \
+	STITCHED_ROUND(b, rk[1], c##0, hp[7], lo, mid, hi); \
+	STITCHED_ROUND(b, rk[2], c##1, hp[6], lo, mid, hi); \
+	STITCHED_ROUND(b, rk[3], c##2, hp[5], lo, mid, hi); \
+	STITCHED_ROUND(b, rk[4], c##3, hp[4], lo, mid, hi); \
+	STITCHED_ROUND(b, rk[5], c##4, hp[3], lo, mid, hi); \
+	STITCHED_ROUND(b, rk[6], c##5, hp[2], lo, mid, hi); \
+	STITCHED_ROUND(b, rk[7], c##6, hp[1], lo, mid, hi); \
+	STITCHED_ROUND(b, rk[8], c##7, hp[0], lo, mid, hi); \
+	for(uint8_t round = 9; round < Nr; round++){ \
+		ROUND_8(_mm_aesenc_si128, b, rk[round]); \
+	} \
+	x = reduce(lo, mid, hi); \
+	ROUND_8(_mm_aesenclast_si128, b, rk[Nr]); \
+} while(0)
+
+// out = in ^ keystream for 8 blocks; c gets the ciphertext written (byte reversed)
+#define XOR_STORE_8(out, in, b) \
+	b##0 = _mm_xor_si128(b##0, _mm_loadu_si128((const __m128i*) &(in)[0])); \
+	b##1 = _mm_xor_si128(b##1, _mm_loadu_si128((const __m128i*) &(in)[16])); \
+	b##2 = _mm_xor_si128(b##2, _mm_loadu_si128((const __m128i*) &(in)[32])); \
+	b##3 = _mm_xor_si128(b##3, _mm_loadu_si128((const __m128i*) &(in)[48])); \
+	b##4 = _mm_xor_si128(b##4, _mm_loadu_si128((const __m128i*) &(in)[64])); \
+	b##5 = _mm_xor_si128(b##5, _mm_loadu_si128((const __m128i*) &(in)[80])); \
+	b##6 = _mm_xor_si128(b##6, _mm_loadu_si128((const __m128i*) &(in)[96])); \
+	b##7 = _mm_xor_si128(b##7, _mm_loadu_si128((const __m128i*) &(in)[112])); \
+	_mm_storeu_si128((__m128i*) &(out)[0], b##0); \
+	_mm_storeu_si128((__m128i*) &(out)[16], b##1); \
+	_mm_storeu_si128((__m128i*) &(out)[32], b##2); \
+	_mm_storeu_si128((__m128i*) &(out)[48], b##3); \
+	_mm_storeu_si128((__m128i*) &(out)[64], b##4); \
+	_mm_storeu_si128((__m128i*) &(out)[80], b##5); \
+	_mm_storeu_si128((__m128i*) &(out)[96], b##6); \
+	_mm_storeu_si128((__m128i*) &(out)[112], b##7)
+
+#define REVERSE_8(c, b, acc, mask) \
+	c##0 = _mm_xor_si128(_mm_shuffle_epi8(b##0, mask), acc); \
+	c##1 = _mm_shuffle_epi8(b##1, mask); c##2 = _mm_shuffle_epi8(b##2, mask); \
+	c##3 = _mm_shuffle_epi8(b##3, mask); c##4 = _mm_shuffle_epi8(b##4, mask); \
+	c##5 = _mm_shuffle_epi8(b##5, mask); c##6 = _mm_shuffle_epi8(b##6, mask); \
+	c##7 = _mm_shuffle_epi8(b##7, mask)
+
+
+GCM_TARGET size_t gcm_clmul_encrypt(const aes_ctx* ctx, uint8_t* counter_block, uint8_t* ghash_acc,
+		const uint8_t h_powers[GHASH_AGGREGATE][BYTES_IN_STATE], const uint8_t* in, uint8_t* out, size_t num_blocks){
+
+	const size_t num_batches = num_blocks / GHASH_AGGREGATE;
+
+	if(num_batches == 0){
+		return 0;
+	}
+
+	const uint8_t Nr = ctx->Nr;
+	const __m128i mask = BSWAP_MASK;
+	__m128i rk[15], hp[GHASH_AGGREGATE];
+
+	for(uint8_t i = 0; i <= Nr; i++){
+		rk[i] = _mm_load_si128((const __m128i*) &ctx->round_keys[i * BYTES_IN_STATE]);
+	}
+	for(uint8_t i = 0; i < GHASH_AGGREGATE; i++){
+		hp[i] = _mm_loadu_si128((const __m128i*) h_powers[i]);
+	}
+
+	__m128i x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) ghash_acc), mask);
+	__m128i ctr = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) counter_block), mask);
+	__m128i b0, b1, b2, b3, b4, b5, b6, b7;
+	__m128i c0, c1, c2, c3, c4, c5, c6, c7;
+
+	// The first batch has no earlier ciphertext to hash
+	COUNTERS_8(b, ctr, mask, rk[0]);
+	for(uint8_t round = 1; round < Nr; round++){
+		ROUND_8(_mm_aesenc_si128, b, rk[round]);
+	}
+	ROUND_8(_mm_aesenclast_si128, b, rk[Nr]);
+	XOR_STORE_8(out, in, b);
+	REVERSE_8(c, b, x, mask);
+
+	for(size_t batch = 1; batch < num_batches; batch++){
+
+		in += GHASH_AGGREGATE * BYTES_IN_STATE;
+		out += GHASH_AGGREGATE * BYTES_IN_STATE;
+
+		// Keystream for this batch while hashing the previous batch's ciphertext
+		COUNTERS_8(b, ctr, mask, rk[0]);
+		ROUNDS_WITH_GHASH(b, rk, Nr, c, hp, x);
+		XOR_STORE_8(out, in, b);
+		REVERSE_8(c, b, x, mask);
+	}
+
+	// Hash the last batch
+	{
+		__m128i lo = _mm_setzero_si128(), mid = _mm_setzero_si128(), hi = _mm_setzero_si128();
+		clmul_add(c0, hp[7], &lo, &mid, &hi);
+		clmul_add(c1, hp[6], &lo, &mid, &hi);
+		clmul_add(c2, hp[5], &lo, &mid, &hi);
+		clmul_add(c3, hp[4], &lo, &mid, &hi);
+		clmul_add(c4, hp[3], &lo, &mid, &hi);
+		clmul_add(c5, hp[2], &lo, &mid, &hi);
+		clmul_add(c6, hp[1], &lo, &mid, &hi);
+		clmul_add(c7, hp[0], &lo, &mid, &hi);
+		x = reduce(lo, mid, hi);
+	}
+
+	_mm_storeu_si128((__m128i*) ghash_acc, _mm_shuffle_epi8(x, mask));
+	_mm_storeu_si128((__m128i*) counter_block, _mm_shuffle_epi8(ctr, mask));
+
+	return num_batches * GHASH_AGGREGATE;
+}
+
+
+GCM_TARGET size_t gcm_clmul_decrypt(const aes_ctx* ctx, uint8_t* counter_block, uint8_t* ghash_acc,
+		const uint8_t h_powers[GHASH_AGGREGATE][BYTES_IN_STATE], const uint8_t* in, uint8_t* out, size_t num_blocks){
+
+	const size_t num_batches = num_blocks / GHASH_AGGREGATE;
+
+	if(num_batches == 0){
+		return 0;
+	}
+
+	const uint8_t Nr = ctx->Nr;
+	const __m128i mask = BSWAP_MASK;
+	__m128i rk[15], hp[GHASH_AGGREGATE];
+
+	for(uint8_t i = 0; i <= Nr; i++){
+		rk[i] = _mm_load_si128((const __m128i*) &ctx->round_keys[i * BYTES_IN_STATE]);
+	}
+	for(uint8_t i = 0; i < GHASH_AGGREGATE; i++){
+		hp[i] = _mm_loadu_si128((const __m128i*) h_powers[i]);
+	}
+
+	__m128i x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) ghash_acc), mask);
+	__m128i ctr = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) counter_block), mask);
+	__m128i b0, b1, b2, b3, b4, b5, b6, b7;
+	__m128i c0, c1, c2, c3, c4, c5, c6, c7;
+
+	for(size_t batch = 0; batch < num_batches; batch++){
+
+		// The ciphertext is already known, so this batch is hashed while its keystream is made
+		LOAD_REVERSED_8(c, in, x, mask);
+		COUNTERS_8(b, ctr, mask, rk[0]);
+		ROUNDS_WITH_GHASH(b, rk, Nr, c, hp, x);
+		XOR_STORE_8(out, in, b);
+
+		in += GHASH_AGGREGATE * BYTES_IN_STATE;
+		out += GHASH_AGGREGATE * BYTES_IN_STATE;
+	}
+
+	_mm_storeu_si128((__m128i*) ghash_acc, _mm_shuffle_epi8(x, mask));
+	_mm_storeu_si128((__m128i*) counter_block, _mm_shuffle_epi8(ctr, mask));
+
+	return num_batches * GHASH_AGGREGATE;
+}
+
+#endif /* AES_X86_ACCEL */
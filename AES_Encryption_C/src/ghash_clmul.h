@@ -0,0 +1,70 @@
+/*
+ ============================================================================
+ Name        : ghash_clmul.h
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : GHASH with the x86 carry-less multiply instruction (PCLMULQDQ),
+               and AES-GCM bulk loops that run AES-NI counter mode and GHASH
+               in the same pass. Only built when AES_X86_ACCEL is defined.
+ ============================================================================
+ */
+
+#ifndef GHASH_CLMUL_H_
+#define GHASH_CLMUL_H_
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+#include <stdint.h>
+#include "aes_encryption.h"
+
+#ifdef AES_X86_ACCEL
+
+// Blocks hashed per reduction in the aggregated GHASH and the stitched loops
+#define  GHASH_AGGREGATE  8
+
+/*
+ * Purpose : Computes H^1 .. H^8 in the byte-reversed form used by the
+ *           functions below. h_powers[i] holds H^(i + 1).
+ * Inputs  : Hash subkey H = E(K, 0^128), output table
+ */
+void ghash_clmul_init(const uint8_t* hash_key, uint8_t h_powers[GHASH_AGGREGATE][BYTES_IN_STATE]);
+
+
+/*
+ * Purpose : Absorbs whole 16-byte blocks into the GHASH accumulator. Eight
+ *           blocks share one reduction: X = (X + B0)H^8 + B1 H^7 + ... + B7 H.
+ * Inputs  : Accumulator (GCM byte order), H powers, blocks, block count
+ */
+void ghash_clmul_blocks(uint8_t* ghash_acc, const uint8_t h_powers[GHASH_AGGREGATE][BYTES_IN_STATE],
+		const uint8_t* blocks, size_t num_blocks);
+
+
+/*
+ * Purpose : AES-GCM encryption/decryption of whole blocks with AES-NI. Each
+ *           pass makes 8 blocks of keystream and, between the AES rounds,
+ *           hashes 8 ciphertext blocks (the previous batch when encrypting,
+ *           the current batch when decrypting).
+ * Inputs  : Context using the AES-NI engine, counter block (incremented in
+ *           its last 32 bits), GHASH accumulator, H powers, data, block count
+ * Outputs : Number of blocks processed (a multiple of 8; the caller handles
+ *           the rest). The counter block and accumulator are updated.
+ */
+size_t gcm_clmul_encrypt(const aes_ctx* ctx, uint8_t* counter_block, uint8_t* ghash_acc,
+		const uint8_t h_powers[GHASH_AGGREGATE][BYTES_IN_STATE], const uint8_t* in, uint8_t* out, size_t num_blocks);
+
+size_t gcm_clmul_decrypt(const aes_ctx* ctx, uint8_t* counter_block, uint8_t* ghash_acc,
+		const uint8_t h_powers[GHASH_AGGREGATE][BYTES_IN_STATE], const uint8_t* in, uint8_t* out, size_t num_blocks);
+
+#endif /* AES_X86_ACCEL */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GHASH_CLMUL_H_ */
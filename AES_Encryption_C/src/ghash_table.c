@@ -0,0 +1,97 @@
+/*
+ ============================================================================
+ Name        : ghash_table.c
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : Shoup's 4-bit table method for GF(2^128) multiplication in GCM
+               bit order: 16 multiples of H, and each block is multiplied one
+               nibble at a time, reducing the 4 bits shifted out each step.
+ ============================================================================
+ */
+
+#include "ghash_table.h"
+
+// Reduction of the 4 bits shifted out of the low end, x^128 = x^7 + x^2 + x + 1
+static const uint64_t shoup_reduce[16] = {
+	0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+	0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0
+};
+
+
+static uint64_t load_be64(const uint8_t* bytes){
+	uint64_t value = 0;
+	for(uint8_t i = 0; i < 8; i++){
+		value = (value << 8) | bytes[i];
+	}
+	return value;
+}
+
+
+static void store_be64(uint8_t* bytes, uint64_t value){
+	for(int i = 7; i >= 0; i--){
+		bytes[i] = (uint8_t) value;
+		value >>= 8;
+	}
+}
+
+
+void ghash_table_init(ghash_table* table, const uint8_t* hash_key){
+
+	uint64_t hi = load_be64(hash_key);
+	uint64_t lo = load_be64(&hash_key[8]);
+
+	// Entry 8 is H itself (bit order is reversed), entries 4, 2, 1 are H times x, x^2, x^3
+	table->hi[0] = 0;
+	table->lo[0] = 0;
+	table->hi[8] = hi;
+	table->lo[8] = lo;
+
+	for(uint8_t i = 4; i > 0; i >>= 1){
+		uint64_t carry = (lo & 1) ? UINT64_C(0xe100000000000000) : 0;
+		lo = (hi << 63) | (lo >> 1);
+		hi = (hi >> 1) ^ carry;
+		table->hi[i] = hi;
+		table->lo[i] = lo;
+	}
+
+	// Every other entry is the sum of the power-of-two entries for its set bits
+	for(uint8_t i = 2; i <= 8; i <<= 1){
+		for(uint8_t j = 1; j < i; j++){
+			table->hi[i + j] = table->hi[i] ^ table->hi[j];
+			table->lo[i + j] = table->lo[i] ^ table->lo[j];
+		}
+	}
+}
+
+
+// x = x * H
+void ghash_table_mult(const ghash_table* table, uint8_t* x){
+
+	uint8_t nibble = x[15] & 0x0f;
+	uint64_t hi = table->hi[nibble];
+	uint64_t lo = table->lo[nibble];
+
+	for(int i = 15; i >= 0; i--){
+
+		if(i != 15){
+			nibble = x[i] & 0x0f;
+			uint8_t rem = (uint8_t) (lo & 0x0f);
+			lo = (hi << 60) | (lo >> 4);
+			hi = (hi >> 4) ^ (shoup_reduce[rem] << 48);
+			hi ^= table->hi[nibble];
+			lo ^= table->lo[nibble];
+		}
+
+		nibble = x[i] >> 4;
+		uint8_t rem = (uint8_t) (lo & 0x0f);
+		lo = (hi << 60) | (lo >> 4);
+		hi = (hi >> 4) ^ (shoup_reduce[rem] << 48);
+		hi ^= table->hi[nibble];
+		lo ^= table->lo[nibble];
+	}
+
+	store_be64(x, hi);
+	store_be64(&x[8], lo);
+}
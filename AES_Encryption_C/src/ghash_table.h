@@ -0,0 +1,42 @@
+/*
+ ============================================================================
+ Name        : ghash_table.h
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : Portable GHASH multiplication with Shoup's 4-bit tables. Used
+               by AES-GCM and, through the RFC 8452 mapping, by POLYVAL when
+               there is no carry-less multiply instruction.
+ ============================================================================
+ */
+
+#ifndef GHASH_TABLE_H_
+#define GHASH_TABLE_H_
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+#include <stdint.h>
+
+// 16 multiples of H, one per 4-bit value, as 128-bit numbers split in two halves
+typedef struct{
+	uint64_t hi[16];
+	uint64_t lo[16];
+} ghash_table;
+
+
+// Builds the table for hash key H (GCM byte and bit order)
+void ghash_table_init(ghash_table* table, const uint8_t* hash_key);
+
+// x = x * H in GF(2^128), one nibble of x at a time
+void ghash_table_mult(const ghash_table* table, uint8_t* x);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GHASH_TABLE_H_ */
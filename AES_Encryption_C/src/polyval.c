@@ -0,0 +1,174 @@
+/*
+ ============================================================================
+ Name        : polyval.c
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : POLYVAL. dot(a, b) = a * b * x^-128 modulo
+               x^128 + x^127 + x^126 + x^121 + 1, with blocks read as
+               little-endian polynomials.
+ Note 1      : With PCLMULQDQ the byte order already matches, so there is no
+               byte swapping. The product is reduced by two folds with the
+               constant 0xc2000...01 (Gueron, Langley and Lindell, RFC 8452
+               appendix and the AES-GCM-SIV paper). The reduction is linear,
+               so 8 blocks times H^8 .. H^1 are summed and reduced once.
+ Note 2      : Without it, POLYVAL(H, X) = ByteReverse(GHASH(mulX_GHASH(
+               ByteReverse(H)), ByteReverse(X))) (RFC 8452 appendix A), so the
+               GHASH tables from ghash_table.c are reused. The accumulator is
+               kept byte reversed between blocks.
+ ============================================================================
+ */
+
+#include "polyval.h"
+#include "cpu_features.h"
+
+
+static void byte_reverse(uint8_t* out, const uint8_t* in){
+	for(uint8_t i = 0; i < BYTES_IN_STATE; i++){
+		out[i] = in[BYTES_IN_STATE - 1 - i];
+	}
+}
+
+
+/*---------------- PCLMULQDQ -------------------*/
+
+#ifdef AES_X86_ACCEL
+
+#include <immintrin.h>
+
+#define CLMUL_TARGET  __attribute__((target("pclmul,sse2")))
+
+
+// Adds a * b (unreduced) into the 256-bit sum held as lo, mid and hi
+CLMUL_TARGET static inline void clmul_add(__m128i a, __m128i b, __m128i* lo, __m128i* mid, __m128i* hi){
+	*lo = _mm_xor_si128(*lo, _mm_clmulepi64_si128(a, b, 0x00));
+	*hi = _mm_xor_si128(*hi, _mm_clmulepi64_si128(a, b, 0x11));
+	*mid = _mm_xor_si128(*mid, _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10), _mm_clmulepi64_si128(a, b, 0x01)));
+}
+
+
+// Multiplies the 256-bit product by x^-128 and reduces it to 128 bits
+CLMUL_TARGET static inline __m128i reduce(__m128i lo, __m128i mid, __m128i hi){
+
+	const __m128i poly = _mm_set_epi64x((long long) UINT64_C(0xc200000000000000), 1);
+
+	lo = _mm_xor_si128(lo, _mm_slli_si128(mid, 8));
+	hi = _mm_xor_si128(hi, _mm_srli_si128(mid, 8));
+
+	// Each fold clears the low 64 bits of lo and moves it up by 64
+	__m128i t = _mm_clmulepi64_si128(lo, poly, 0x10);
+	lo = _mm_xor_si128(_mm_shuffle_epi32(lo, 0x4e), t);
+	t = _mm_clmulepi64_si128(lo, poly, 0x10);
+	lo = _mm_xor_si128(_mm_shuffle_epi32(lo, 0x4e), t);
+
+	return _mm_xor_si128(hi, lo);
+}
+
+
+CLMUL_TARGET static inline __m128i dot(__m128i a, __m128i b){
+	__m128i lo = _mm_setzero_si128(), mid = _mm_setzero_si128(), hi = _mm_setzero_si128();
+	clmul_add(a, b, &lo, &mid, &hi);
+	return reduce(lo, mid, hi);
+}
+
+
+CLMUL_TARGET static void polyval_clmul_init(polyval_key* key, const uint8_t* hash_key){
+
+	__m128i h = _mm_loadu_si128((const __m128i*) hash_key);
+	__m128i power = h;
+
+	_mm_store_si128((__m128i*) key->h_powers[0], power);
+	for(uint8_t i = 1; i < POLYVAL_AGGREGATE; i++){
+		power = dot(power, h);
+		_mm_store_si128((__m128i*) key->h_powers[i], power);
+	}
+}
+
+
+CLMUL_TARGET static void polyval_clmul_blocks(const polyval_key* key, uint8_t* acc, const uint8_t* blocks, size_t num_blocks){
+
+	__m128i h[POLYVAL_AGGREGATE];
+	for(uint8_t i = 0; i < POLYVAL_AGGREGATE; i++){
+		h[i] = _mm_load_si128((const __m128i*) key->h_powers[i]);
+	}
+
+	__m128i s = _mm_loadu_si128((const __m128i*) acc);
+
+	while(num_blocks >= POLYVAL_AGGREGATE){
+
+		__m128i lo = _mm_setzero_si128(), mid = _mm_setzero_si128(), hi = _mm_setzero_si128();
+
+		// (S + X0) H^8 + X1 H^7 + ... + X7 H
+		clmul_add(_mm_xor_si128(s, _mm_loadu_si128((const __m128i*) blocks)), h[7], &lo, &mid, &hi);
+		for(uint8_t i = 1; i < POLYVAL_AGGREGATE; i++){
+			clmul_add(_mm_loadu_si128((const __m128i*) &blocks[i * BYTES_IN_STATE]), h[7 - i], &lo, &mid, &hi);
+		}
+		s = reduce(lo, mid, hi);
+
+		blocks += POLYVAL_AGGREGATE * BYTES_IN_STATE;
+		num_blocks -= POLYVAL_AGGREGATE;
+	}
+
+	while(num_blocks > 0){
+		s = dot(_mm_xor_si128(s, _mm_loadu_si128((const __m128i*) blocks)), h[0]);
+		blocks += BYTES_IN_STATE;
+		num_blocks--;
+	}
+
+	_mm_storeu_si128((__m128i*) acc, s);
+}
+
+#endif /* AES_X86_ACCEL */
+
+
+/*---------------- INTERFACE -------------------*/
+
+void polyval_init(polyval_key* key, const uint8_t* hash_key){
+
+	// mulX_GHASH(ByteReverse(H)): multiply by x in GCM bit order, a right shift
+	uint8_t ghash_key[BYTES_IN_STATE];
+	byte_reverse(ghash_key, hash_key);
+
+	uint8_t carry = ghash_key[BYTES_IN_STATE - 1] & 1;
+	for(uint8_t i = BYTES_IN_STATE - 1; i > 0; i--){
+		ghash_key[i] = (uint8_t) ((ghash_key[i] >> 1) | (ghash_key[i - 1] << 7));
+	}
+	ghash_key[0] = (uint8_t) ((ghash_key[0] >> 1) ^ (carry * 0xe1));
+
+	ghash_table_init(&key->table, ghash_key);
+	aes_secure_wipe(ghash_key, sizeof(ghash_key));
+
+	key->use_clmul = false;
+
+#ifdef AES_X86_ACCEL
+	if(cpu_has_pclmul()){
+		polyval_clmul_init(key, hash_key);
+		key->use_clmul = true;
+	}
+#endif
+}
+
+
+void polyval_blocks(const polyval_key* key, uint8_t* acc, const uint8_t* blocks, size_t num_blocks){
+
+#ifdef AES_X86_ACCEL
+	if(key->use_clmul){
+		polyval_clmul_blocks(key, acc, blocks, num_blocks);
+		return;
+	}
+#endif
+
+	uint8_t reversed_acc[BYTES_IN_STATE];
+	uint8_t reversed_block[BYTES_IN_STATE];
+
+	byte_reverse(reversed_acc, acc);
+
+	for(size_t block = 0; block < num_blocks; block++){
+		byte_reverse(reversed_block, &blocks[block * BYTES_IN_STATE]);
+		xor_bytes(reversed_acc, reversed_acc, reversed_block, BYTES_IN_STATE);
+		ghash_table_mult(&key->table, reversed_acc);
+	}
+
+	byte_reverse(acc, reversed_acc);
+}
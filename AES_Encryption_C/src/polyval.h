@@ -0,0 +1,51 @@
+/*
+ ============================================================================
+ Name        : polyval.h
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : POLYVAL universal hash (RFC 8452 section 3), the GHASH
+               counterpart used by AES-GCM-SIV. PCLMULQDQ when CPUID reports
+               it, otherwise 4-bit tables.
+ ============================================================================
+ */
+
+#ifndef POLYVAL_H_
+#define POLYVAL_H_
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+#include "aes_encryption.h"
+#include "ghash_table.h"
+
+// Blocks hashed per reduction on the PCLMULQDQ path
+#define  POLYVAL_AGGREGATE  8
+
+typedef struct{
+	ghash_table table;  // Table for H' = mulX_GHASH(ByteReverse(H)), portable path
+#ifdef AES_X86_ACCEL
+	uint8_t h_powers[POLYVAL_AGGREGATE][BYTES_IN_STATE] AES_ALIGNED(16);  // H^1 .. H^8 for PCLMULQDQ
+#endif
+	bool use_clmul;
+} polyval_key;
+
+
+// Sets up the hash key H (16 bytes, POLYVAL byte order) for whichever path this CPU uses
+void polyval_init(polyval_key* key, const uint8_t* hash_key);
+
+/*
+ * Purpose : Absorbs whole 16-byte blocks: S = dot(S + X, H) for each block
+ * Inputs  : Key, 16-byte accumulator (start from zero), blocks, block count
+ */
+void polyval_blocks(const polyval_key* key, uint8_t* acc, const uint8_t* blocks, size_t num_blocks);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* POLYVAL_H_ */
@@ -5,7 +5,8 @@
  Version     : 1
  Copyright   : N/A
  Date        : Feb 21, 2022
- Description : Contains function to create the key schedule
+ Description : Contains functions to create the encryption and decryption
+               key schedules
  Note 1      : All of the operations on the state vector are byte-indexed
                (as opposed to word indexed). Otherwise, words would need to be
                decomposed in order to operate on the bytes, adding work.
@@ -13,11 +14,10 @@
  */
 
 #include "pre_cipher_utils.h"
+#include "gf256.h"
 
 
-uint8_t* generate_key_schedule(uint8_t* cipher_key, uint8_t Nr, uint8_t Nk){
-
-    static uint8_t key_schedule[240] = {0};
+void generate_key_schedule(const uint8_t* cipher_key, uint8_t* key_schedule, uint8_t Nr, uint8_t Nk){
 
     uint8_t word_num = 0;
     uint8_t current_word_byte_zero;
@@ -57,13 +57,7 @@ uint8_t* generate_key_schedule(uint8_t* cipher_key, uint8_t Nr, uint8_t Nk){
 				temp_word[i] = apply_sbox(temp_word[i]);
 			}
 
-			uint8_t Nk_multiple = word_num / Nk;
-			if(Nk_multiple == 1){
-				round_constant = 1;
-			}
-			else{
-				round_constant = mult_by_x(1 , Nk_multiple - 1);
-			}
+			round_constant = aes_rcon[(word_num / Nk) - 1];
 
 			// XOR temp and round constant. Bytes 2, 3, and 4 of round constant are 0.
 			temp_word[0] ^= round_constant;
@@ -83,8 +77,27 @@ uint8_t* generate_key_schedule(uint8_t* cipher_key, uint8_t Nr, uint8_t Nk){
 
 		word_num++;
 	}
+}
+
+
+void generate_dec_key_schedule(const uint8_t* key_schedule, uint8_t* dec_key_schedule, uint8_t Nr){
 
-	return key_schedule;
+	// Round keys are stored in the order decryption uses them: the last
+	// encryption round key first, the cipher key itself last.
+	for(uint8_t round = 0; round <= Nr; round++){
+
+		const uint8_t* src = &key_schedule[(Nr - round) * BYTES_IN_STATE];
+		uint8_t* dst = &dec_key_schedule[round * BYTES_IN_STATE];
+
+		for(uint8_t i = 0; i < BYTES_IN_STATE; i++){
+			dst[i] = src[i];
+		}
+
+		// The first and last round keys are used without inv_mix_col_words
+		if(round != 0 && round != Nr){
+			inv_mix_col_words(dst);
+		}
+	}
 }
 
 
@@ -50,12 +50,22 @@ uint8_t set_algo_params(uint32_t cipher_key_len, key_params param);
 /*
  * Purpose : Creates the key schedule used on the state matrix during every
  *           transformation round.
- * Inputs  : Cipher key
- * Outputs : Returns a pointer to the key_schedule array. key_schedule is
- *           declared as static so the memory remains allocated for the
- *           duration of the program.
+ * Inputs  : Cipher key, caller-owned key schedule storage (at least
+ *           KEY_SCHED_MAX_BYTES), number of rounds, number of key words
+ * Outputs : key_schedule is filled with (Nr + 1) 16-byte round keys
  */
-uint8_t* generate_key_schedule(uint8_t* cipher_key, const uint8_t Nr, const uint8_t Nk);
+void generate_key_schedule(const uint8_t* cipher_key, uint8_t* key_schedule, const uint8_t Nr, const uint8_t Nk);
+
+
+/*
+ * Purpose : Creates the round keys for the equivalent inverse cipher (FIPS 197
+ *           section 5.3.5) from an encryption key schedule.
+ * Inputs  : Encryption key schedule, caller-owned output storage, number of rounds
+ * Outputs : dec_key_schedule holds the round keys in decryption order, with
+ *           inv_mix_col_words already applied to every round key but the
+ *           first and last.
+ */
+void generate_dec_key_schedule(const uint8_t* key_schedule, uint8_t* dec_key_schedule, const uint8_t Nr);
 
 
 #ifdef __cplusplus
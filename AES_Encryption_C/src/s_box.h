@@ -20,10 +20,9 @@
 
 
 #include <stdint.h>
-#include "aes_encryption.h"
 
-extern const uint8_t s_box[16][16];
-extern const uint8_t inv_s_box[16][16];
+extern const uint8_t s_box[256];
+extern const uint8_t inv_s_box[256];
 
 /*
  * Purpose : Exchanges a byte's value with its corresponding value in the
@@ -31,7 +30,9 @@ extern const uint8_t inv_s_box[16][16];
  * Inputs  : 1 byte of data
  * Outputs : 1 byte from the s-box corresponding to input
  */
-uint8_t apply_sbox(uint8_t byte);
+static inline uint8_t apply_sbox(uint8_t byte){
+	return s_box[byte];
+}
 
 
 /*
@@ -39,7 +40,9 @@ uint8_t apply_sbox(uint8_t byte);
  * Inputs  : 1 byte of s-box lookup values from the encryption process
  * Outputs : 1 byte that was originally transformed by the s-box
  */
-uint8_t apply_inv_sbox(uint8_t byte);
+static inline uint8_t apply_inv_sbox(uint8_t byte){
+	return inv_s_box[byte];
+}
 
 
 #ifdef __cplusplus
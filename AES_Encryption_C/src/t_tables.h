@@ -0,0 +1,72 @@
+/*
+ ============================================================================
+ Name        : t_tables.h
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : 32-bit T-table AES engine. SubBytes, ShiftRows and MixColumns are
+               merged into table lookups on whole state columns.
+ Note 1      : The tables take 10KB of constant data, so this engine is left out of
+               builds with AES_SMALL_FOOTPRINT defined.
+ ============================================================================
+ */
+
+#ifndef T_TABLES_H_
+#define T_TABLES_H_
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+#include <stdint.h>
+#include "aes_encryption.h"
+
+#ifndef AES_SMALL_FOOTPRINT
+
+/*
+ * Each entry holds one output column of the combined round transform for a
+ * single input byte. Columns are little-endian words (row 0 in the low byte).
+ * te1-te3 are te0 rotated left by 8, 16 and 24 bits. te4 holds the s-box
+ * value in all four bytes and is used for the last round (no MixColumns).
+ */
+extern const uint32_t te0[256];
+extern const uint32_t te1[256];
+extern const uint32_t te2[256];
+extern const uint32_t te3[256];
+extern const uint32_t te4[256];
+
+// Same layout for the equivalent inverse cipher: InvSubBytes + InvMixColumns,
+// with td4 holding the inverse s-box value in all four bytes.
+extern const uint32_t td0[256];
+extern const uint32_t td1[256];
+extern const uint32_t td2[256];
+extern const uint32_t td3[256];
+extern const uint32_t td4[256];
+
+
+/*
+ * Purpose : Encrypts consecutive 16-byte blocks with the context's round keys
+ * Inputs  : Initialized context, input blocks, output location, block count
+ * Outputs : Ciphertext written to out (out may equal in)
+ */
+void t_table_encrypt_blocks(const aes_ctx* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks);
+
+
+/*
+ * Purpose : Decrypts consecutive 16-byte blocks with the context's decryption
+ *           round keys (aes_ctx_prepare_decrypt() must have been called)
+ * Inputs  : Initialized context, input blocks, output location, block count
+ * Outputs : Plaintext written to out (out may equal in)
+ */
+void t_table_decrypt_blocks(const aes_ctx* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks);
+
+#endif /* AES_SMALL_FOOTPRINT */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* T_TABLES_H_ */
@@ -0,0 +1,267 @@
+/*
+ ============================================================================
+ Name        : vperm.c
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : Constant-time vector-permute AES engine. Every table lookup is
+               done with PSHUFB on 16-entry tables held in registers, so no
+               memory address depends on the key or data.
+ Note 1      : SubBytes splits each byte into its high and low nibble. The s-box
+               is 16 rows of 16 bytes; every row is looked up with the low
+               nibble, and a saturating add pushes bit 7 of the shuffle index
+               high for every byte whose high nibble does not match the row,
+               which makes PSHUFB return zero for it. XORing all 16 results
+               gives the s-box output.
+ Note 2      : ShiftRows and the row rotations inside MixColumns are fixed byte
+               shuffles. xtime uses a compare against zero instead of a branch.
+ Note 3      : The AVX2 path runs two blocks per 256-bit register. VPSHUFB
+               shuffles each 128-bit lane separately, which is exactly one block.
+ ============================================================================
+ */
+
+#include "vperm.h"
+
+#ifdef AES_X86_ACCEL
+
+#include <immintrin.h>
+#include "cpu_features.h"
+
+#define SSSE3_TARGET  __attribute__((target("ssse3")))
+#define AVX2_TARGET   __attribute__((target("avx2")))
+
+
+bool vperm_supported(void){
+	return cpu_has_ssse3();
+}
+
+
+// Byte shuffles in _mm_setr_epi8 order (output byte 0 first). Byte i of the
+// state is row (i % 4) of column (i / 4).
+#define SHIFT_ROWS_IDX      0, 5, 10, 15, 4, 9, 14, 3, 8, 13, 2, 7, 12, 1, 6, 11
+#define INV_SHIFT_ROWS_IDX  0, 13, 10, 7, 4, 1, 14, 11, 8, 5, 2, 15, 12, 9, 6, 3
+#define ROT_ROWS_1_IDX      1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12
+#define ROT_ROWS_2_IDX      2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13
+
+
+/*---------------- SSSE3: ONE BLOCK PER REGISTER -------------------*/
+
+typedef struct{
+	__m128i rows[16];
+	__m128i shift_rows;
+	__m128i rot_1;
+	__m128i rot_2;
+} vperm_consts_128;
+
+
+SSSE3_TARGET static void load_consts_128(vperm_consts_128* c, const uint8_t* box, bool inverse){
+	for(uint8_t row = 0; row < 16; row++){
+		c->rows[row] = _mm_loadu_si128((const __m128i*) &box[row * 16]);
+	}
+	c->shift_rows = inverse ? _mm_setr_epi8(INV_SHIFT_ROWS_IDX) : _mm_setr_epi8(SHIFT_ROWS_IDX);
+	c->rot_1 = _mm_setr_epi8(ROT_ROWS_1_IDX);
+	c->rot_2 = _mm_setr_epi8(ROT_ROWS_2_IDX);
+}
+
+
+SSSE3_TARGET static inline __m128i sub_bytes_128(__m128i x, const __m128i* rows){
+
+	const __m128i row_step = _mm_set1_epi8(0x10);
+	const __m128i push_high = _mm_set1_epi8(0x70);
+	__m128i out = _mm_setzero_si128();
+
+	// idx has its high nibble reduced by one each row, so it is zero exactly on the matching row
+	__m128i idx = x;
+	for(uint8_t row = 0; row < 16; row++){
+		out = _mm_xor_si128(out, _mm_shuffle_epi8(rows[row], _mm_adds_epu8(idx, push_high)));
+		idx = _mm_sub_epi8(idx, row_step);
+	}
+
+	return out;
+}
+
+
+SSSE3_TARGET static inline __m128i xtime_128(__m128i x){
+	__m128i carries = _mm_and_si128(_mm_cmplt_epi8(x, _mm_setzero_si128()), _mm_set1_epi8(0x1b));
+	return _mm_xor_si128(_mm_add_epi8(x, x), carries);
+}
+
+
+// r_i = {02}(a_i + a_(i+1)) + a_(i+1) + (a_(i+2) + a_(i+3))
+SSSE3_TARGET static inline __m128i mix_columns_128(__m128i x, const vperm_consts_128* c){
+	__m128i r1 = _mm_shuffle_epi8(x, c->rot_1);
+	__m128i t = _mm_xor_si128(x, r1);
+	return _mm_xor_si128(_mm_xor_si128(xtime_128(t), r1), _mm_shuffle_epi8(t, c->rot_2));
+}
+
+
+// InvMixColumns = MixColumns after u_i = a_i + {04}(a_i + a_(i+2))
+SSSE3_TARGET static inline __m128i inv_mix_columns_128(__m128i x, const vperm_consts_128* c){
+	__m128i t = _mm_xor_si128(x, _mm_shuffle_epi8(x, c->rot_2));
+	x = _mm_xor_si128(x, xtime_128(xtime_128(t)));
+	return mix_columns_128(x, c);
+}
+
+
+SSSE3_TARGET static __m128i encrypt_128(__m128i x, const uint8_t* rk, uint8_t Nr, const vperm_consts_128* c){
+
+	x = _mm_xor_si128(x, _mm_load_si128((const __m128i*) rk));
+
+	for(uint8_t round = 1; round < Nr; round++){
+		x = _mm_shuffle_epi8(sub_bytes_128(x, c->rows), c->shift_rows);
+		x = mix_columns_128(x, c);
+		x = _mm_xor_si128(x, _mm_load_si128((const __m128i*) &rk[round * BYTES_IN_STATE]));
+	}
+
+	x = _mm_shuffle_epi8(sub_bytes_128(x, c->rows), c->shift_rows);
+	return _mm_xor_si128(x, _mm_load_si128((const __m128i*) &rk[Nr * BYTES_IN_STATE]));
+}
+
+
+// Equivalent inverse cipher: same structure as encryption
+SSSE3_TARGET static __m128i decrypt_128(__m128i x, const uint8_t* dk, uint8_t Nr, const vperm_consts_128* c){
+
+	x = _mm_xor_si128(x, _mm_load_si128((const __m128i*) dk));
+
+	for(uint8_t round = 1; round < Nr; round++){
+		x = _mm_shuffle_epi8(sub_bytes_128(x, c->rows), c->shift_rows);
+		x = inv_mix_columns_128(x, c);
+		x = _mm_xor_si128(x, _mm_load_si128((const __m128i*) &dk[round * BYTES_IN_STATE]));
+	}
+
+	x = _mm_shuffle_epi8(sub_bytes_128(x, c->rows), c->shift_rows);
+	return _mm_xor_si128(x, _mm_load_si128((const __m128i*) &dk[Nr * BYTES_IN_STATE]));
+}
+
+
+SSSE3_TARGET static void run_blocks_128(const uint8_t* keys, uint8_t Nr, const uint8_t* in, uint8_t* out,
+		size_t num_blocks, bool inverse){
+
+	vperm_consts_128 c;
+	load_consts_128(&c, inverse ? inv_s_box : s_box, inverse);
+
+	for(size_t block = 0; block < num_blocks; block++){
+		__m128i x = _mm_loadu_si128((const __m128i*) &in[block * BYTES_IN_STATE]);
+		x = inverse ? decrypt_128(x, keys, Nr, &c) : encrypt_128(x, keys, Nr, &c);
+		_mm_storeu_si128((__m128i*) &out[block * BYTES_IN_STATE], x);
+	}
+}
+
+
+/*---------------- AVX2: TWO BLOCKS PER REGISTER -------------------*/
+
+typedef struct{
+	__m256i rows[16];
+	__m256i shift_rows;
+	__m256i rot_1;
+	__m256i rot_2;
+} vperm_consts_256;
+
+
+AVX2_TARGET static void load_consts_256(vperm_consts_256* c, const uint8_t* box, bool inverse){
+	for(uint8_t row = 0; row < 16; row++){
+		c->rows[row] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) &box[row * 16]));
+	}
+	c->shift_rows = inverse ? _mm256_setr_epi8(INV_SHIFT_ROWS_IDX, INV_SHIFT_ROWS_IDX) :
+			_mm256_setr_epi8(SHIFT_ROWS_IDX, SHIFT_ROWS_IDX);
+	c->rot_1 = _mm256_setr_epi8(ROT_ROWS_1_IDX, ROT_ROWS_1_IDX);
+	c->rot_2 = _mm256_setr_epi8(ROT_ROWS_2_IDX, ROT_ROWS_2_IDX);
+}
+
+
+AVX2_TARGET static inline __m256i sub_bytes_256(__m256i x, const __m256i* rows){
+
+	const __m256i row_step = _mm256_set1_epi8(0x10);
+	const __m256i push_high = _mm256_set1_epi8(0x70);
+	__m256i out = _mm256_setzero_si256();
+
+	__m256i idx = x;
+	for(uint8_t row = 0; row < 16; row++){
+		out = _mm256_xor_si256(out, _mm256_shuffle_epi8(rows[row], _mm256_adds_epu8(idx, push_high)));
+		idx = _mm256_sub_epi8(idx, row_step);
+	}
+
+	return out;
+}
+
+
+AVX2_TARGET static inline __m256i xtime_256(__m256i x){
+	__m256i carries = _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_setzero_si256(), x), _mm256_set1_epi8(0x1b));
+	return _mm256_xor_si256(_mm256_add_epi8(x, x), carries);
+}
+
+
+AVX2_TARGET static inline __m256i mix_columns_256(__m256i x, const vperm_consts_256* c){
+	__m256i r1 = _mm256_shuffle_epi8(x, c->rot_1);
+	__m256i t = _mm256_xor_si256(x, r1);
+	return _mm256_xor_si256(_mm256_xor_si256(xtime_256(t), r1), _mm256_shuffle_epi8(t, c->rot_2));
+}
+
+
+AVX2_TARGET static inline __m256i inv_mix_columns_256(__m256i x, const vperm_consts_256* c){
+	__m256i t = _mm256_xor_si256(x, _mm256_shuffle_epi8(x, c->rot_2));
+	x = _mm256_xor_si256(x, xtime_256(xtime_256(t)));
+	return mix_columns_256(x, c);
+}
+
+
+AVX2_TARGET static inline __m256i round_key_256(const uint8_t* keys, uint8_t round){
+	return _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*) &keys[round * BYTES_IN_STATE]));
+}
+
+
+AVX2_TARGET static void run_blocks_256(const uint8_t* keys, uint8_t Nr, const uint8_t* in, uint8_t* out,
+		size_t num_pairs, bool inverse){
+
+	vperm_consts_256 c;
+	load_consts_256(&c, inverse ? inv_s_box : s_box, inverse);
+
+	for(size_t pair = 0; pair < num_pairs; pair++){
+
+		__m256i x = _mm256_loadu_si256((const __m256i*) &in[pair * 2 * BYTES_IN_STATE]);
+
+		x = _mm256_xor_si256(x, round_key_256(keys, 0));
+
+		for(uint8_t round = 1; round < Nr; round++){
+			x = _mm256_shuffle_epi8(sub_bytes_256(x, c.rows), c.shift_rows);
+			x = inverse ? inv_mix_columns_256(x, &c) : mix_columns_256(x, &c);
+			x = _mm256_xor_si256(x, round_key_256(keys, round));
+		}
+
+		x = _mm256_shuffle_epi8(sub_bytes_256(x, c.rows), c.shift_rows);
+		x = _mm256_xor_si256(x, round_key_256(keys, Nr));
+
+		_mm256_storeu_si256((__m256i*) &out[pair * 2 * BYTES_IN_STATE], x);
+	}
+}
+
+
+/*---------------- ENGINE FUNCTIONS -------------------*/
+
+static void run_blocks(const uint8_t* keys, uint8_t Nr, const uint8_t* in, uint8_t* out, size_t num_blocks, bool inverse){
+
+	if(num_blocks >= 2 && cpu_has_avx2()){
+		size_t num_pairs = num_blocks / 2;
+		run_blocks_256(keys, Nr, in, out, num_pairs, inverse);
+		in += num_pairs * 2 * BYTES_IN_STATE;
+		out += num_pairs * 2 * BYTES_IN_STATE;
+		num_blocks -= num_pairs * 2;
+	}
+
+	if(num_blocks > 0){
+		run_blocks_128(keys, Nr, in, out, num_blocks, inverse);
+	}
+}
+
+
+void vperm_encrypt_blocks(const aes_ctx* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks){
+	run_blocks(ctx->round_keys, ctx->Nr, in, out, num_blocks, false);
+}
+
+
+void vperm_decrypt_blocks(const aes_ctx* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks){
+	run_blocks(ctx->dec_round_keys, ctx->Nr, in, out, num_blocks, true);
+}
+
+#endif /* AES_X86_ACCEL */
@@ -0,0 +1,46 @@
+/*
+ ============================================================================
+ Name        : vperm.h
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : Constant-time vector-permute AES engine for x86 CPUs without
+               AES-NI (or VMs that hide it). Needs SSSE3, and runs two blocks
+               per register when AVX2 is available.
+ ============================================================================
+ */
+
+#ifndef VPERM_H_
+#define VPERM_H_
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+#include <stdint.h>
+#include "aes_encryption.h"
+
+#ifdef AES_X86_ACCEL
+
+bool vperm_supported(void);
+
+/*
+ * Purpose : Encrypts/decrypts consecutive 16-byte blocks. Decryption uses the
+ *           context's equivalent inverse cipher round keys.
+ * Inputs  : Initialized context, input blocks, output location, block count
+ * Outputs : Result written to out (out may equal in)
+ */
+void vperm_encrypt_blocks(const aes_ctx* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks);
+
+void vperm_decrypt_blocks(const aes_ctx* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks);
+
+#endif /* AES_X86_ACCEL */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VPERM_H_ */
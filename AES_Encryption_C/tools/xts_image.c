@@ -0,0 +1,87 @@
+/*
+ ============================================================================
+ Name        : xts_image.c
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : Command line tool that encrypts or decrypts a disk image file in
+               place with XTS-AES. Host only (uses the worker thread pool).
+ Note 1      : Usage: xts_image <encrypt|decrypt> <image file> <key file> [sector size]
+               The key file holds the raw XTS key: 32 bytes for XTS-AES-128 or
+               64 bytes for XTS-AES-256. The sector size defaults to 512.
+ Note 2      : Build with gcc -O2 -pthread -I../src, giving it xts_image.c and
+               every .c file in ../src except test_functions.c.
+ ============================================================================
+ */
+
+#include <stdio.h>
+#include "aes_xts.h"
+
+#define  MAX_KEY_FILE_BYTES  64
+
+
+int main(int argc, char** argv){
+
+	if(argc < 4 || argc > 5){
+		fprintf(stderr, "Usage: %s <encrypt|decrypt> <image file> <key file> [sector size]\n", argv[0]);
+		return 1;
+	}
+
+	aes_op_flag direction;
+	if(strcmp(argv[1], "encrypt") == 0){
+		direction = encrypt;
+	}
+	else if(strcmp(argv[1], "decrypt") == 0){
+		direction = decrypt;
+	}
+	else{
+		fprintf(stderr, "Unknown operation '%s'\n", argv[1]);
+		return 1;
+	}
+
+	size_t sector_size = 512;
+	if(argc == 5){
+		sector_size = (size_t) strtoul(argv[4], NULL, 10);
+	}
+
+	// Read one byte past the largest key so an oversized key file is caught
+	uint8_t key[MAX_KEY_FILE_BYTES + 1];
+	FILE* key_file = fopen(argv[3], "rb");
+	if(key_file == NULL){
+		fprintf(stderr, "Could not open key file '%s'\n", argv[3]);
+		return 1;
+	}
+	size_t key_bytes = fread(key, 1, sizeof(key), key_file);
+	fclose(key_file);
+
+	cipher_len key_len;
+	if(key_bytes == 32){
+		key_len = key_128;
+	}
+	else if(key_bytes == 64){
+		key_len = key_256;
+	}
+	else{
+		aes_secure_wipe(key, sizeof(key));
+		fprintf(stderr, "Key file must hold 32 or 64 bytes\n");
+		return 1;
+	}
+
+	aes_xts_ctx xts;
+	aes_out result = aes_xts_init(&xts, key_len, key);
+	aes_secure_wipe(key, sizeof(key));
+
+	if(result.termination_code == 0){
+		result = aes_xts_crypt_file(argv[2], &xts, sector_size, direction);
+	}
+
+	aes_xts_destroy(&xts);
+
+	if(result.termination_code != 0){
+		fprintf(stderr, "%s\n", result.msg);
+		return 1;
+	}
+
+	return 0;
+}
@@ -10,51 +10,8 @@
  */
 
 #include "pre_hash_funcs.h"
-
-
-// Fill the message block entirely with words from the original message
-void fill_msg_blk_no_pad(uint32_t* msg, uint64_t blk_num, uint32_t* block_to_fill){
-
-	// Find the index of the first word of the current message block
-	uint64_t start_word_idx = blk_num * MSG_BLOCK_LEN;
-
-	// Fill the message block
-	for (uint32_t i = 0; i < MSG_BLOCK_LEN; i++){
-		block_to_fill[i] = msg[start_word_idx + i];
-	}
-}
-
-
-// Fill the message block entirely with words from the end of the zero pad
-void fill_msg_blk_w_pad(uint32_t* pad_array, uint32_t pad_words_total, uint32_t* block_to_fill){
-
-	// Words from the pad used in the last block
-	uint32_t start_idx = pad_words_total - MSG_BLOCK_LEN;
-
-	// Fill the message block with the last 16 entries
-	for (int32_t i = 0; i < MSG_BLOCK_LEN; i++){
-		block_to_fill[i] = pad_array[start_idx + i];
-	}
-}
-
-
-// Fill the message block with words from the end of the message and beginning
-// of the zero pad
-void fill_blk_msg_and_pad(uint32_t* msg, uint64_t blk_num, uint64_t msg_len_words, uint32_t* block_to_fill, uint32_t* pad_array){
-
-	uint32_t num_msg_words_in_blk = msg_len_words - (blk_num * MSG_BLOCK_LEN);
-
-	uint64_t start_word_idx = blk_num * MSG_BLOCK_LEN;
-
-	for(uint32_t i = 0; i < MSG_BLOCK_LEN; i++){
-		if(i < num_msg_words_in_blk){
-			block_to_fill[i] = msg[start_word_idx + i];
-		}
-		else{
-			block_to_fill[i] = pad_array[i - num_msg_words_in_blk];
-		}
-	}
-}
+#include "sha_ni.h"
+#include "sha_sse.h"
 
 
 void create_msg_schedule(uint32_t* msg_schedule_array, uint32_t* msg_block){
@@ -76,5 +33,77 @@ void create_msg_schedule(uint32_t* msg_schedule_array, uint32_t* msg_block){
 }
 
 
+void compress_blocks(uint32_t* hash_vals, const uint8_t* blocks, uint64_t num_blocks){
+
+#ifdef SHA_X86_ACCEL
+	if(sha_ni_supported()){
+		sha_ni_compress_blocks(hash_vals, blocks, num_blocks);
+		return;
+	}
+
+	if(sha_sse_supported()){
+		sha_sse_compress_blocks(hash_vals, blocks, num_blocks);
+		return;
+	}
+#endif
+
+	compress_blocks_portable(hash_vals, blocks, num_blocks);
+}
+
+
+void compress_blocks_portable(uint32_t* hash_vals, const uint8_t* blocks, uint64_t num_blocks){
+
+	uint32_t msg_schedule_array[MSG_SCHED_LEN];
+	uint32_t msg_block[MSG_BLOCK_LEN];
+
+	// Temporary variables with NIST naming convention
+	uint32_t a, b, c, d, e, f, g, h;
+	uint32_t t1;
+	uint32_t t2;
 
+	// Begin the rounds of compression, 1 iteration for each 512 bit message block
+	for(uint64_t blk_num = 0; blk_num < num_blocks; blk_num++){
+
+		for(uint32_t i = 0; i < MSG_BLOCK_LEN; i++){
+			msg_block[i] = bytes_to_word(&blocks[(blk_num * SHA256_BLOCK_BYTES) + (i * 4)]);
+		}
 
+		create_msg_schedule(msg_schedule_array, msg_block);
+
+		a = hash_vals[0];
+		b = hash_vals[1];
+		c = hash_vals[2];
+		d = hash_vals[3];
+		e = hash_vals[4];
+		f = hash_vals[5];
+		g = hash_vals[6];
+		h = hash_vals[7];
+
+		// Operations on working variables as defined by NIST FIPS 180-4 (SHA standard)
+		for (uint32_t i = 0; i < MSG_SCHED_LEN; i++){
+
+			t1 = add_w_mod( add_w_mod( add_w_mod( add_w_mod( h, sum1(e)) , ch_xor(e, f, g)), k_vals[i]),
+					msg_schedule_array[i]);
+
+			t2 = add_w_mod(sum0(a), maj_xor(a,b,c));
+			h = g;
+			g = f;
+			f = e;
+
+			e = add_w_mod(d, t1);
+			d = c;
+			c = b;
+			b = a;
+			a = add_w_mod(t1, t2);
+		}
+
+		hash_vals[0] = add_w_mod(a, hash_vals[0]);
+		hash_vals[1] = add_w_mod(b, hash_vals[1]);
+		hash_vals[2] = add_w_mod(c, hash_vals[2]);
+		hash_vals[3] = add_w_mod(d, hash_vals[3]);
+		hash_vals[4] = add_w_mod(e, hash_vals[4]);
+		hash_vals[5] = add_w_mod(f, hash_vals[5]);
+		hash_vals[6] = add_w_mod(g, hash_vals[6]);
+		hash_vals[7] = add_w_mod(h, hash_vals[7]);
+	}
+}
@@ -20,16 +20,16 @@
 #include "sha_256.h"
 #include "math_funcs.h"
 
-void fill_msg_blk_no_pad(uint32_t* msg, uint64_t blk_num, uint32_t* block_to_fill);
-
-
-void fill_msg_blk_w_pad(uint32_t* pad_array, uint32_t pad_words_total, uint32_t* block_to_fill);
-
+void create_msg_schedule(uint32_t* msg_schedule_array, uint32_t* msg);
 
-void fill_blk_msg_and_pad(uint32_t* msg, uint64_t blk_num, uint64_t msg_len_words, uint32_t* block_to_fill, uint32_t* pad_array);
 
+// Runs the compression function over num_blocks 64-byte blocks, read straight from blocks.
+// Uses the fastest backend the CPU supports.
+void compress_blocks(uint32_t* hash_vals, const uint8_t* blocks, uint64_t num_blocks);
 
-void create_msg_schedule(uint32_t* msg_schedule_array, uint32_t* msg);
+// The portable C backend, used on every CPU without a faster one. On x86,
+// sha_sse_compress_blocks() is the same with a vectorized message schedule.
+void compress_blocks_portable(uint32_t* hash_vals, const uint8_t* blocks, uint64_t num_blocks);
 
 
 #ifdef __cplusplus
@@ -77,3 +77,16 @@ uint32_t rot_r(uint32_t x, uint32_t shift_n){
 
 	return x;
 }
+
+
+// Big-endian, the byte order SHA-256 uses for message words and the digest
+uint32_t bytes_to_word(const uint8_t* bytes){
+	return ((uint32_t) bytes[0] << 24) | ((uint32_t) bytes[1] << 16) | ((uint32_t) bytes[2] << 8) | bytes[3];
+}
+
+void word_to_bytes(uint32_t word, uint8_t* bytes){
+	bytes[0] = (uint8_t) (word >> 24);
+	bytes[1] = (uint8_t) (word >> 16);
+	bytes[2] = (uint8_t) (word >> 8);
+	bytes[3] = (uint8_t) word;
+}
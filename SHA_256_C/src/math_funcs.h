@@ -39,6 +39,10 @@ uint32_t rot_l(uint32_t x, uint32_t shift_n);
 
 uint32_t rot_r(uint32_t x, uint32_t shift_n);
 
+uint32_t bytes_to_word(const uint8_t* bytes);
+
+void word_to_bytes(uint32_t word, uint8_t* bytes);
+
 
 #ifdef __cplusplus
 }
@@ -5,31 +5,14 @@
  Version     : 1
  Copyright   : N/A
  Date        : Feb 24, 2022
- Description : Contains the pad generator function and the K constants used
-               to set the temporary variables between compressions.
+ Description : Contains the K constants used to set the temporary variables
+               between compressions. Padding is added by sha256_final().
  ============================================================================
  */
 
 #include "pre_hash_funcs.h"
 
 
-uint32_t* pad_msg(uint64_t words_of_padding, uint64_t msg_len_words){
-
-	static uint32_t padding_array[ZERO_PAD_MAX_LEN] = {0};
-
-	// Put a '1' immediately after the message
-	padding_array[0] = 0x80000000;
-
-	uint64_t total_msg_bits = msg_len_words * 32 ;
-
-	// Put the message length in bytes in the last two words
-	padding_array[words_of_padding - 2] = (total_msg_bits >> BITS_IN_WORD);
-	padding_array[words_of_padding - 1] = (total_msg_bits & 0x00000000FFFFFFFF);
-
-	return padding_array;
-}
-
-
 const uint32_t k_vals[64] = {
 
 	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
@@ -5,8 +5,8 @@
  Version     : 1
  Copyright   : N/A
  Date        : Feb 24, 2022
- Description : Contains the pad generator function and the K constants used
-               to set the temporary variables between compressions.
+ Description : Contains the K constants used to set the temporary variables
+               between compressions. Padding is added by sha256_final().
  ============================================================================
  */
 
@@ -21,8 +21,6 @@
 #include "sha_256.h"
 #include <stdint.h>
 
-uint32_t* pad_msg(uint64_t words_of_padding, uint64_t msg_len_words);
-
 
 #ifdef __cplusplus
 }
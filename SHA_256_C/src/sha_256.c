@@ -6,7 +6,8 @@
  Copyright   : N/A
  Date        : Feb 24, 2022
  Description : SHA-256 hashing module. Hardware independent.
- Note 1      : This module requires that message lengths be a multiple of 32 bits
+ Note 1      : use_sha_256() requires that message lengths be a multiple of 32
+               bits. The sha256_ctx functions take any number of bytes.
  Note 2      : At max, there could be 2^55 blocks of 512 bits. That's why any value
                related to the message length uses a uint64_t.
  Note 3      : This module is meant to be used with a hardware or platform specific
@@ -23,120 +24,122 @@ uint32_t use_sha_256(uint32_t* msg, uint64_t msg_len_words, uint32_t* output_loc
 	uint32_t error_code = error_handler(msg, msg_len_words, output_loc);
 	if(error_code != 0) return error_code;
 
-	uint32_t* pad_array;
+	sha256_ctx ctx;
+	sha256_init(&ctx);
 
-	uint32_t zero_pad_len = MSG_BLOCK_LEN - (msg_len_words % MSG_BLOCK_LEN);
+	// Words are hashed most significant byte first, one block's worth at a time
+	uint8_t block[SHA256_BLOCK_BYTES];
+	while(msg_len_words > 0){
 
-	// Pad must be at least 3 words, or it wraps to incorporate another block
-	if (zero_pad_len < 3){
-		zero_pad_len = zero_pad_len + MSG_BLOCK_LEN;
+		uint32_t words = (msg_len_words > MSG_BLOCK_LEN) ? MSG_BLOCK_LEN : (uint32_t) msg_len_words;
+
+		for(uint32_t i = 0; i < words; i++){
+			word_to_bytes(msg[i], &block[i * 4]);
+		}
+
+		sha256_update(&ctx, block, words * 4);
+
+		msg += words;
+		msg_len_words -= words;
 	}
 
-	pad_array = pad_msg(zero_pad_len, msg_len_words);
+	uint8_t digest[SHA256_DIGEST_BYTES];
+	sha256_final(&ctx, digest);
 
+	for (uint32_t i = 0; i < NUM_TEMP_HASHES; i++){
+		output_loc[i] = bytes_to_word(&digest[i * 4]);
+	}
 
-	// Initial hash values defined in NIST FIPS 180-4 (SHA standard)
-	uint32_t hash_vals[NUM_TEMP_HASHES] = {
+	return EXIT_SUCCESS;
+}
 
-		0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
-	};
 
-	// Temporary variables with NIST naming convention
-	uint32_t a = hash_vals[0];
-	uint32_t b = hash_vals[1];
-	uint32_t c = hash_vals[2];
-	uint32_t d = hash_vals[3];
-	uint32_t e = hash_vals[4];
-	uint32_t f = hash_vals[5];
-	uint32_t g = hash_vals[6];
-	uint32_t h = hash_vals[7];
-	uint32_t t1;
-	uint32_t t2;
+uint32_t sha256_init(sha256_ctx* ctx){
 
-	uint64_t total_len_words = msg_len_words + zero_pad_len;
+	if(ctx == NULL) return CTX_NULL_PTR_ERR;
 
-	uint64_t total_blocks = total_len_words / MSG_BLOCK_LEN;
+	// Initial hash values defined in NIST FIPS 180-4 (SHA standard)
+	const uint32_t initial_hash_vals[NUM_TEMP_HASHES] = {
+
+		0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+	};
 
-	uint32_t msg_schedule_array[MSG_SCHED_LEN];
+	memcpy(ctx->hash_vals, initial_hash_vals, sizeof(initial_hash_vals));
+	ctx->buffer_len = 0;
+	ctx->msg_len_bytes = 0;
 
-	uint32_t msg_block[MSG_BLOCK_LEN] = {0};
+	return EXIT_SUCCESS;
+}
 
-	uint64_t zero_pad_start_blk;
-	(zero_pad_len <= MSG_BLOCK_LEN) ? (zero_pad_start_blk = total_blocks - 1) : (zero_pad_start_blk = total_blocks - 2);
 
+uint32_t sha256_update(sha256_ctx* ctx, const uint8_t* data, size_t len){
 
-	// Begin the rounds of compression, 1 iteration for each 512 bit message block
-	for(uint64_t blk_num = 0; blk_num < total_blocks; blk_num++){
+	if(ctx == NULL) return CTX_NULL_PTR_ERR;
+	if(len == 0) return EXIT_SUCCESS;
+	if(data == NULL) return MSG_ARRAY_NULL_PTR_ERR;
 
-		// Create the message block.
-		if (blk_num >= zero_pad_start_blk){
-			if (blk_num == zero_pad_start_blk){
-				// This block will be the end of the message and the first words (perhaps only words) of the pad
-				fill_blk_msg_and_pad(msg, blk_num, msg_len_words, msg_block, pad_array);
-			}
-			else{
-				// This is only used if the zero pad takes up more than a full 16-word block
-				fill_msg_blk_w_pad(pad_array, zero_pad_len, msg_block);
-			}
-		}
-		// Fill the 512-bit block only with message bits (this will be what happens most of the time)
-		else{
-			fill_msg_blk_no_pad(msg, blk_num, msg_block);
-		}
+	ctx->msg_len_bytes += len;
 
+	// Top up a partial block from the previous call first
+	if(ctx->buffer_len > 0){
 
-		create_msg_schedule(msg_schedule_array, msg_block);
+		size_t fill = SHA256_BLOCK_BYTES - ctx->buffer_len;
+		if(fill > len) fill = len;
 
-		// Operations on working variables as defined by NIST FIPS 180-4 (SHA standard)
-		for (uint32_t i = 0; i < MSG_SCHED_LEN; i++){
+		memcpy(&ctx->buffer[ctx->buffer_len], data, fill);
+		ctx->buffer_len += (uint32_t) fill;
+		data += fill;
+		len -= fill;
 
-			t1 = add_w_mod( add_w_mod( add_w_mod( add_w_mod( h, sum1(e)) , ch_xor(e, f, g)), k_vals[i]),
-					msg_schedule_array[i]);
+		if(ctx->buffer_len < SHA256_BLOCK_BYTES) return EXIT_SUCCESS;
 
-			t2 = add_w_mod(sum0(a), maj_xor(a,b,c));
-			h = g;
-			g = f;
-			f = e;
+		compress_blocks(ctx->hash_vals, ctx->buffer, 1);
+		ctx->buffer_len = 0;
+	}
 
-			e = add_w_mod(d, t1);
-			d = c;
-			c = b;
-			b = a;
-			a = add_w_mod(t1, t2);
-		}
+	// Whole blocks need no copy
+	size_t full_blocks = len / SHA256_BLOCK_BYTES;
+	if(full_blocks > 0){
+		compress_blocks(ctx->hash_vals, data, full_blocks);
+		data += full_blocks * SHA256_BLOCK_BYTES;
+		len -= full_blocks * SHA256_BLOCK_BYTES;
+	}
 
-		hash_vals[0] = add_w_mod(a, hash_vals[0]);
-		// Reset working variables for the next loop iteration (next msg block)
-		a = hash_vals[0];
+	memcpy(ctx->buffer, data, len);
+	ctx->buffer_len = (uint32_t) len;
 
-		hash_vals[1] = add_w_mod(b, hash_vals[1]);
-		b = hash_vals[1];
+	return EXIT_SUCCESS;
+}
 
-		hash_vals[2] = add_w_mod(c, hash_vals[2]);
-		c = hash_vals[2];
 
-		hash_vals[3] = add_w_mod(d, hash_vals[3]);
-		d= hash_vals[3];
+uint32_t sha256_final(sha256_ctx* ctx, uint8_t* digest){
 
-		hash_vals[4] = add_w_mod(e, hash_vals[4]);
-		e = hash_vals[4];
+	if(ctx == NULL) return CTX_NULL_PTR_ERR;
+	if(digest == NULL) return OUTPUT_LOC_NULL_PTR_ERR;
 
-		hash_vals[5] = add_w_mod(f, hash_vals[5]);
-		f = hash_vals[5];
+	uint64_t total_msg_bits = ctx->msg_len_bytes * 8;
 
-		hash_vals[6] = add_w_mod(g, hash_vals[6]);
-		g = hash_vals[6];
+	// Put a '1' immediately after the message
+	ctx->buffer[ctx->buffer_len++] = 0x80;
 
-		hash_vals[7] = add_w_mod(h, hash_vals[7]);
-		h = hash_vals[7];
+	// The length takes the last 8 bytes. If they don't fit, the pad runs into another block.
+	if(ctx->buffer_len > SHA256_BLOCK_BYTES - 8){
+		memset(&ctx->buffer[ctx->buffer_len], 0, SHA256_BLOCK_BYTES - ctx->buffer_len);
+		compress_blocks(ctx->hash_vals, ctx->buffer, 1);
+		ctx->buffer_len = 0;
 	}
 
+	memset(&ctx->buffer[ctx->buffer_len], 0, SHA256_BLOCK_BYTES - 8 - ctx->buffer_len);
+	word_to_bytes((uint32_t) (total_msg_bits >> BITS_IN_WORD), &ctx->buffer[SHA256_BLOCK_BYTES - 8]);
+	word_to_bytes((uint32_t) total_msg_bits, &ctx->buffer[SHA256_BLOCK_BYTES - 4]);
+	compress_blocks(ctx->hash_vals, ctx->buffer, 1);
 
-for (uint32_t i = 0; i < NUM_TEMP_HASHES; i++){
-
-	output_loc[i] = hash_vals[i];
-}
+	for (uint32_t i = 0; i < NUM_TEMP_HASHES; i++){
+		word_to_bytes(ctx->hash_vals[i], &digest[i * 4]);
+	}
 
+	// The buffer and chaining values are message dependent
+	memset(ctx, 0, sizeof(*ctx));
 
 	return EXIT_SUCCESS;
 }
@@ -6,6 +6,12 @@
  Copyright   : N/A
  Date        : Feb 24, 2022
  Description : SHA-256 hashing module. Hardware independent.
+ Note 1      : Messages can be hashed in one call with use_sha_256() (whole
+               32-bit words), or streamed through a sha256_ctx: init, update
+               any number of times with byte data of any length, then final.
+ Note 2      : On x86 the compression function uses the SHA instructions when
+               CPUID reports them, and the portable C code otherwise. Define
+               SHA_NO_HW_ACCEL to build only the portable code.
 
  ============================================================================
  */
@@ -20,24 +26,54 @@
 
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
+
+#if !defined(SHA_NO_HW_ACCEL) && (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define  SHA_X86_ACCEL
+#endif
+
 #include "pre_hash_funcs.h"
 #include "math_funcs.h"
 #include "hash_funcs.h"
 
 extern const uint32_t k_vals[];
 
-#define MSG_BLOCK_LEN     16
-#define NUM_TEMP_HASHES   8
-#define MSG_SCHED_LEN     64
-#define ZERO_PAD_MAX_LEN  18
-#define BITS_IN_WORD      32
+#define MSG_BLOCK_LEN        16
+#define NUM_TEMP_HASHES      8
+#define MSG_SCHED_LEN        64
+#define BITS_IN_WORD         32
+#define SHA256_BLOCK_BYTES   64
+#define SHA256_DIGEST_BYTES  32
 
 #define MSG_ARRAY_NULL_PTR_ERR   1
 #define MSG_LEN_ZERO_ERR         2
 #define OUTPUT_LOC_NULL_PTR_ERR  3
+#define CTX_NULL_PTR_ERR         4
+
+typedef struct{
+	uint32_t hash_vals[NUM_TEMP_HASHES];
+	uint8_t buffer[SHA256_BLOCK_BYTES];  // Partial block carried over to the next update
+	uint32_t buffer_len;
+	uint64_t msg_len_bytes;              // Total so far, for the length in the pad
+} sha256_ctx;
+
 
 uint32_t use_sha_256(uint32_t* msg, uint64_t msg_len_words, uint32_t* output_loc);
 
+/*
+ * Streaming interface. Full blocks are compressed straight from the caller's
+ * data; only a partial block is copied into the context. Memory use does not
+ * depend on the message length, and an empty message is allowed.
+ * Each returns 0, or one of the error codes above.
+ */
+uint32_t sha256_init(sha256_ctx* ctx);
+
+uint32_t sha256_update(sha256_ctx* ctx, const uint8_t* data, size_t len);
+
+// Pads the message and writes the 32-byte digest (big-endian, as printed in FIPS 180-4 examples)
+uint32_t sha256_final(sha256_ctx* ctx, uint8_t* digest);
+
 uint32_t error_handler();
 
 
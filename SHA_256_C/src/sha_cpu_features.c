@@ -0,0 +1,119 @@
+/*
+ ============================================================================
+ Name        : sha_cpu_features.c
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : Runtime checks for optional x86 instruction set extensions.
+ Note 1      : AVX and AVX-512 registers can only be used if the OS saves them
+               on context switches, which is checked with XGETBV in addition
+               to CPUID.
+ Note 2      : CPUID leaves 1 and 7 and XCR0 are read once and the answers are
+               cached, since the checks run on every compress call.
+ ============================================================================
+ */
+
+#include "sha_cpu_features.h"
+
+#ifdef SHA_X86_ACCEL
+
+#include <cpuid.h>
+
+// CPUID leaf 1 register bits
+#define ECX_SSSE3    (1u << 9)
+#define ECX_SSE4_1   (1u << 19)
+#define ECX_OSXSAVE  (1u << 27)
+#define ECX_AVX      (1u << 28)
+
+// CPUID leaf 7 register bits
+#define EBX_AVX2     (1u << 5)
+#define EBX_AVX512F  (1u << 16)
+#define EBX_SHA      (1u << 29)
+
+// XCR0 bits the OS sets when it saves the registers: SSE and AVX, plus the three AVX-512 parts
+#define XCR0_AVX     0x06u
+#define XCR0_AVX512  0xe6u
+
+
+// Cached feature bits
+#define HAS_SSSE3    (1u << 0)
+#define HAS_SHA_NI   (1u << 1)
+#define HAS_AVX2     (1u << 2)
+#define HAS_AVX512F  (1u << 3)
+#define HAS_CHECKED  (1u << 31)
+
+
+/*
+ * Callers may hash on several threads at once, each with its own sha256_ctx,
+ * so the cache is an atomic load and store rather than a plain static. The
+ * bits are only published once every leaf and XCR0 have been read.
+ */
+static unsigned int cpu_features(void){
+
+	static unsigned int features = 0;
+
+	unsigned int cached = __atomic_load_n(&features, __ATOMIC_ACQUIRE);
+	if(cached & HAS_CHECKED){
+		return cached;
+	}
+
+	unsigned int found = HAS_CHECKED;
+	unsigned int eax, ebx, ecx, edx;
+
+	if(__get_cpuid(1, &eax, &ebx, &ecx, &edx)){
+
+		unsigned int leaf_1_ecx = ecx;
+		unsigned int leaf_7_ebx = 0;
+		unsigned int xcr0 = 0;
+
+		if(__get_cpuid_max(0, NULL) >= 7){
+			__cpuid_count(7, 0, eax, ebx, ecx, edx);
+			leaf_7_ebx = ebx;
+		}
+
+		if(leaf_1_ecx & ECX_OSXSAVE){
+			unsigned int xcr0_hi;
+			__asm__ volatile("xgetbv" : "=a"(xcr0), "=d"(xcr0_hi) : "c"(0));
+		}
+
+		if(leaf_1_ecx & ECX_SSSE3){
+			found |= HAS_SSSE3;
+		}
+		if((leaf_7_ebx & EBX_SHA) && (leaf_1_ecx & ECX_SSSE3) && (leaf_1_ecx & ECX_SSE4_1)){
+			found |= HAS_SHA_NI;
+		}
+		if((leaf_1_ecx & ECX_AVX) && (xcr0 & XCR0_AVX) == XCR0_AVX && (leaf_7_ebx & EBX_AVX2)){
+			found |= HAS_AVX2;
+		}
+		if((leaf_1_ecx & ECX_AVX) && (xcr0 & XCR0_AVX512) == XCR0_AVX512 && (leaf_7_ebx & EBX_AVX512F)){
+			found |= HAS_AVX512F;
+		}
+	}
+
+	__atomic_store_n(&features, found, __ATOMIC_RELEASE);
+
+	return found;
+}
+
+
+bool sha_cpu_has_ssse3(void){
+	return (cpu_features() & HAS_SSSE3) != 0;
+}
+
+
+bool sha_cpu_has_sha_ni(void){
+	return (cpu_features() & HAS_SHA_NI) != 0;
+}
+
+
+bool sha_cpu_has_avx2(void){
+	return (cpu_features() & HAS_AVX2) != 0;
+}
+
+
+bool sha_cpu_has_avx512f(void){
+	return (cpu_features() & HAS_AVX512F) != 0;
+}
+
+#endif /* SHA_X86_ACCEL */
@@ -0,0 +1,44 @@
+/*
+ ============================================================================
+ Name        : sha_cpu_features.h
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : Runtime checks for optional x86 instruction set extensions.
+               Used to decide which SHA-256 backends can run on the current
+               CPU.
+ Note 1      : Named apart from the AES module's cpu_features.h, since both
+               modules are linked into the same programs.
+ ============================================================================
+ */
+
+#ifndef SHA_CPU_FEATURES_H_
+#define SHA_CPU_FEATURES_H_
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+#include <stdbool.h>
+#include "sha_256.h"
+
+#ifdef SHA_X86_ACCEL
+
+bool sha_cpu_has_ssse3(void);    // PSHUFB, PALIGNR
+
+bool sha_cpu_has_sha_ni(void);   // SHA256RNDS2 etc., with the SSSE3 and SSE4.1 shuffles used around them
+
+bool sha_cpu_has_avx2(void);     // 256-bit integer vectors, including OS support for saving them
+
+bool sha_cpu_has_avx512f(void);  // 512-bit integer vectors, including OS support for saving them
+
+#endif /* SHA_X86_ACCEL */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SHA_CPU_FEATURES_H_ */
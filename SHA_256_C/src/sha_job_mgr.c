@@ -0,0 +1,230 @@
+/*
+ ============================================================================
+ Name        : sha_job_mgr.c
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : Submit/flush job manager for multi-buffer SHA-256.
+ Note 1      : A job's work is its remaining full message blocks followed by
+               its one or two padded tail blocks. Bucket b holds the jobs with
+               b + 1 blocks left, up to the last bucket, which holds anything
+               longer.
+ Note 2      : A lane set runs until its shortest job finishes. Jobs from an
+               exact-count bucket all finish together, so no lane idles. Jobs
+               from the last bucket, or mixed together by a flush, go back
+               into the buckets with what they have left.
+ ============================================================================
+ */
+
+#include "sha_job_mgr.h"
+
+
+static inline uint64_t job_blocks_left(const sha256_job* job){
+	return job->blocks_left + job->tail_blocks;
+}
+
+
+static void queue_job(sha256_job_mgr* mgr, sha256_job* job){
+
+	uint64_t left = job_blocks_left(job);
+	uint8_t bucket = (left >= SHA_MGR_BUCKETS) ? SHA_MGR_BUCKETS - 1 : (uint8_t) (left - 1);
+
+	job->link = mgr->buckets[bucket];
+	mgr->buckets[bucket] = job;
+	mgr->bucket_len[bucket]++;
+	mgr->queued++;
+}
+
+
+static sha256_job* take_job(sha256_job_mgr* mgr, uint8_t bucket){
+
+	sha256_job* job = mgr->buckets[bucket];
+
+	mgr->buckets[bucket] = job->link;
+	mgr->bucket_len[bucket]--;
+	mgr->queued--;
+
+	return job;
+}
+
+
+static void complete_job(sha256_job* job){
+
+	for(uint8_t i = 0; i < NUM_TEMP_HASHES; i++){
+		word_to_bytes(job->hash_vals[i], &job->digest[i * 4]);
+	}
+
+	// The tail holds message bytes
+	memset(job->tail, 0, sizeof(job->tail));
+
+	if(job->callback != NULL){
+		job->callback(job);
+	}
+}
+
+
+// Moves a job past run blocks of its current segment
+static void advance_job(sha256_job* job, uint64_t run){
+
+	if(job->blocks_left > 0){
+		job->blocks_left -= run;
+		job->next = (job->blocks_left > 0) ? &job->next[run * SHA256_BLOCK_BYTES] : job->tail;
+	}
+	else{
+		job->tail_blocks -= (uint8_t) run;
+		job->next = &job->next[run * SHA256_BLOCK_BYTES];
+	}
+}
+
+
+// Runs one full set of lanes until its shortest job is done, then completes or requeues each job
+static void dispatch(sha256_job_mgr* mgr, sha256_job** jobs){
+
+	uint8_t lanes = mgr->lanes;
+	uint32_t hash_vals[NUM_TEMP_HASHES * SHA_MB_MAX_LANES];
+	const uint8_t* blocks[SHA_MB_MAX_LANES];
+
+	for(uint8_t l = 0; l < lanes; l++){
+		for(uint8_t i = 0; i < NUM_TEMP_HASHES; i++){
+			hash_vals[i * lanes + l] = jobs[l]->hash_vals[i];
+		}
+	}
+
+	bool any_done = false;
+	while(!any_done){
+
+		// Up to the next segment change in any lane
+		uint64_t run = UINT64_MAX;
+		for(uint8_t l = 0; l < lanes; l++){
+			uint64_t segment = (jobs[l]->blocks_left > 0) ? jobs[l]->blocks_left : jobs[l]->tail_blocks;
+			if(segment < run) run = segment;
+		}
+
+		for(uint8_t l = 0; l < lanes; l++){
+			blocks[l] = jobs[l]->next;
+		}
+
+		sha_mb_compress(hash_vals, blocks, lanes, run);
+
+		for(uint8_t l = 0; l < lanes; l++){
+			advance_job(jobs[l], run);
+			if(job_blocks_left(jobs[l]) == 0) any_done = true;
+		}
+	}
+
+	for(uint8_t l = 0; l < lanes; l++){
+
+		for(uint8_t i = 0; i < NUM_TEMP_HASHES; i++){
+			jobs[l]->hash_vals[i] = hash_vals[i * lanes + l];
+		}
+
+		if(job_blocks_left(jobs[l]) == 0){
+			complete_job(jobs[l]);
+		}
+		else{
+			queue_job(mgr, jobs[l]);
+		}
+	}
+}
+
+
+// Dispatches every bucket that holds a full set of lanes, including any refilled by requeued jobs
+static void dispatch_full_buckets(sha256_job_mgr* mgr){
+
+	sha256_job* jobs[SHA_MB_MAX_LANES];
+	bool dispatched = true;
+
+	while(dispatched){
+		dispatched = false;
+		for(uint8_t bucket = 0; bucket < SHA_MGR_BUCKETS; bucket++){
+			if(mgr->bucket_len[bucket] >= mgr->lanes){
+				for(uint8_t l = 0; l < mgr->lanes; l++){
+					jobs[l] = take_job(mgr, bucket);
+				}
+				dispatch(mgr, jobs);
+				dispatched = true;
+			}
+		}
+	}
+}
+
+
+// Finishes a job on the single stream backend
+static void finish_job(sha256_job* job){
+
+	if(job->blocks_left > 0){
+		compress_blocks(job->hash_vals, job->next, job->blocks_left);
+		job->blocks_left = 0;
+		job->next = job->tail;
+	}
+
+	compress_blocks(job->hash_vals, job->next, job->tail_blocks);
+	job->tail_blocks = 0;
+
+	complete_job(job);
+}
+
+
+uint32_t sha256_job_mgr_init(sha256_job_mgr* mgr){
+
+	if(mgr == NULL) return CTX_NULL_PTR_ERR;
+
+	memset(mgr, 0, sizeof(*mgr));
+	mgr->lanes = sha_mb_lanes();
+
+	return 0;
+}
+
+
+uint32_t sha256_job_mgr_submit(sha256_job_mgr* mgr, sha256_job* job){
+
+	if(mgr == NULL) return CTX_NULL_PTR_ERR;
+	if(job == NULL || (job->msg == NULL && job->len > 0)) return MSG_ARRAY_NULL_PTR_ERR;
+
+	const uint32_t initial_hash_vals[NUM_TEMP_HASHES] = {
+		0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+	};
+
+	memcpy(job->hash_vals, initial_hash_vals, sizeof(initial_hash_vals));
+	job->tail_blocks = sha_mb_pad_tail(job->tail, job->msg, job->len);
+	job->blocks_left = job->len / SHA256_BLOCK_BYTES;
+	job->next = (job->blocks_left > 0) ? job->msg : job->tail;
+
+	if(mgr->lanes == 1){
+		finish_job(job);
+		return 0;
+	}
+
+	queue_job(mgr, job);
+	dispatch_full_buckets(mgr);
+
+	return 0;
+}
+
+
+uint32_t sha256_job_mgr_flush(sha256_job_mgr* mgr){
+
+	if(mgr == NULL) return CTX_NULL_PTR_ERR;
+
+	sha256_job* jobs[SHA_MB_MAX_LANES];
+
+	// Shortest jobs first, so each mixed lane set is as even as the queue allows
+	while(mgr->queued >= mgr->lanes){
+		uint8_t bucket = 0;
+		for(uint8_t l = 0; l < mgr->lanes; l++){
+			while(mgr->bucket_len[bucket] == 0) bucket++;
+			jobs[l] = take_job(mgr, bucket);
+		}
+		dispatch(mgr, jobs);
+		dispatch_full_buckets(mgr);
+	}
+
+	for(uint8_t bucket = 0; bucket < SHA_MGR_BUCKETS; bucket++){
+		while(mgr->bucket_len[bucket] > 0){
+			finish_job(take_job(mgr, bucket));
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,95 @@
+/*
+ ============================================================================
+ Name        : sha_job_mgr.h
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : Submit/flush job manager for multi-buffer SHA-256. Jobs are
+               queued by the number of blocks they have left and dispatched
+               to the SIMD lanes (sha_mb.h) as soon as a full set of lanes has
+               the same amount of work. Results come back through a
+               completion callback on each job.
+ Note 1      : Jobs are owned by the caller and must stay valid, along with
+               their messages, until their callback has run. The manager
+               allocates nothing.
+ Note 2      : The manager is not thread safe. Use one per thread.
+ ============================================================================
+ */
+
+#ifndef SHA_JOB_MGR_H_
+#define SHA_JOB_MGR_H_
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sha_256.h"
+#include "sha_mb.h"
+
+#define SHA_MGR_BUCKETS  16  // Jobs with 1 to 15 blocks left queue by count; the last bucket holds the rest
+
+typedef struct sha256_job sha256_job;
+
+// Called once per job, when its digest is ready. The manager is done with the job by then,
+// so the callback may free it or refill it for a later submit.
+typedef void (*sha256_job_done)(sha256_job* job);
+
+struct sha256_job{
+
+	// Set by the caller before submitting
+	const uint8_t* msg;
+	size_t len;
+	sha256_job_done callback;
+	void* user_data;
+
+	// Written on completion, before the callback
+	uint8_t digest[SHA256_DIGEST_BYTES];
+
+	// Managed by the job manager
+	uint32_t hash_vals[NUM_TEMP_HASHES];
+	const uint8_t* next;
+	uint64_t blocks_left;
+	uint8_t tail[2 * SHA256_BLOCK_BYTES];
+	uint8_t tail_blocks;
+	sha256_job* link;
+};
+
+typedef struct{
+	uint8_t lanes;
+	sha256_job* buckets[SHA_MGR_BUCKETS];
+	uint32_t bucket_len[SHA_MGR_BUCKETS];
+	size_t queued;
+} sha256_job_mgr;
+
+
+// Sets up an empty manager for the lane count of the best backend (sha_mb_lanes())
+uint32_t sha256_job_mgr_init(sha256_job_mgr* mgr);
+
+/*
+ * Purpose : Queues a job. If that fills a bucket to the lane count, those
+ *           jobs are hashed right away; jobs left partly done are queued again
+ *           by what they have left, which can dispatch further lane sets.
+ *           Callbacks run from inside this call.
+ * Outputs : 0, or an error code from sha_256.h
+ * Notes   : Without vector lanes the job is hashed and completed immediately.
+ */
+uint32_t sha256_job_mgr_submit(sha256_job_mgr* mgr, sha256_job* job);
+
+/*
+ * Purpose : Completes every queued job. Full lane sets are still formed from
+ *           the shortest jobs across buckets while enough jobs are queued; the
+ *           remaining stragglers are finished one at a time on the single
+ *           stream backend.
+ */
+uint32_t sha256_job_mgr_flush(sha256_job_mgr* mgr);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SHA_JOB_MGR_H_ */
@@ -0,0 +1,414 @@
+/*
+ ============================================================================
+ Name        : sha_mb.c
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : Multi-buffer SHA-256. The working variables, message schedule
+               and hash values of each message sit in one 32-bit lane of a
+               vector, and every operation of a round is done for all lanes
+               with a single instruction.
+ Note 1      : Message words arrive one block per lane, so they are
+               transposed on load (an 8x8 word transpose per half block) to
+               put word i of every lane in one vector.
+ Note 2      : Functions are compiled with the target attribute, like
+               sha_ni.c, and only called when sha_cpu_features.c reports the
+               extension (CPUID, plus XGETBV for OS support of the wider
+               registers).
+ Note 3      : Lanes finish at different times. sha256_mb() runs all lanes for
+               the smallest number of blocks any lane has left, then refills
+               the lanes that are done. A lane with nothing left to hash
+               repeats another lane's blocks and its result is discarded.
+ ============================================================================
+ */
+
+#include "sha_mb.h"
+
+#ifdef SHA_X86_ACCEL
+
+#include <immintrin.h>
+#include "sha_cpu_features.h"
+
+#define SHA_MB_AVX2_TARGET    __attribute__((target("avx2")))
+#define SHA_MB_AVX512_TARGET  __attribute__((target("avx512f")))
+
+#endif /* SHA_X86_ACCEL */
+
+
+uint8_t sha_mb_lanes(void){
+
+#ifdef SHA_X86_ACCEL
+	if(sha_cpu_has_avx512f()) return 16;
+	if(sha_cpu_has_avx2()) return 8;
+#endif
+
+	return 1;
+}
+
+
+#ifdef SHA_X86_ACCEL
+
+/*
+ * Loads words 0-15 of one block from each of 8 lanes, byte swapped, into
+ * w[0..15] with lane l in element l. 8x8 transposes: unpacking 32-bit, then
+ * 64-bit pairs within each 128-bit half, then swapping halves across rows.
+ */
+static inline SHA_MB_AVX2_TARGET
+void load_words_x8(__m256i* w, const uint8_t* const* blocks, uint64_t offset){
+
+	const __m256i byte_swap = _mm256_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+	                                          12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+
+	for(uint8_t half = 0; half < 2; half++){
+
+		__m256i r[8];
+		for(uint8_t l = 0; l < 8; l++){
+			r[l] = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*) &blocks[l][offset + half * 32]), byte_swap);
+		}
+
+		__m256i t0 = _mm256_unpacklo_epi32(r[0], r[1]);
+		__m256i t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+		__m256i t2 = _mm256_unpacklo_epi32(r[2], r[3]);
+		__m256i t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+		__m256i t4 = _mm256_unpacklo_epi32(r[4], r[5]);
+		__m256i t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+		__m256i t6 = _mm256_unpacklo_epi32(r[6], r[7]);
+		__m256i t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+
+		__m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+		__m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+		__m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+		__m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+		__m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+		__m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+		__m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+		__m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+
+		__m256i* out = &w[half * 8];
+		out[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+		out[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+		out[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+		out[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+		out[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+		out[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+		out[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+		out[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+	}
+}
+
+
+// FIPS 180-4 functions on 8 lanes. AVX2 has no rotate, so ROTR is two shifts.
+#define ROTR_X8(x, n)    _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+#define SUM0_X8(x)       _mm256_xor_si256(_mm256_xor_si256(ROTR_X8(x, 2), ROTR_X8(x, 13)), ROTR_X8(x, 22))
+#define SUM1_X8(x)       _mm256_xor_si256(_mm256_xor_si256(ROTR_X8(x, 6), ROTR_X8(x, 11)), ROTR_X8(x, 25))
+#define SIGMA0_X8(x)     _mm256_xor_si256(_mm256_xor_si256(ROTR_X8(x, 7), ROTR_X8(x, 18)), _mm256_srli_epi32(x, 3))
+#define SIGMA1_X8(x)     _mm256_xor_si256(_mm256_xor_si256(ROTR_X8(x, 17), ROTR_X8(x, 19)), _mm256_srli_epi32(x, 10))
+#define CH_X8(x, y, z)   _mm256_xor_si256(_mm256_and_si256(x, y), _mm256_andnot_si256(x, z))
+#define MAJ_X8(x, y, z)  _mm256_xor_si256(_mm256_and_si256(x, y), _mm256_and_si256(z, _mm256_xor_si256(x, y)))
+
+
+static SHA_MB_AVX2_TARGET
+void compress_x8(uint32_t* hash_vals, const uint8_t* const* blocks, uint64_t num_blocks){
+
+	__m256i w[MSG_SCHED_LEN];
+	__m256i hv[NUM_TEMP_HASHES];
+
+	for(uint8_t i = 0; i < NUM_TEMP_HASHES; i++){
+		hv[i] = _mm256_loadu_si256((const __m256i*) &hash_vals[i * 8]);
+	}
+
+	for(uint64_t blk_num = 0; blk_num < num_blocks; blk_num++){
+
+		load_words_x8(w, blocks, blk_num * SHA256_BLOCK_BYTES);
+
+		// Same recurrence as create_msg_schedule()
+		for(uint8_t i = MSG_BLOCK_LEN; i < MSG_SCHED_LEN; i++){
+			w[i] = _mm256_add_epi32(_mm256_add_epi32(SIGMA1_X8(w[i - 2]), w[i - 7]),
+			                        _mm256_add_epi32(SIGMA0_X8(w[i - 15]), w[i - 16]));
+		}
+
+		__m256i a = hv[0], b = hv[1], c = hv[2], d = hv[3];
+		__m256i e = hv[4], f = hv[5], g = hv[6], h = hv[7];
+
+		for(uint8_t i = 0; i < MSG_SCHED_LEN; i++){
+
+			__m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, SUM1_X8(e)),
+			                              _mm256_add_epi32(CH_X8(e, f, g), _mm256_add_epi32(_mm256_set1_epi32((int) k_vals[i]), w[i])));
+			__m256i t2 = _mm256_add_epi32(SUM0_X8(a), MAJ_X8(a, b, c));
+
+			h = g;
+			g = f;
+			f = e;
+			e = _mm256_add_epi32(d, t1);
+			d = c;
+			c = b;
+			b = a;
+			a = _mm256_add_epi32(t1, t2);
+		}
+
+		hv[0] = _mm256_add_epi32(hv[0], a);
+		hv[1] = _mm256_add_epi32(hv[1], b);
+		hv[2] = _mm256_add_epi32(hv[2], c);
+		hv[3] = _mm256_add_epi32(hv[3], d);
+		hv[4] = _mm256_add_epi32(hv[4], e);
+		hv[5] = _mm256_add_epi32(hv[5], f);
+		hv[6] = _mm256_add_epi32(hv[6], g);
+		hv[7] = _mm256_add_epi32(hv[7], h);
+	}
+
+	for(uint8_t i = 0; i < NUM_TEMP_HASHES; i++){
+		_mm256_storeu_si256((__m256i*) &hash_vals[i * 8], hv[i]);
+	}
+}
+
+
+// The same on 16 lanes. AVX-512 has a rotate and a three-input logic instruction.
+#define SUM0_X16(x)       _mm512_xor_si512(_mm512_xor_si512(_mm512_ror_epi32(x, 2), _mm512_ror_epi32(x, 13)), _mm512_ror_epi32(x, 22))
+#define SUM1_X16(x)       _mm512_xor_si512(_mm512_xor_si512(_mm512_ror_epi32(x, 6), _mm512_ror_epi32(x, 11)), _mm512_ror_epi32(x, 25))
+#define SIGMA0_X16(x)     _mm512_xor_si512(_mm512_xor_si512(_mm512_ror_epi32(x, 7), _mm512_ror_epi32(x, 18)), _mm512_srli_epi32(x, 3))
+#define SIGMA1_X16(x)     _mm512_xor_si512(_mm512_xor_si512(_mm512_ror_epi32(x, 17), _mm512_ror_epi32(x, 19)), _mm512_srli_epi32(x, 10))
+#define CH_X16(x, y, z)   _mm512_ternarylogic_epi32(x, y, z, 0xca)  // x ? y : z
+#define MAJ_X16(x, y, z)  _mm512_ternarylogic_epi32(x, y, z, 0xe8)  // At least two of x, y, z
+
+
+static SHA_MB_AVX512_TARGET
+void compress_x16(uint32_t* hash_vals, const uint8_t* const* blocks, uint64_t num_blocks){
+
+	__m512i w[MSG_SCHED_LEN];
+	__m512i hv[NUM_TEMP_HASHES];
+
+	for(uint8_t i = 0; i < NUM_TEMP_HASHES; i++){
+		hv[i] = _mm512_loadu_si512((const void*) &hash_vals[i * 16]);
+	}
+
+	for(uint64_t blk_num = 0; blk_num < num_blocks; blk_num++){
+
+		// Two 8-lane transposes, joined into 16-lane vectors
+		__m256i low[MSG_BLOCK_LEN];
+		__m256i high[MSG_BLOCK_LEN];
+		load_words_x8(low, blocks, blk_num * SHA256_BLOCK_BYTES);
+		load_words_x8(high, &blocks[8], blk_num * SHA256_BLOCK_BYTES);
+
+		for(uint8_t i = 0; i < MSG_BLOCK_LEN; i++){
+			w[i] = _mm512_inserti64x4(_mm512_castsi256_si512(low[i]), high[i], 1);
+		}
+
+		for(uint8_t i = MSG_BLOCK_LEN; i < MSG_SCHED_LEN; i++){
+			w[i] = _mm512_add_epi32(_mm512_add_epi32(SIGMA1_X16(w[i - 2]), w[i - 7]),
+			                        _mm512_add_epi32(SIGMA0_X16(w[i - 15]), w[i - 16]));
+		}
+
+		__m512i a = hv[0], b = hv[1], c = hv[2], d = hv[3];
+		__m512i e = hv[4], f = hv[5], g = hv[6], h = hv[7];
+
+		for(uint8_t i = 0; i < MSG_SCHED_LEN; i++){
+
+			__m512i t1 = _mm512_add_epi32(_mm512_add_epi32(h, SUM1_X16(e)),
+			                              _mm512_add_epi32(CH_X16(e, f, g), _mm512_add_epi32(_mm512_set1_epi32((int) k_vals[i]), w[i])));
+			__m512i t2 = _mm512_add_epi32(SUM0_X16(a), MAJ_X16(a, b, c));
+
+			h = g;
+			g = f;
+			f = e;
+			e = _mm512_add_epi32(d, t1);
+			d = c;
+			c = b;
+			b = a;
+			a = _mm512_add_epi32(t1, t2);
+		}
+
+		hv[0] = _mm512_add_epi32(hv[0], a);
+		hv[1] = _mm512_add_epi32(hv[1], b);
+		hv[2] = _mm512_add_epi32(hv[2], c);
+		hv[3] = _mm512_add_epi32(hv[3], d);
+		hv[4] = _mm512_add_epi32(hv[4], e);
+		hv[5] = _mm512_add_epi32(hv[5], f);
+		hv[6] = _mm512_add_epi32(hv[6], g);
+		hv[7] = _mm512_add_epi32(hv[7], h);
+	}
+
+	for(uint8_t i = 0; i < NUM_TEMP_HASHES; i++){
+		_mm512_storeu_si512((void*) &hash_vals[i * 16], hv[i]);
+	}
+}
+
+#endif /* SHA_X86_ACCEL */
+
+
+void sha_mb_compress(uint32_t* hash_vals, const uint8_t* const* blocks, uint8_t lanes, uint64_t num_blocks){
+
+#ifdef SHA_X86_ACCEL
+	uint8_t vector_lanes = sha_mb_lanes();
+
+	if(lanes == 16 && vector_lanes == 16){
+		compress_x16(hash_vals, blocks, num_blocks);
+		return;
+	}
+
+	if(lanes == 8 && vector_lanes >= 8){
+		compress_x8(hash_vals, blocks, num_blocks);
+		return;
+	}
+#endif
+
+	// One lane at a time, on the single stream backend
+	for(uint8_t l = 0; l < lanes; l++){
+
+		uint32_t lane_vals[NUM_TEMP_HASHES];
+		for(uint8_t i = 0; i < NUM_TEMP_HASHES; i++){
+			lane_vals[i] = hash_vals[i * lanes + l];
+		}
+
+		compress_blocks(lane_vals, blocks[l], num_blocks);
+
+		for(uint8_t i = 0; i < NUM_TEMP_HASHES; i++){
+			hash_vals[i * lanes + l] = lane_vals[i];
+		}
+	}
+}
+
+
+typedef struct{
+	const uint8_t* next;                  // Next block to compress
+	uint64_t blocks_left;                 // Blocks left at next, before switching to the tail
+	uint8_t tail[2 * SHA256_BLOCK_BYTES]; // End of the message and the padding
+	uint8_t tail_blocks;
+	size_t msg;                           // Index of the message in this lane
+	bool active;
+} sha_mb_lane;
+
+
+uint8_t sha_mb_pad_tail(uint8_t* tail, const uint8_t* msg, size_t len){
+
+	size_t full_blocks = len / SHA256_BLOCK_BYTES;
+	size_t rest = len - (full_blocks * SHA256_BLOCK_BYTES);
+
+	memset(tail, 0, 2 * SHA256_BLOCK_BYTES);
+	if(rest > 0){
+		memcpy(tail, &msg[full_blocks * SHA256_BLOCK_BYTES], rest);
+	}
+	tail[rest] = 0x80;
+
+	uint8_t tail_blocks = (rest + 1 > SHA256_BLOCK_BYTES - 8) ? 2 : 1;
+
+	uint64_t total_msg_bits = (uint64_t) len * 8;
+	uint8_t* length_loc = &tail[(tail_blocks * SHA256_BLOCK_BYTES) - 8];
+	word_to_bytes((uint32_t) (total_msg_bits >> BITS_IN_WORD), length_loc);
+	word_to_bytes((uint32_t) total_msg_bits, &length_loc[4]);
+
+	return tail_blocks;
+}
+
+
+static void start_lane(sha_mb_lane* lane, const uint8_t* msg, size_t len, size_t msg_index){
+
+	size_t full_blocks = len / SHA256_BLOCK_BYTES;
+
+	lane->tail_blocks = sha_mb_pad_tail(lane->tail, msg, len);
+	lane->blocks_left = full_blocks;
+	lane->next = (full_blocks > 0) ? msg : lane->tail;
+	lane->msg = msg_index;
+	lane->active = true;
+}
+
+
+uint32_t sha256_mb(const uint8_t* const* msgs, const size_t* lens, uint8_t* digests, size_t num_msgs){
+
+	if(msgs == NULL || lens == NULL) return MSG_ARRAY_NULL_PTR_ERR;
+	if(digests == NULL) return OUTPUT_LOC_NULL_PTR_ERR;
+
+	for(size_t i = 0; i < num_msgs; i++){
+		if(msgs[i] == NULL && lens[i] > 0) return MSG_ARRAY_NULL_PTR_ERR;
+	}
+
+	uint8_t lanes = sha_mb_lanes();
+
+	// Nothing to gain from lanes for a single message
+	if(lanes == 1 || num_msgs == 1){
+		for(size_t i = 0; i < num_msgs; i++){
+			sha256_ctx ctx;
+			sha256_init(&ctx);
+			sha256_update(&ctx, msgs[i], lens[i]);
+			sha256_final(&ctx, &digests[i * SHA256_DIGEST_BYTES]);
+		}
+		return 0;
+	}
+
+	const uint32_t initial_hash_vals[NUM_TEMP_HASHES] = {
+		0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+	};
+
+	sha_mb_lane lane[SHA_MB_MAX_LANES];
+	uint32_t hash_vals[NUM_TEMP_HASHES * SHA_MB_MAX_LANES];
+	const uint8_t* blocks[SHA_MB_MAX_LANES];
+	size_t next_msg = 0;
+
+	for(uint8_t l = 0; l < lanes; l++){
+		lane[l].active = false;
+	}
+
+	while(true){
+
+		// Refill finished lanes
+		uint8_t active = 0;
+		for(uint8_t l = 0; l < lanes; l++){
+			if(!lane[l].active && next_msg < num_msgs){
+				start_lane(&lane[l], msgs[next_msg], lens[next_msg], next_msg);
+				for(uint8_t i = 0; i < NUM_TEMP_HASHES; i++){
+					hash_vals[i * lanes + l] = initial_hash_vals[i];
+				}
+				next_msg++;
+			}
+			if(lane[l].active) active++;
+		}
+
+		if(active == 0) break;
+
+		// Run every lane up to the next point where one of them changes segment
+		uint64_t run = UINT64_MAX;
+		const uint8_t* spare = NULL;
+		for(uint8_t l = 0; l < lanes; l++){
+			if(lane[l].active){
+				uint64_t left = (lane[l].blocks_left > 0) ? lane[l].blocks_left : lane[l].tail_blocks;
+				if(left < run){
+					run = left;
+					spare = lane[l].next;
+				}
+			}
+		}
+
+		for(uint8_t l = 0; l < lanes; l++){
+			blocks[l] = lane[l].active ? lane[l].next : spare;
+		}
+
+		sha_mb_compress(hash_vals, blocks, lanes, run);
+
+		for(uint8_t l = 0; l < lanes; l++){
+
+			if(!lane[l].active) continue;
+
+			if(lane[l].blocks_left > 0){
+				lane[l].blocks_left -= run;
+				lane[l].next = (lane[l].blocks_left > 0) ? &lane[l].next[run * SHA256_BLOCK_BYTES] : lane[l].tail;
+				continue;
+			}
+
+			lane[l].tail_blocks -= (uint8_t) run;
+			lane[l].next = &lane[l].next[run * SHA256_BLOCK_BYTES];
+
+			if(lane[l].tail_blocks == 0){
+				uint8_t* digest = &digests[lane[l].msg * SHA256_DIGEST_BYTES];
+				for(uint8_t i = 0; i < NUM_TEMP_HASHES; i++){
+					word_to_bytes(hash_vals[i * lanes + l], &digest[i * 4]);
+				}
+				lane[l].active = false;
+			}
+		}
+	}
+
+	// The tails hold message bytes
+	memset(lane, 0, sizeof(lane));
+
+	return 0;
+}
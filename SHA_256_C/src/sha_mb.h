@@ -0,0 +1,66 @@
+/*
+ ============================================================================
+ Name        : sha_mb.h
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : Multi-buffer SHA-256. Many independent messages are hashed
+               together, one per SIMD lane: 8 lanes with AVX2, 16 with
+               AVX-512. Each round of one message depends on the round
+               before, but the same round of eight messages does not.
+ ============================================================================
+ */
+
+#ifndef SHA_MB_H_
+#define SHA_MB_H_
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "sha_256.h"
+
+#define SHA_MB_MAX_LANES  16
+
+
+// Lanes the best available backend works on: 16 (AVX-512), 8 (AVX2) or 1 (one message at a time)
+uint8_t sha_mb_lanes(void);
+
+/*
+ * Purpose : Runs num_blocks compressions on each of lanes messages at once.
+ * Inputs  : hash_vals transposed, so word i of lane l is hash_vals[i * lanes + l].
+ *           blocks[l] points at the num_blocks consecutive blocks of lane l.
+ *           lanes is 16 or 8 for the vector backends (when sha_mb_lanes()
+ *           allows it); any other count is compressed one lane at a time.
+ */
+void sha_mb_compress(uint32_t* hash_vals, const uint8_t* const* blocks, uint8_t lanes, uint64_t num_blocks);
+
+/*
+ * Purpose : Builds the last one or two blocks of a message: the bytes after
+ *           its last whole block, then the padding sha256_final() would add.
+ * Inputs  : Message and its length, output location for two blocks
+ * Outputs : Number of tail blocks, 1 or 2
+ */
+uint8_t sha_mb_pad_tail(uint8_t* tail, const uint8_t* msg, size_t len);
+
+/*
+ * Purpose : Hashes num_msgs independent messages. Each lane takes the next
+ *           message as soon as its current one finishes, so messages of
+ *           different lengths keep the lanes busy.
+ * Inputs  : msgs[i] points at lens[i] bytes (may be NULL when lens[i] is 0),
+ *           digests receives 32 bytes per message, in order
+ * Outputs : 0, or an error code from sha_256.h
+ */
+uint32_t sha256_mb(const uint8_t* const* msgs, const size_t* lens, uint8_t* digests, size_t num_msgs);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SHA_MB_H_ */
@@ -0,0 +1,111 @@
+/*
+ ============================================================================
+ Name        : sha_ni.c
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : SHA-256 compression using the x86 SHA extensions. Each
+               SHA256RNDS2 does two rounds, and SHA256MSG1/SHA256MSG2 make four
+               message schedule words at a time.
+ Note 1      : Functions are compiled with the target attribute instead of
+               global -msha flags, so the rest of the module still runs on CPUs
+               without these instructions. Nothing here is called unless
+               sha_ni_supported() returned true.
+ Note 2      : SHA256RNDS2 keeps the working variables as ABEF and CDGH
+               rather than ABCD and EFGH, so the hash values are rearranged
+               once per call, not once per block.
+ ============================================================================
+ */
+
+#include "sha_ni.h"
+
+#ifdef SHA_X86_ACCEL
+
+#include <immintrin.h>
+#include "sha_cpu_features.h"
+
+#define SHA_NI_TARGET  __attribute__((target("sha,sse4.1,ssse3")))
+
+
+bool sha_ni_supported(void){
+	return sha_cpu_has_sha_ni();
+}
+
+
+// Four rounds on message words w (W[4i] to W[4i + 3]). SHA256RNDS2 takes W + K for its two rounds in the low half.
+#define QUAD_ROUND(i, w) \
+	msg = _mm_add_epi32(w, _mm_loadu_si128((const __m128i*) &k_vals[4 * (i)])); \
+	state1 = _mm_sha256rnds2_epu32(state1, state0, msg); \
+	state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0e))
+
+/*
+ * Replaces w0 = W[i-16..i-13] with W[i..i+3]. MSG1 adds sigma0 of the word
+ * after each, the ALIGNR picks out W[i-7..i-4], and MSG2 adds sigma1 of
+ * W[i-2] and W[i-1], including the two words it is making itself.
+ */
+#define NEXT_MSG(w0, w1, w2, w3) \
+	w0 = _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(w0, w1), _mm_alignr_epi8(w3, w2, 4)), w3)
+
+
+SHA_NI_TARGET
+void sha_ni_compress_blocks(uint32_t* hash_vals, const uint8_t* blocks, uint64_t num_blocks){
+
+	// Reverses the bytes of each word: message words are big-endian
+	const __m128i byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+	__m128i msg, w0, w1, w2, w3;
+
+	__m128i abcd = _mm_loadu_si128((const __m128i*) &hash_vals[0]);
+	__m128i efgh = _mm_loadu_si128((const __m128i*) &hash_vals[4]);
+
+	// ABCD/EFGH (A in the low lane) to ABEF/CDGH (A in the high lane)
+	__m128i cdab = _mm_shuffle_epi32(abcd, 0xb1);
+	efgh = _mm_shuffle_epi32(efgh, 0x1b);
+	__m128i state0 = _mm_alignr_epi8(cdab, efgh, 8);
+	__m128i state1 = _mm_blend_epi16(efgh, cdab, 0xf0);
+
+	for(uint64_t blk_num = 0; blk_num < num_blocks; blk_num++){
+
+		const uint8_t* block = &blocks[blk_num * SHA256_BLOCK_BYTES];
+		__m128i abef_save = state0;
+		__m128i cdgh_save = state1;
+
+		w0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) &block[0]), byte_swap);
+		w1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) &block[16]), byte_swap);
+		w2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) &block[32]), byte_swap);
+		w3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) &block[48]), byte_swap);
+
+		QUAD_ROUND(0, w0);
+		QUAD_ROUND(1, w1);
+		QUAD_ROUND(2, w2);
+		QUAD_ROUND(3, w3);
+
+		NEXT_MSG(w0, w1, w2, w3); QUAD_ROUND(4, w0);
+		NEXT_MSG(w1, w2, w3, w0); QUAD_ROUND(5, w1);
+		NEXT_MSG(w2, w3, w0, w1); QUAD_ROUND(6, w2);
+		NEXT_MSG(w3, w0, w1, w2); QUAD_ROUND(7, w3);
+		NEXT_MSG(w0, w1, w2, w3); QUAD_ROUND(8, w0);
+		NEXT_MSG(w1, w2, w3, w0); QUAD_ROUND(9, w1);
+		NEXT_MSG(w2, w3, w0, w1); QUAD_ROUND(10, w2);
+		NEXT_MSG(w3, w0, w1, w2); QUAD_ROUND(11, w3);
+		NEXT_MSG(w0, w1, w2, w3); QUAD_ROUND(12, w0);
+		NEXT_MSG(w1, w2, w3, w0); QUAD_ROUND(13, w1);
+		NEXT_MSG(w2, w3, w0, w1); QUAD_ROUND(14, w2);
+		NEXT_MSG(w3, w0, w1, w2); QUAD_ROUND(15, w3);
+
+		state0 = _mm_add_epi32(state0, abef_save);
+		state1 = _mm_add_epi32(state1, cdgh_save);
+	}
+
+	// Back to ABCD/EFGH
+	__m128i feba = _mm_shuffle_epi32(state0, 0x1b);
+	__m128i dchg = _mm_shuffle_epi32(state1, 0xb1);
+	abcd = _mm_blend_epi16(feba, dchg, 0xf0);
+	efgh = _mm_alignr_epi8(dchg, feba, 8);
+
+	_mm_storeu_si128((__m128i*) &hash_vals[0], abcd);
+	_mm_storeu_si128((__m128i*) &hash_vals[4], efgh);
+}
+
+#endif /* SHA_X86_ACCEL */
@@ -0,0 +1,41 @@
+/*
+ ============================================================================
+ Name        : sha_ni.h
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : SHA-256 compression using the x86 SHA extensions (SHA256RNDS2,
+               SHA256MSG1, SHA256MSG2). Only built when SHA_X86_ACCEL is
+               defined, and only used when CPUID reports SHA support.
+ ============================================================================
+ */
+
+#ifndef SHA_NI_H_
+#define SHA_NI_H_
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sha_256.h"
+
+#ifdef SHA_X86_ACCEL
+
+// Checks CPUID for the SHA instructions and the SSSE3/SSE4.1 shuffles they are used with
+bool sha_ni_supported(void);
+
+// Same contract as compress_blocks(). The hash values stay in registers across all the blocks.
+void sha_ni_compress_blocks(uint32_t* hash_vals, const uint8_t* blocks, uint64_t num_blocks);
+
+#endif /* SHA_X86_ACCEL */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SHA_NI_H_ */
@@ -0,0 +1,119 @@
+/*
+ ============================================================================
+ Name        : sha_sse.c
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : SHA-256 compression with a vectorized message schedule. Each
+               step makes W[i..i+3] from the previous 16 words held in four
+               SSE registers, and stores W + K, so every round reads one
+               precomputed word.
+ Note 1      : W[i+2] and W[i+3] need sigma1 of W[i] and W[i+1] from the same
+               step, so sigma1 is applied twice per step: first to W[i-2] and
+               W[i-1] for the low half, then to the new low half for the high.
+ Note 2      : The rounds stay scalar. Each one depends on the one before, so
+               only the schedule has four independent words to work on.
+ Note 3      : Compiled with the target attribute, like sha_ni.c.
+ ============================================================================
+ */
+
+#include "sha_sse.h"
+
+#ifdef SHA_X86_ACCEL
+
+#include <immintrin.h>
+#include "sha_cpu_features.h"
+
+#define SHA_SSE_TARGET  __attribute__((target("ssse3")))
+
+
+bool sha_sse_supported(void){
+	return sha_cpu_has_ssse3();
+}
+
+
+// SSE has no rotate, so ROTR is two shifts
+#define ROTR_X4(x, n)  _mm_or_si128(_mm_srli_epi32(x, n), _mm_slli_epi32(x, 32 - (n)))
+#define SIGMA0_X4(x)   _mm_xor_si128(_mm_xor_si128(ROTR_X4(x, 7), ROTR_X4(x, 18)), _mm_srli_epi32(x, 3))
+#define SIGMA1_X4(x)   _mm_xor_si128(_mm_xor_si128(ROTR_X4(x, 17), ROTR_X4(x, 19)), _mm_srli_epi32(x, 10))
+
+/*
+ * x0..x3 hold W[i-16..i-1]. Replaces x0 with W[i..i+3] and stores W + K for
+ * those words. x3's top half (W[i-2], W[i-1]) is moved to the bottom for the
+ * first sigma1, and the new bottom half is moved to the top for the second.
+ */
+#define SCHEDULE_X4(i, x0, x1, x2, x3) \
+	x0 = _mm_add_epi32(_mm_add_epi32(x0, SIGMA0_X4(_mm_alignr_epi8(x1, x0, 4))), _mm_alignr_epi8(x3, x2, 4)); \
+	x0 = _mm_add_epi32(x0, _mm_and_si128(SIGMA1_X4(_mm_shuffle_epi32(x3, 0xfe)), low_half)); \
+	x0 = _mm_add_epi32(x0, _mm_and_si128(SIGMA1_X4(_mm_shuffle_epi32(x0, 0x40)), high_half)); \
+	_mm_store_si128((__m128i*) &wk[i], _mm_add_epi32(x0, _mm_loadu_si128((const __m128i*) &k_vals[i])))
+
+
+static inline uint32_t rotr(uint32_t x, unsigned n){
+	return (x >> n) | (x << (32 - n));
+}
+
+
+SHA_SSE_TARGET
+void sha_sse_compress_blocks(uint32_t* hash_vals, const uint8_t* blocks, uint64_t num_blocks){
+
+	// Reverses the bytes of each word: message words are big-endian
+	const __m128i byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+	const __m128i low_half = _mm_set_epi32(0, 0, -1, -1);
+	const __m128i high_half = _mm_set_epi32(-1, -1, 0, 0);
+
+	uint32_t wk[MSG_SCHED_LEN] __attribute__((aligned(16)));
+
+	for(uint64_t blk_num = 0; blk_num < num_blocks; blk_num++){
+
+		const uint8_t* block = &blocks[blk_num * SHA256_BLOCK_BYTES];
+
+		__m128i x0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) &block[0]), byte_swap);
+		__m128i x1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) &block[16]), byte_swap);
+		__m128i x2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) &block[32]), byte_swap);
+		__m128i x3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) &block[48]), byte_swap);
+
+		_mm_store_si128((__m128i*) &wk[0], _mm_add_epi32(x0, _mm_loadu_si128((const __m128i*) &k_vals[0])));
+		_mm_store_si128((__m128i*) &wk[4], _mm_add_epi32(x1, _mm_loadu_si128((const __m128i*) &k_vals[4])));
+		_mm_store_si128((__m128i*) &wk[8], _mm_add_epi32(x2, _mm_loadu_si128((const __m128i*) &k_vals[8])));
+		_mm_store_si128((__m128i*) &wk[12], _mm_add_epi32(x3, _mm_loadu_si128((const __m128i*) &k_vals[12])));
+
+		for(uint8_t i = MSG_BLOCK_LEN; i < MSG_SCHED_LEN; i += 16){
+			SCHEDULE_X4(i, x0, x1, x2, x3);
+			SCHEDULE_X4(i + 4, x1, x2, x3, x0);
+			SCHEDULE_X4(i + 8, x2, x3, x0, x1);
+			SCHEDULE_X4(i + 12, x3, x0, x1, x2);
+		}
+
+		uint32_t a = hash_vals[0], b = hash_vals[1], c = hash_vals[2], d = hash_vals[3];
+		uint32_t e = hash_vals[4], f = hash_vals[5], g = hash_vals[6], h = hash_vals[7];
+
+		// Same rounds as compress_blocks_portable(), with K already in the schedule
+		for(uint8_t i = 0; i < MSG_SCHED_LEN; i++){
+
+			uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + wk[i];
+			uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+
+			h = g;
+			g = f;
+			f = e;
+			e = d + t1;
+			d = c;
+			c = b;
+			b = a;
+			a = t1 + t2;
+		}
+
+		hash_vals[0] += a;
+		hash_vals[1] += b;
+		hash_vals[2] += c;
+		hash_vals[3] += d;
+		hash_vals[4] += e;
+		hash_vals[5] += f;
+		hash_vals[6] += g;
+		hash_vals[7] += h;
+	}
+}
+
+#endif /* SHA_X86_ACCEL */
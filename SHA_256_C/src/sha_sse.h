@@ -0,0 +1,42 @@
+/*
+ ============================================================================
+ Name        : sha_sse.h
+ Author      : NEOlson
+ Version     : 1
+ Copyright   : N/A
+ Date        : Oct 17, 2026
+ Description : The portable SHA-256 compressor with its message schedule
+               computed four words at a time in SSE registers. Used on x86
+               CPUs without the SHA instructions. Only built when
+               SHA_X86_ACCEL is defined.
+ ============================================================================
+ */
+
+#ifndef SHA_SSE_H_
+#define SHA_SSE_H_
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sha_256.h"
+
+#ifdef SHA_X86_ACCEL
+
+// Checks CPUID for SSSE3 (PSHUFB, PALIGNR)
+bool sha_sse_supported(void);
+
+// Same contract as compress_blocks()
+void sha_sse_compress_blocks(uint32_t* hash_vals, const uint8_t* blocks, uint64_t num_blocks);
+
+#endif /* SHA_X86_ACCEL */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SHA_SSE_H_ */
@@ -14,18 +14,35 @@
 #include "sha_256.h"
 #include "pre_hash_funcs.h"
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
 #include "math_funcs.h"
+#include "hash_funcs.h"
+#include "sha_ni.h"
+#include "sha_sse.h"
+#include "sha_mb.h"
+#include "sha_job_mgr.h"
+#include <time.h>
 
 
-void test_padding(void);
 void test_sha(void);
+void test_sha_stream(void);
+void test_compress_backends(void);
+void test_sha_mb(void);
+void test_sha_job_mgr(void);
+void test_sha_speed(void);
 void test_math(void);
 void test_k(void);
 
 int main(){
 
-	// test_padding();
 	test_sha();
+	test_sha_stream();
+	test_compress_backends();
+	test_sha_mb();
+	test_sha_job_mgr();
+
+	//test_sha_speed();
 
 	//test_math();
 	//test_k();
@@ -33,25 +50,6 @@ int main(){
 	return 0;
 }
 
-void test_padding(void){
-
-	uint64_t msg_len = 13;
-
-	uint64_t pad_amt = 16 - (msg_len % 16);
-	//pad_amt = 18;
-	uint32_t* pad_array = pad_msg(pad_amt, msg_len);
-
-	printf("Pad Length = %d\n", pad_amt);
-
-	for (int i =0; i < pad_amt; i++){
-		printf("0x%x ", pad_array[i]);
-	}
-
-	printf("\n%x",msg_len * 32);
-
-}
-
-
 void test_sha(void){
 
 	uint64_t msg_len = 15;
@@ -69,7 +67,319 @@ void test_sha(void){
 	for(uint32_t i = 0; i < 8; i++ ){
 		printf("0x%x ",out_loc[i]);
 	}
+	printf("\n");
+
+}
+
+
+void test_sha_stream(void){
+
+	// FIPS 180-4 example messages, plus the empty message
+	const char* msgs[3] = {
+		"",
+		"abc",
+		"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"  // 56 bytes, so the pad needs a second block
+	};
+
+	const uint8_t expected[4][SHA256_DIGEST_BYTES] = {
+		{0xe3, 0xb0, 0xc4, 0x42, 0x98, 0xfc, 0x1c, 0x14, 0x9a, 0xfb, 0xf4, 0xc8, 0x99, 0x6f, 0xb9, 0x24,
+		 0x27, 0xae, 0x41, 0xe4, 0x64, 0x9b, 0x93, 0x4c, 0xa4, 0x95, 0x99, 0x1b, 0x78, 0x52, 0xb8, 0x55},
+		{0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+		 0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad},
+		{0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8, 0xe5, 0xc0, 0x26, 0x93, 0x0c, 0x3e, 0x60, 0x39,
+		 0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67, 0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1},
+		// One million 'a'
+		{0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92, 0x81, 0xa1, 0xc7, 0xe2, 0x84, 0xd7, 0x3e, 0x67,
+		 0xf1, 0x80, 0x9a, 0x48, 0xa4, 0x97, 0x20, 0x0e, 0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11, 0x2c, 0xd0}
+	};
+
+	sha256_ctx ctx;
+	uint8_t digest[SHA256_DIGEST_BYTES];
+
+	for(int m = 0; m < 3; m++){
+
+		size_t len = strlen(msgs[m]);
+		int failures = 0;
+
+		// Whole message in one update, then a byte at a time
+		sha256_init(&ctx);
+		sha256_update(&ctx, (const uint8_t*) msgs[m], len);
+		sha256_final(&ctx, digest);
+		if(memcmp(digest, expected[m], SHA256_DIGEST_BYTES) != 0) failures++;
+
+		sha256_init(&ctx);
+		for(size_t i = 0; i < len; i++){
+			sha256_update(&ctx, (const uint8_t*) &msgs[m][i], 1);
+		}
+		sha256_final(&ctx, digest);
+		if(memcmp(digest, expected[m], SHA256_DIGEST_BYTES) != 0) failures++;
+
+		printf("SHA-256 stream, %d-byte message: %s\n", (int) len, (failures == 0) ? "PASS" : "FAIL");
+	}
+
+	// Chunks of 1 to 100 bytes, so updates start and end at every offset within a block
+	uint8_t chunk[100];
+	memset(chunk, 'a', sizeof(chunk));
+
+	sha256_init(&ctx);
+	size_t remaining = 1000000;
+	for(size_t size = 1; remaining > 0; size = (size % 100) + 1){
+		if(size > remaining) size = remaining;
+		sha256_update(&ctx, chunk, size);
+		remaining -= size;
+	}
+	sha256_final(&ctx, digest);
+
+	printf("SHA-256 stream, one million 'a' in uneven chunks: %s\n",
+			(memcmp(digest, expected[3], SHA256_DIGEST_BYTES) == 0) ? "PASS" : "FAIL");
+}
+
+
+// Every backend the CPU supports must match the portable code, for one block and for several per call
+void test_compress_backends(void){
+
+	uint8_t blocks[9 * SHA256_BLOCK_BYTES];
+	uint32_t seed = 1;
+	for(uint32_t i = 0; i < sizeof(blocks); i++){
+		seed = seed * 1103515245u + 12345u;
+		blocks[i] = (uint8_t) (seed >> 16);
+	}
+
+	uint32_t portable[NUM_TEMP_HASHES] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+	uint32_t dispatched[NUM_TEMP_HASHES];
+	memcpy(dispatched, portable, sizeof(portable));
+
+	int failures = 0;
+	uint32_t offset = 0;
+	for(uint32_t num_blocks = 1; num_blocks <= 3; num_blocks++){
+		compress_blocks_portable(portable, &blocks[offset], num_blocks);
+		compress_blocks(dispatched, &blocks[offset], num_blocks);
+		if(memcmp(portable, dispatched, sizeof(portable)) != 0) failures++;
+		offset += num_blocks * SHA256_BLOCK_BYTES;
+	}
+
+#ifdef SHA_X86_ACCEL
+	// The vectorized schedule variant, whichever backend the dispatcher picked
+	if(sha_sse_supported()){
+		uint32_t portable_vals[NUM_TEMP_HASHES] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+		uint32_t sse_vals[NUM_TEMP_HASHES];
+		memcpy(sse_vals, portable_vals, sizeof(portable_vals));
+
+		compress_blocks_portable(portable_vals, blocks, 9);
+		sha_sse_compress_blocks(sse_vals, blocks, 9);
+
+		printf("SHA-256 compress (SSE schedule) matches portable: %s\n",
+				(memcmp(portable_vals, sse_vals, sizeof(sse_vals)) == 0) ? "PASS" : "FAIL");
+	}
+#endif
+
+	const char* backend = "portable";
+#ifdef SHA_X86_ACCEL
+	if(sha_ni_supported()) backend = "SHA-NI";
+#endif
+
+	printf("SHA-256 compress (%s) matches portable: %s\n", backend, (failures == 0) ? "PASS" : "FAIL");
+}
+
+
+void test_sha_mb(void){
+
+	// Every length from 0 to 199 bytes, so lanes pad and finish at different blocks, plus one long message
+	enum{num_msgs = 201, long_len = 5000};
+	static uint8_t data[long_len];
+	static uint8_t mb_digests[num_msgs * SHA256_DIGEST_BYTES];
+	const uint8_t* msgs[num_msgs];
+	size_t lens[num_msgs];
+
+	for(uint32_t i = 0; i < long_len; i++){
+		data[i] = (uint8_t) (i * 31 + 7);
+	}
+
+	for(uint32_t i = 0; i < num_msgs; i++){
+		msgs[i] = &data[i];
+		lens[i] = (i == 100) ? long_len - 100 : (i * 37) % 200;
+	}
+	msgs[0] = NULL;
+	lens[0] = 0;
+
+	int failures = 0;
+	if(sha256_mb(msgs, lens, mb_digests, num_msgs) != 0) failures++;
+
+	for(uint32_t i = 0; i < num_msgs; i++){
+		sha256_ctx ctx;
+		uint8_t digest[SHA256_DIGEST_BYTES];
+		sha256_init(&ctx);
+		sha256_update(&ctx, msgs[i], lens[i]);
+		sha256_final(&ctx, digest);
+		if(memcmp(digest, &mb_digests[i * SHA256_DIGEST_BYTES], SHA256_DIGEST_BYTES) != 0) failures++;
+	}
+
+	printf("SHA-256 multi-buffer (%d lanes) matches single stream: %s\n", sha_mb_lanes(), (failures == 0) ? "PASS" : "FAIL");
+
+	// The 8 lane backend directly, which a 16 lane CPU would not otherwise use
+	uint32_t vector_vals[NUM_TEMP_HASHES * 8];
+	uint32_t scalar_vals[NUM_TEMP_HASHES];
+	const uint8_t* blocks[8];
+	for(uint8_t l = 0; l < 8; l++){
+		blocks[l] = &data[l * 3 * SHA256_BLOCK_BYTES + l];
+		for(uint8_t i = 0; i < NUM_TEMP_HASHES; i++){
+			vector_vals[i * 8 + l] = l + i;
+		}
+	}
+
+	failures = 0;
+	sha_mb_compress(vector_vals, blocks, 8, 3);
+	for(uint8_t l = 0; l < 8; l++){
+		for(uint8_t i = 0; i < NUM_TEMP_HASHES; i++){
+			scalar_vals[i] = l + i;
+		}
+		compress_blocks_portable(scalar_vals, blocks[l], 3);
+		for(uint8_t i = 0; i < NUM_TEMP_HASHES; i++){
+			if(scalar_vals[i] != vector_vals[i * 8 + l]) failures++;
+		}
+	}
+
+	printf("SHA-256 8 lane compress matches portable: %s\n", (failures == 0) ? "PASS" : "FAIL");
+}
+
+
+static int jobs_done;
+static int job_failures;
+
+static void check_job(sha256_job* job){
+
+	sha256_ctx ctx;
+	uint8_t digest[SHA256_DIGEST_BYTES];
+	sha256_init(&ctx);
+	sha256_update(&ctx, job->msg, job->len);
+	sha256_final(&ctx, digest);
+
+	if(memcmp(digest, job->digest, SHA256_DIGEST_BYTES) != 0) job_failures++;
+	jobs_done++;
+}
+
+
+void test_sha_job_mgr(void){
+
+	enum{num_jobs = 300};
+	static uint8_t data[4096];
+	static sha256_job jobs[num_jobs];
+
+	for(uint32_t i = 0; i < sizeof(data); i++){
+		data[i] = (uint8_t) (i * 17 + 3);
+	}
+
+	// The CPU's lane count, then 8 lanes through the same manager
+	uint8_t lane_counts[2] = {sha_mb_lanes(), 8};
+
+	for(int run = 0; run < 2; run++){
+
+		sha256_job_mgr mgr;
+		sha256_job_mgr_init(&mgr);
+		mgr.lanes = lane_counts[run];
+
+		jobs_done = 0;
+		job_failures = 0;
+
+		// Mostly short records with a few long ones, so buckets fill, overflow and straggle
+		for(uint32_t i = 0; i < num_jobs; i++){
+			jobs[i].msg = &data[i % 64];
+			jobs[i].len = (i % 50 == 0) ? 3000 + i : (i * 53) % 400;
+			jobs[i].callback = check_job;
+			sha256_job_mgr_submit(&mgr, &jobs[i]);
+		}
+
+		int done_before_flush = jobs_done;
+		sha256_job_mgr_flush(&mgr);
+
+		bool passed = (job_failures == 0) && (jobs_done == num_jobs) && (mgr.queued == 0);
+		printf("SHA-256 job manager, %d lanes (%d of %d done before flush): %s\n",
+				mgr.lanes, done_before_flush, num_jobs, passed ? "PASS" : "FAIL");
+	}
+}
+
+
+void test_sha_speed(void){
+
+	enum{test_bytes = 1 << 20, test_runs = 16};
+	static uint8_t data[test_bytes];
+	uint32_t hash_vals[NUM_TEMP_HASHES] = {0};
+
+	clock_t start = clock();
+	for(int run = 0; run < test_runs; run++){
+		compress_blocks_portable(hash_vals, data, test_bytes / SHA256_BLOCK_BYTES);
+	}
+	double portable_secs = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	for(int run = 0; run < test_runs; run++){
+		compress_blocks(hash_vals, data, test_bytes / SHA256_BLOCK_BYTES);
+	}
+	double dispatched_secs = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+	double sse_secs = 0;
+#ifdef SHA_X86_ACCEL
+	if(sha_sse_supported()){
+		start = clock();
+		for(int run = 0; run < test_runs; run++){
+			sha_sse_compress_blocks(hash_vals, data, test_bytes / SHA256_BLOCK_BYTES);
+		}
+		sse_secs = (double) (clock() - start) / CLOCKS_PER_SEC;
+	}
+#endif
+
+	double mbytes = (double) test_bytes * test_runs / 1e6;
+	if(sse_secs > 0){
+		printf("SHA-256 SSE schedule: %.1f MB/s\n", mbytes / sse_secs);
+	}
+	printf("SHA-256 portable: %.1f MB/s, dispatched: %.1f MB/s (%.1fx)\n",
+			mbytes / portable_secs, mbytes / dispatched_secs, portable_secs / dispatched_secs);
+
+	// Many small records: one at a time against the lanes
+	enum{record_bytes = 256, num_records = test_bytes / record_bytes};
+	static const uint8_t* records[num_records];
+	static size_t record_lens[num_records];
+	static uint8_t digests[num_records * SHA256_DIGEST_BYTES];
+	for(int i = 0; i < num_records; i++){
+		records[i] = &data[i * record_bytes];
+		record_lens[i] = record_bytes;
+	}
+
+	start = clock();
+	for(int run = 0; run < test_runs; run++){
+		for(int i = 0; i < num_records; i++){
+			sha256_ctx ctx;
+			sha256_init(&ctx);
+			sha256_update(&ctx, records[i], record_lens[i]);
+			sha256_final(&ctx, &digests[i * SHA256_DIGEST_BYTES]);
+		}
+	}
+	double single_secs = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	for(int run = 0; run < test_runs; run++){
+		sha256_mb(records, record_lens, digests, num_records);
+	}
+	double mb_secs = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+	static sha256_job jobs[num_records];
+	sha256_job_mgr mgr;
+	sha256_job_mgr_init(&mgr);
+
+	start = clock();
+	for(int run = 0; run < test_runs; run++){
+		for(int i = 0; i < num_records; i++){
+			jobs[i].msg = records[i];
+			jobs[i].len = record_lens[i];
+			jobs[i].callback = NULL;
+			sha256_job_mgr_submit(&mgr, &jobs[i]);
+		}
+		sha256_job_mgr_flush(&mgr);
+	}
+	double mgr_secs = (double) (clock() - start) / CLOCKS_PER_SEC;
 
+	printf("SHA-256 %d-byte records, one at a time: %.1f MB/s, %d lanes: %.1f MB/s, job manager: %.1f MB/s\n",
+			record_bytes, mbytes / single_secs, sha_mb_lanes(), mbytes / mb_secs, mbytes / mgr_secs);
 }
 
 
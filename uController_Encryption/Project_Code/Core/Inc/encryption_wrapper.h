@@ -11,6 +11,8 @@
 
 
 #include "aes_encryption.h" 
+#include "aes_cbc.h" 
+#include "aes_ccm.h" 
 #include "sha_256.h" 
 #include "string.h"
 #include "flash_manager.h"
@@ -35,7 +37,23 @@ typedef struct{
 	
 } cipher_process_msg;
 
-cipher_process_msg run_sha_and_aes(cipher_process process, uint32_t* password, uint8_t* msg_contents, uint8_t pswd_len_words, uint32_t msg_len_bytes);
+typedef enum{cipher_cbc_cs3, cipher_ccm} cipher_mode; 
+
+// Nonce and tag kept with each stored message (see write_msg_auth()). The tag is only used by AES-CCM. 
+typedef struct{ 
+	
+	uint8_t nonce[MSG_NONCE_LEN]; 
+	uint8_t tag[MSG_TAG_LEN]; 
+	
+} cipher_msg_auth;
+
+// Both modes take a fresh nonce from new_msg_nonce() when encrypting, and need the message's stored nonce to decrypt. 
+// cipher_cbc_cs3: AES-256 CBC with ciphertext stealing (CS3), no tag. The ciphertext is MSG_STORED_LEN(msg_len_bytes) 
+// bytes, which msg_contents must hold. The IV is the nonce (zero padded to a block) encrypted under the key 
+// (NIST SP 800-38A appendix C), so equal messages give different ciphertext. 
+// cipher_ccm: AES-256 CCM over exactly msg_len_bytes. Encryption also fills in the tag, 
+// decryption checks the tag and fails (leaving the message zeroed) if the message was changed. 
+cipher_process_msg run_sha_and_aes(cipher_process process, uint32_t* password, uint8_t* msg_contents, uint8_t pswd_len_words, uint32_t msg_len_bytes, cipher_mode mode, cipher_msg_auth* msg_auth);
 
 
 #ifdef __cplusplus
@@ -28,8 +28,14 @@
 #define NUM_MSGS         10
 #define MSG_LEN_BYTES    256
 #define MSG_TITLE_LEN    16
+#define MSG_NONCE_LEN    12   // Per-message nonce (AES-CCM nonce or CBC-CS3 IV seed), stored next to msg_lengths
+#define MSG_TAG_LEN      8    // Per-message AES-CCM tag
+#define MSG_MIN_STORED_LEN  16   // One AES block. CBC-CS3 pads shorter messages to this.
 #define FLASH_BASE_ADDR  0x08020000  // Start of flash Sector 5, 128KB
 
+// Bytes a message of msg_len takes in flash. Messages are packed by this, not by MSG_LEN_BYTES.
+#define MSG_STORED_LEN(msg_len)     (((msg_len) > 0 && (msg_len) < MSG_MIN_STORED_LEN) ? MSG_MIN_STORED_LEN : (msg_len))
+
 #define MSG(msg_num)                (0x00000001 << msg_num) 
 
 #define MSG_MARK_VALID(valid_bits, msg_num)  (valid_bits ^= msg_num)
@@ -61,9 +67,15 @@ flash_status_msg save_state_in_flash(void);
 // Functions fetching or modifying encrypted messages in RAM
 void get_encrypted_msg(uint8_t msg_num, uint8_t* msg_save_loc, uint32_t* msg_len_save_loc);
 void get_msg_title(uint8_t msg_num, char* msg_title_save_loc);
+// new_msg_loc must hold MSG_STORED_LEN(msg_len) bytes
 msg_write_status write_message(uint8_t msg_num, char* new_title_loc, uint8_t* new_msg_loc, uint8_t msg_title_len, uint32_t msg_len);
 void delete_message(uint8_t msg_num);
 
+// Functions for the nonce (both modes) and tag (AES-CCM) of stored messages
+void new_msg_nonce(uint8_t* nonce_save_loc);
+void get_msg_auth(uint8_t msg_num, uint8_t* nonce_save_loc, uint8_t* tag_save_loc);
+void write_msg_auth(uint8_t msg_num, const uint8_t* nonce, const uint8_t* tag);
+
 
 #ifdef __cplusplus
 }
@@ -16,7 +16,7 @@
 #include "encryption_wrapper.h" 
 
 
-cipher_process_msg run_sha_and_aes(cipher_process process, uint32_t* password, uint8_t* msg_contents, uint8_t pswd_len_words, uint32_t msg_len_bytes){
+cipher_process_msg run_sha_and_aes(cipher_process process, uint32_t* password, uint8_t* msg_contents, uint8_t pswd_len_words, uint32_t msg_len_bytes, cipher_mode mode, cipher_msg_auth* msg_auth){
 
 	cipher_process_msg status_out;
 	
@@ -55,33 +55,84 @@ cipher_process_msg run_sha_and_aes(cipher_process process, uint32_t* password, u
 		return status_out;
 	}
 	
+	if(msg_auth == NULL){
+		status_out.status = (process == encrypt) ? encryption_failed : decryption_failed; 
+		strcpy(status_out.msg, (process == encrypt) ? "ENCRYPTION FAILED - NO NONCE" : "DECRYPTION FAILED - NO NONCE"); 
+		return status_out; 
+	}
 	
-	uint32_t cipher_key_words[AES_KEY_LEN_WORDS] = {0}; 
-	use_sha_256(password, pswd_len_words, cipher_key_words); 
+	if(process == encrypt){
+		new_msg_nonce(msg_auth->nonce); 
+	}
 	
-	uint8_t cipher_key_bytes[AES_KEY_LEN_BYTES]; 
-	for(uint32_t word = 0; word < AES_KEY_LEN_WORDS; word++){
-		
-		for(int byte = MSB; byte >= 0; byte--){
-			cipher_key_bytes[(word * BYTES_IN_WORD) + byte] = (uint8_t) (cipher_key_words[word] >> (BITS_IN_BYTE * byte));
-		}
-	} 
 	
-	for(uint8_t word; word < AES_KEY_LEN_WORDS; word++){
-		cipher_key_words[word] = 0; 
+	// Password words are hashed most significant byte first, as use_sha_256() reads them, 
+	// so the key does not depend on the CPU's byte order. The digest is the key. 
+	uint8_t cipher_key[AES_KEY_LEN_BYTES]; 
+	uint8_t pswd_bytes[PSWD_WORD_LIMIT * BYTES_IN_WORD]; 
+	for(uint32_t word = 0; word < pswd_len_words; word++){
+		word_to_bytes(password[word], &pswd_bytes[word * BYTES_IN_WORD]); 
 	}
-	 
-	uint32_t data_16_byte_blocks = (msg_len_bytes / AES_INPUT_BLOCK_SIZE);
 	
-	if(msg_len_bytes % AES_INPUT_BLOCK_SIZE != 0){
-		data_16_byte_blocks++; 
+	sha256_ctx sha; 
+	sha256_init(&sha); 
+	sha256_update(&sha, pswd_bytes, pswd_len_words * BYTES_IN_WORD); 
+	sha256_final(&sha, cipher_key); 
+	aes_secure_wipe(pswd_bytes, sizeof(pswd_bytes)); 
+	
+	// Static rather than local: the context is ~500 bytes and the main stack is only 1KB.
+	// The key is expanded once here instead of once per block. Built with AES_OTF_KEYS
+	// the context is under 100 bytes, as only the key and the last round key window are kept.
+	static aes_ctx ctx; 
+	aes_out init_status = aes_ctx_init(&ctx, AES_KEY_LEN_BITS, cipher_key); 
+	aes_secure_wipe(cipher_key, sizeof(cipher_key)); 
+	
+	// Going on with an uninitialized schedule would store a message no key can recover
+	if(init_status.termination_code != 0){
+		aes_ctx_destroy(&ctx); 
+		status_out.status = (process == encrypt) ? encryption_failed : decryption_failed; 
+		strcpy(status_out.msg, (process == encrypt) ? "ENCRYPTION FAILED - KEY SETUP" : "DECRYPTION FAILED - KEY SETUP"); 
+		return status_out; 
+	}
+	 
+	if(mode == cipher_ccm){
+		
+		// CCM needs only the forward cipher and no padding, so the stored length is the true length
+		if(process == encrypt){
+			aes_ccm_encrypt(&ctx, msg_auth->nonce, MSG_NONCE_LEN, NULL, 0, msg_contents, msg_contents, msg_len_bytes, msg_auth->tag, MSG_TAG_LEN); 
+		}
+		else{
+			aes_out ccm_status = aes_ccm_decrypt(&ctx, msg_auth->nonce, MSG_NONCE_LEN, NULL, 0, msg_contents, msg_contents, msg_len_bytes, msg_auth->tag, MSG_TAG_LEN); 
+			
+			if(ccm_status.termination_code != 0){
+				status_out.status = decryption_failed;
+				strcpy(status_out.msg, "DECRYPTION FAILED - MESSAGE REJECTED");
+			}
+		}
+		
+		aes_ctx_destroy(&ctx); 
+		
+		return status_out; 
 	}
 	
+	// CBC-CS3 keeps the ciphertext as long as the message. Only messages shorter 
+	// than one block are zero padded, since stealing needs at least one full block. 
+	uint32_t cipher_len_bytes = MSG_STORED_LEN(msg_len_bytes); 
+	
+	// A counter nonce is predictable, and CBC needs an unpredictable IV, so the nonce is encrypted first 
+	uint8_t iv[AES_INPUT_BLOCK_SIZE] = {0}; 
+	memcpy(iv, msg_auth->nonce, MSG_NONCE_LEN); 
+	aes_ecb_encrypt_blocks(&ctx, iv, iv, 1); 
 	
-	for(uint32_t block = 0; block < data_16_byte_blocks; block++){
-		use_aes(&msg_contents[block * AES_INPUT_BLOCK_SIZE], AES_KEY_LEN_BITS, cipher_key_bytes, process); 
+	if(process == encrypt){
+		memset(&msg_contents[msg_len_bytes], 0, cipher_len_bytes - msg_len_bytes); 
+		aes_cbc_cs3_encrypt(&ctx, iv, msg_contents, msg_contents, cipher_len_bytes); 
+	}
+	else{
+		aes_cbc_cs3_decrypt(&ctx, iv, msg_contents, msg_contents, cipher_len_bytes); 
 	}
 
+	aes_ctx_destroy(&ctx); 
 	
 	return status_out; 
 }
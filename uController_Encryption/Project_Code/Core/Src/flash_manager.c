@@ -8,6 +8,10 @@
  Description : Includes functions for copying flash to RAM on startup and 
                saving encrypted messages to STM32 flash before shutdown. Provides
 							 users get and set functions for encrypted data in RAM. 
+ Note 1      : Flash layout is msg_lengths, the nonce counter, nonces, tags and
+               titles (all fixed size), then the messages packed back to back,
+               each MSG_STORED_LEN(length) bytes. RAM keeps a full
+               MSG_LEN_BYTES slot per message.
  ============================================================================
  */
 
@@ -22,6 +26,13 @@ static flash_status_msg cpy_ram_to_flash(uint8_t* messages, char* titles, uint32
 
 static uint32_t msg_lengths[NUM_MSGS] = {0};
 
+// Nonce counter is saved with the messages so a nonce is never handed out twice across power cycles
+static uint32_t nonce_counter = 0;
+
+static uint8_t msg_nonces[NUM_MSGS * MSG_NONCE_LEN] = {0};
+
+static uint8_t msg_tags[NUM_MSGS * MSG_TAG_LEN] = {0};
+
 static uint8_t encrypted_data[NUM_MSGS * MSG_LEN_BYTES] = {0};  
 
 static char msg_titles[NUM_MSGS * MSG_TITLE_LEN] = {0}; 
@@ -37,16 +48,25 @@ static void startup_cpy_flash_to_ram(uint8_t* messages, char* titles, uint32_t*
 	for(int msg = 0; msg < NUM_MSGS; msg++){
 		msg_lengths[msg] = *(uint32_t*) flash_addr; 
 		flash_addr += 4;
+		
+		// Erased flash reads as all ones. The packed offsets depend on every length, so bad ones become empty slots.
+		if(msg_lengths[msg] > MSG_LEN_BYTES){
+			msg_lengths[msg] = 0; 
+		}
 	}
 	
-		
-	// Use msg_lengths to determine which messages to copy. 
-	for(int msg = 0; msg < NUM_MSGS; msg++){
-
-			for(int byte = 0; byte < MSG_LEN_BYTES; byte++){
-				messages[(msg * MSG_LEN_BYTES) + byte] = *(uint8_t*) flash_addr; 
-				flash_addr++; 
-			}
+	// Erased flash reads as all ones, which wraps to 0 on the first nonce
+	nonce_counter = *(uint32_t*) flash_addr; 
+	flash_addr += 4;
+	
+	for(int byte = 0; byte < NUM_MSGS * MSG_NONCE_LEN; byte++){
+		msg_nonces[byte] = *(uint8_t*) flash_addr; 
+		flash_addr++; 
+	}
+	
+	for(int byte = 0; byte < NUM_MSGS * MSG_TAG_LEN; byte++){
+		msg_tags[byte] = *(uint8_t*) flash_addr; 
+		flash_addr++; 
 	}
 	
 	for(int msg = 0; msg < NUM_MSGS; msg++){
@@ -56,6 +76,15 @@ static void startup_cpy_flash_to_ram(uint8_t* messages, char* titles, uint32_t*
 				flash_addr++; 
 		}
 	}
+		
+	// Use msg_lengths to determine how much of each message to copy. The rest of the slot stays zero.
+	for(int msg = 0; msg < NUM_MSGS; msg++){
+
+			for(uint32_t byte = 0; byte < MSG_STORED_LEN(msg_lengths[msg]); byte++){
+				messages[(msg * MSG_LEN_BYTES) + byte] = *(uint8_t*) flash_addr; 
+				flash_addr++; 
+			}
+	}
 }
 
 
@@ -79,17 +108,28 @@ static flash_status_msg cpy_ram_to_flash(uint8_t* messages, char* titles, uint32
 	for(int msg = 0; msg < NUM_MSGS; msg++){
 		program_flash(FLASH_TYPEPROGRAM_WORD, &flash_addr, msg_lengths[msg], &status_out);
 	}
+	
+	program_flash(FLASH_TYPEPROGRAM_WORD, &flash_addr, nonce_counter, &status_out);
+	
+	for(int byte = 0; byte < NUM_MSGS * MSG_NONCE_LEN; byte++){
+		program_flash(FLASH_TYPEPROGRAM_BYTE, &flash_addr, msg_nonces[byte], &status_out);
+	}
+	
+	for(int byte = 0; byte < NUM_MSGS * MSG_TAG_LEN; byte++){
+		program_flash(FLASH_TYPEPROGRAM_BYTE, &flash_addr, msg_tags[byte], &status_out);
+	}
 		
 	for(int msg = 0; msg < NUM_MSGS; msg++){
-		
-		for(int byte = 0; byte < MSG_LEN_BYTES; byte++){
-			program_flash(FLASH_TYPEPROGRAM_BYTE, &flash_addr, messages[(msg * MSG_LEN_BYTES) + byte], &status_out);
+		for(int byte = 0; byte < MSG_TITLE_LEN; byte++){
+			program_flash(FLASH_TYPEPROGRAM_BYTE, &flash_addr, titles[(msg * MSG_TITLE_LEN) + byte], &status_out);
 		}
 	}
 		
+	// Only the stored length of each message is written
 	for(int msg = 0; msg < NUM_MSGS; msg++){
-		for(int byte = 0; byte < MSG_TITLE_LEN; byte++){
-			program_flash(FLASH_TYPEPROGRAM_BYTE, &flash_addr, titles[(msg * MSG_TITLE_LEN) + byte], &status_out);
+		
+		for(uint32_t byte = 0; byte < MSG_STORED_LEN(msg_lengths[msg]); byte++){
+			program_flash(FLASH_TYPEPROGRAM_BYTE, &flash_addr, messages[(msg * MSG_LEN_BYTES) + byte], &status_out);
 		}
 	}
 
@@ -186,7 +226,7 @@ msg_write_status write_message(uint8_t msg_num, char* new_title_loc, uint8_t* ne
 	msg_lengths[msg_num] = msg_len; 
 	
 	for(int byte = 0; byte < MSG_LEN_BYTES; byte++){
-		if(byte < msg_len){
+		if(byte < MSG_STORED_LEN(msg_len)){
 			encrypted_data[(msg_num * MSG_LEN_BYTES) + byte] = new_msg_loc[byte];
 		}
 		else{
@@ -215,5 +255,53 @@ void delete_message(uint8_t msg_num){
 		msg_titles[(msg_num * MSG_TITLE_LEN) + byte] = 0;
 	}
 	
+	for(int byte = 0; byte < MSG_NONCE_LEN; byte++){
+		msg_nonces[(msg_num * MSG_NONCE_LEN) + byte] = 0;
+	}
+	
+	for(int byte = 0; byte < MSG_TAG_LEN; byte++){
+		msg_tags[(msg_num * MSG_TAG_LEN) + byte] = 0;
+	}
+	
+}
+
+
+/*---------------- MESSAGE AUTHENTICATION DATA -------------------*/ 
+
+
+// Nonce is the big-endian counter followed by zeros. The counter only has to be unique, not secret.
+void new_msg_nonce(uint8_t* nonce_save_loc){
+	
+	nonce_counter++; 
+	
+	for(int byte = 0; byte < MSG_NONCE_LEN; byte++){
+		nonce_save_loc[byte] = 0;
+	}
+	
+	for(int byte = 0; byte < BYTES_IN_WORD_; byte++){
+		nonce_save_loc[byte] = (uint8_t) (nonce_counter >> (8 * (BYTES_IN_WORD_ - 1 - byte)));
+	}
+}
+
+void get_msg_auth(uint8_t msg_num, uint8_t* nonce_save_loc, uint8_t* tag_save_loc){
+	
+	for(int byte = 0; byte < MSG_NONCE_LEN; byte++){
+		nonce_save_loc[byte] = msg_nonces[(msg_num * MSG_NONCE_LEN) + byte];
+	}
+	
+	for(int byte = 0; byte < MSG_TAG_LEN; byte++){
+		tag_save_loc[byte] = msg_tags[(msg_num * MSG_TAG_LEN) + byte];
+	}
+}
+
+void write_msg_auth(uint8_t msg_num, const uint8_t* nonce, const uint8_t* tag){
+	
+	for(int byte = 0; byte < MSG_NONCE_LEN; byte++){
+		msg_nonces[(msg_num * MSG_NONCE_LEN) + byte] = nonce[byte];
+	}
+	
+	for(int byte = 0; byte < MSG_TAG_LEN; byte++){
+		msg_tags[(msg_num * MSG_TAG_LEN) + byte] = tag[byte];
+	}
 }
 